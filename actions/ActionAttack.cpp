@@ -87,7 +87,7 @@ namespace Actions
       return StateResult::Failure();
     }
 
-    auto& new_tile = MAPS.get(map).getTile({ x_new, y_new });
+    auto new_tile = MAPS.get(map).getTile({ x_new, y_new });
     EntityId new_floor = new_tile.getSpaceEntity();
 
     // See if the tile to move into contains another creature.
@@ -55,7 +55,8 @@ namespace Actions
       {
         printMessageDo(systems, arguments);
 
-        /// @todo When throwing, set Entity's direction and velocity
+        /// @todo When throwing, set Entity's direction and velocity, and
+        ///       check its flight path with SenseSight::lineOfSight.
         /// @todo Figure out action time.
         result = StateResult::Success();
       }
@@ -87,7 +87,7 @@ namespace Actions
       }
       else
       {
-        auto& new_tile = gameState.maps().get(map).getTile({ x_new, y_new });
+        auto new_tile = gameState.maps().get(map).getTile({ x_new, y_new });
         EntityId new_floor = new_tile.getSpaceEntity();
 
         // See if the tile to move into contains another creature.
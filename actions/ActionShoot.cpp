@@ -44,6 +44,8 @@ namespace Actions
 
   StateResult ActionShoot::doBeginWorkNVI(GameState& gameState, Systems::Manager& systems, json& arguments)
   {
+    /// @todo When shooting is implemented, check the projectile's path with
+    ///       SenseSight::lineOfSight rather than tracing it here.
     putMsg(tr("ACTN_NOT_IMPLEMENTED"));
     return StateResult::Failure();
   }
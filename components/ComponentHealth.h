@@ -3,6 +3,12 @@
 #include "json.hpp"
 using json = ::nlohmann::json;
 
+// Forward declarations
+namespace LuaFFI
+{
+  struct Layouts;
+}
+
 namespace Components
 {
 
@@ -15,6 +21,7 @@ namespace Components
 
     friend void from_json(json const& j, ComponentHealth& obj);
     friend void to_json(json& j, ComponentHealth const& obj);
+    friend struct LuaFFI::Layouts;
 
     int hp() const;
     void setHp(int hp);
@@ -136,12 +136,12 @@ namespace Components
     return std::end(m_entities);
   }
 
-  EntityMap::const_iterator ComponentInventory::cbegin()
+  EntityMap::const_iterator ComponentInventory::cbegin() const
   {
     return m_entities.cbegin();
   }
 
-  EntityMap::const_iterator ComponentInventory::cend()
+  EntityMap::const_iterator ComponentInventory::cend() const
   {
     return m_entities.cend();
   }
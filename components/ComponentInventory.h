@@ -52,10 +52,10 @@ namespace Components
     EntityMap::iterator end();
 
     /// Gets a beginning const iterator to the entities map.
-    EntityMap::const_iterator cbegin();
+    EntityMap::const_iterator cbegin() const;
 
     /// Gets an ending const iterator to the entities map.
-    EntityMap::const_iterator cend();
+    EntityMap::const_iterator cend() const;
 
     /// Finds items with identical qualities and combines them into a single
     /// aggregate item.
@@ -18,9 +18,9 @@ int LUA_get_busy_ticks(lua_State* L)
 
 int LUA_get_category(lua_State* L)
 {
-  return LUA_getValue<std::string>(L, [&](EntityId entity) -> std::string
+  return LUA_getValue<Atom>(L, [&](EntityId entity) -> Atom
   {
-    return COMPONENTS.category.existsFor(entity) ? COMPONENTS.category[entity] : "";
+    return COMPONENTS.category.existsFor(entity) ? COMPONENTS.category[entity] : Atom();
   });
 }
 
@@ -206,4 +206,14 @@ namespace Components
     return j;
   }
 
+  ComponentMap const* ComponentManager::byName(std::string const& name) const
+  {
+    for (auto& componentPair : componentToName)
+    {
+      if (componentPair.second == name) return componentPair.first;
+    }
+
+    return nullptr;
+  }
+
 } // end namespace
@@ -65,9 +65,14 @@ namespace Components
     /// Dump component data for a single ID.
     json toJSON(EntityId id);
 
+    /// Get a component map by its JSON component name.
+    /// @return Pointer to the component map, or nullptr if there is no
+    ///         component by that name.
+    ComponentMap const* byName(std::string const& name) const;
+
     ComponentGlobals                               globals;
-    ComponentMapConcrete<std::string>              category;
-    ComponentMapConcrete<std::string>              material;
+    ComponentMapConcrete<Atom>                     category;
+    ComponentMapConcrete<Atom>                     material;
 
     ComponentMapConcrete<std::string>              properName;
     ComponentMapConcrete<std::string>              noun;
@@ -131,7 +131,7 @@ namespace Components
 
     virtual void remove(EntityId id) override
     {
-      m_componentMap.erase(id);
+      if (m_componentMap.erase(id) != 0) ++m_epoch;
     }
 
     T& operator[](EntityId id)
@@ -174,6 +174,16 @@ namespace Components
       return *this;
     }
 
+    /// Get the removal epoch of this map.
+    /// Components are stored in nodes that never move, so a pointer to one
+    /// stays valid until it is removed. The epoch goes up whenever any
+    /// component is removed, so holders of such pointers (e.g. the Lua FFI
+    /// component views) can tell when to look them up again.
+    uint32_t const& epoch() const
+    {
+      return m_epoch;
+    }
+
     /// Get the map itself for iterating through.
     std::unordered_map<EntityId, T>& data()
     {
@@ -188,6 +198,7 @@ namespace Components
     friend void from_json(json const& j, ComponentMapConcrete& obj)
     {
       obj.m_componentMap.clear();
+      ++obj.m_epoch;
 
       if (j.is_object())
       {
@@ -212,6 +223,9 @@ namespace Components
   private:
     std::unordered_map<EntityId, T> m_componentMap;
 
+    /// Removal epoch; see epoch().
+    uint32_t m_epoch = 0;
+
     /// @todo Implement component modifiers, possibly with some sort of
     ///       "snapshot" mechanism for specific components.
   };
@@ -7,6 +7,12 @@ using json = ::nlohmann::json;
 #include "game/GameState.h"
 #include "types/Vec2.h"
 
+// Forward declarations
+namespace LuaFFI
+{
+  struct Layouts;
+}
+
 namespace Components
 {
 
@@ -22,6 +28,7 @@ namespace Components
 
     friend void from_json(json const& j, ComponentPosition& obj);
     friend void to_json(json& j, ComponentPosition const& obj);
+    friend struct LuaFFI::Layouts;
 
     friend std::ostream& operator<<(std::ostream& os, Components::ComponentPosition const& obj)
     {
@@ -10,21 +10,22 @@ namespace Components
     obj = ComponentSenseSight();
 
     // *** add Component-specific assignments here ***
-    //JSONUtils::doIfPresent(j, "member", [&](auto& value) { obj.m_member = value; });
+    JSONUtils::doIfPresent(j, "range", [&](auto& value) { obj.m_range = value; });
   }
 
   void to_json(json& j, ComponentSenseSight const& obj)
   {
     j = json::object();
     // *** add Component-specific assignments here ***
-    //j["member"] = obj.m_member;
+    j["range"] = obj.m_range;
   }
 
 
   ComponentSenseSight::ComponentSenseSight()
     :
+    m_range{ 128 },
     m_transientTilesSeen{},
-    m_transientTilesSeenSize{}
+    m_transientVisibleEntities{}
   {}
 
   ComponentSenseSight::~ComponentSenseSight()
@@ -32,68 +33,59 @@ namespace Components
 
   ComponentSenseSight::ComponentSenseSight(ComponentSenseSight const& other)
     :
+    m_range{ other.m_range },
     m_transientTilesSeen{},       // do NOT copy!
-    m_transientTilesSeenSize{}    // do NOT copy!
+    m_transientVisibleEntities{}  // do NOT copy!
   {}
 
   ComponentSenseSight& ComponentSenseSight::operator=(ComponentSenseSight const& other)
   {
     if (this != &other)
     {
-      /// @todo Any non-transient data we want to copy goes here
+      m_range = other.m_range;
     }
     return *this;
   }
 
-  void ComponentSenseSight::resetSeen()
+  int ComponentSenseSight::range() const
   {
-    m_transientTilesSeen.reset();
+    return m_range;
   }
 
-  void ComponentSenseSight::clearSeen()
+  void ComponentSenseSight::resetSeen()
   {
-    m_transientTilesSeen.clear();
-    m_transientTilesSeenSize = IntVec2(0, 0);
+    m_transientTilesSeen.reset();
   }
 
-  void ComponentSenseSight::resizeSeen(IntVec2 size)
+  void ComponentSenseSight::clearSeen()
   {
-    m_transientTilesSeen.clear();
-    m_transientTilesSeen.resize(size.x * size.y);
-    m_transientTilesSeenSize = size;
+    m_transientTilesSeen.reset();
+    m_transientVisibleEntities.clear();
   }
 
   bool ComponentSenseSight::canSee(IntVec2 coords) const
   {
-    if (index(coords) < m_transientTilesSeen.size())
-    {
-      return m_transientTilesSeen[index(coords)];
-    }
-    else
-    {
-      CLOG(WARNING, "SenseSight") << "Requested coordinates were out-of-bounded";
-      return false;
-    }
+    return m_transientTilesSeen && m_transientTilesSeen->test(coords);
   }
 
-  void ComponentSenseSight::setSeen(IntVec2 coords)
+  std::shared_ptr<TilesSeen const> const& ComponentSenseSight::tilesSeen() const
   {
-    m_transientTilesSeen[index(coords)] = true;
+    return m_transientTilesSeen;
   }
 
-  void ComponentSenseSight::unsetSeen(IntVec2 coords)
+  void ComponentSenseSight::setTilesSeen(std::shared_ptr<TilesSeen const> tilesSeen)
   {
-    m_transientTilesSeen[index(coords)] = false;
+    m_transientTilesSeen = std::move(tilesSeen);
   }
 
-  boost::dynamic_bitset<size_t>::reference ComponentSenseSight::operator[](IntVec2 coords)
+  ComponentSenseSight::VisibleEntities const& ComponentSenseSight::visibleEntities() const
   {
-    return m_transientTilesSeen[index(coords)];
+    return m_transientVisibleEntities;
   }
 
-  size_t ComponentSenseSight::index(IntVec2 coords) const
+  void ComponentSenseSight::setVisibleEntities(VisibleEntities visibleEntities)
   {
-    return (m_transientTilesSeenSize.x * coords.y) + coords.x;
+    m_transientVisibleEntities = std::move(visibleEntities);
   }
 
 } // end namespace
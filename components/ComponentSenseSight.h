@@ -1,14 +1,15 @@
 #pragma once
 
-#include "boost/dynamic_bitset.hpp"
+#include <memory>
+#include <vector>
 
 #include "json.hpp"
 using json = ::nlohmann::json;
 
+#include "entity/EntityId.h"
+#include "types/FOVCache.h"
 #include "types/Vec2.h"
 
-using TilesSeen = boost::dynamic_bitset<size_t>; // size_t gets rid of 64-bit compile warning
-
 namespace Components
 {
 
@@ -16,6 +17,16 @@ namespace Components
   class ComponentSenseSight final
   {
   public:
+    /// An entity that can be seen, and the tile it was seen on.
+    struct VisibleEntity
+    {
+      EntityId id;
+      IntVec2 coords;
+    };
+
+    /// List of visible entities, sorted by ID.
+    using VisibleEntities = std::vector<VisibleEntity>;
+
     ComponentSenseSight();
     ~ComponentSenseSight();
 
@@ -25,24 +36,40 @@ namespace Components
     friend void from_json(json const& j, ComponentSenseSight& obj);
     friend void to_json(json& j, ComponentSenseSight const& obj);
 
+    /// Get the maximum distance, in tiles, that can be seen.
+    int range() const;
+
     void resetSeen();
     void clearSeen();
-    void resizeSeen(IntVec2 size);
     bool canSee(IntVec2 coords) const;
-    void setSeen(IntVec2 coords);
-    void unsetSeen(IntVec2 coords);
 
-    boost::dynamic_bitset<size_t>::reference operator[](IntVec2 coords);
+    /// Get the set of tiles currently seen.
+    /// The set may be shared with other observers, and is never modified
+    /// once handed out; it is replaced wholesale by setTilesSeen().
+    /// @return Pointer to the set, or nullptr if nothing has been seen yet.
+    std::shared_ptr<TilesSeen const> const& tilesSeen() const;
 
-  protected:
-    size_t index(IntVec2 coords) const;
+    /// Replace the set of tiles currently seen.
+    void setTilesSeen(std::shared_ptr<TilesSeen const> tilesSeen);
+
+    /// Get the entities currently seen, sorted by ID.
+    /// Consumers that only care about what can be seen (rendering, AI
+    /// awareness) can iterate this instead of scanning every seen tile.
+    VisibleEntities const& visibleEntities() const;
+
+    /// Replace the list of entities currently seen.
+    /// @param visibleEntities  List of entities, which must be sorted by ID.
+    void setVisibleEntities(VisibleEntities visibleEntities);
 
   private:
+    /// Maximum distance, in tiles, that can be seen.
+    int m_range;
+
     /// Tiles currently seen. Transient data, NOT saved to JSON.
-    TilesSeen m_transientTilesSeen;
+    std::shared_ptr<TilesSeen const> m_transientTilesSeen;
 
-    /// Size of tiles seen map.
-    IntVec2 m_transientTilesSeenSize;
+    /// Entities currently seen. Transient data, NOT saved to JSON.
+    VisibleEntities m_transientVisibleEntities;
 
   };
 
@@ -21,12 +21,18 @@ namespace Config
   Bible::~Bible()
   {}
 
-  json& Bible::categoryData(std::string name)
+  json& Bible::categoryData(Atom name)
   {
-    bool hasSubtype = (name.find('.') != std::string::npos);
+    auto iter = m_categoryIndex.find(name);
+    if (iter != m_categoryIndex.end())
+    {
+      return *(iter->second);
+    }
 
     loadCategoryIfNecessary(name);
-    return m_data[name];
+    json& data = m_data[name.str()];
+    m_categoryIndex[name] = &data;
+    return data;
   }
 
   void Bible::loadCategoryIfNecessary(std::string name)
@@ -110,7 +116,11 @@ namespace Config
         std::cerr << "BREAK" << std::endl;
       }
 
-      App::the_tilesheet().loadViewResourcesFor(name);
+      // Headless tools have no App, and nothing to draw with.
+      if (App::exists())
+      {
+        App::the_tilesheet().loadViewResourcesFor(name);
+      }
     }
   }
 
@@ -3,6 +3,9 @@
 #include <boost/noncopyable.hpp>
 
 #include <string>
+#include <unordered_map>
+
+#include "types/Atom.h"
 
 #include "json.hpp"
 using json = ::nlohmann::json;
@@ -18,7 +21,7 @@ namespace Config
 
     /// Get data for a specific Entity category.
     /// If it doesn't exist, attempt to load it.
-    json& categoryData(std::string name);
+    json& categoryData(Atom name);
 
     /// Get reference to game rules data.
     inline json& data()
@@ -47,6 +50,11 @@ namespace Config
   private:
     /// Game rules data, as stored in a JSON object.
     json m_data;
+
+    /// Index of categories already loaded into the game rules data.
+    /// Elements of a JSON object never move once added, so lookups by Atom
+    /// can skip the string-keyed search entirely.
+    std::unordered_map<Atom, json*> m_categoryIndex;
   };
 
   Bible& bible();
@@ -41,6 +41,18 @@ namespace Config
     set("map-tile-size", UintVec2(24, 24));
     set("tilesheet-texture-size", UintVec2(1024, 1024));
     set("ascii-tiles-filename", "Unknown_curses_12x12.png");
+    set("fov-cache-size", 64);
+    set("pathfinding-cache-size", 256);
+    set("dijkstra-flee-coefficient", -1.2);
+    set("map-tile-memory-budget-kb", 0);
+    set("map-tile-keep-radius", 32);
+    set("rng-seed", 0);
+    set("lua-pool-allocator", true);
+    set("lua-gc-between-cycles", true);
+    set("lua-gc-step-kb", 32);
+    set("lua-gc-pause", 200);
+    set("lua-gc-backstop-pause", 400);
+    set("lua-gc-idle-budget-us", 1000);
 
     set("player-name", "Clongus Burpo");
   }
@@ -10,6 +10,14 @@
 #include "lua/LuaObject.h"
 #include "map/Map.h"
 #include "maptile/MapTile.h"
+#include "systems/Manager.h"
+#include "systems/SystemGeometry.h"
+
+namespace
+{
+  /// Suffix of the Lua function called when an entity is created.
+  Atom const OnCreate{ "on_create" };
+}
 
 EntityFactory::EntityFactory(GameState& gameState) :
   m_gameState{ gameState }
@@ -34,40 +42,27 @@ EntityId EntityFactory::create(EntitySpecs specs)
   auto& jsonComponents = data["components"];
   m_gameState.components().populate(new_id, jsonComponents);
 
-  auto material = specs.material;
-  if (material.empty() && jsonComponents.count("materials") != 0)
-  {
-    auto& jsonMaterials = jsonComponents["materials"];
-
-    if (jsonMaterials.is_array() && jsonMaterials.size() > 0)
-    {
-      /// @todo Choose one material randomly.
-      ///       Right now, we just use the first one.
-      material = StringTransforms::squishWhitespace(jsonMaterials[0].get<std::string>());
-    }
-  }
+  auto material = specs.material.empty() ? defaultMaterial(specs.category, jsonComponents) : specs.material;
 
   if (!material.empty())
   {
-    json& materialData = Config::bible().categoryData("material." + material);
+    json& materialData = Config::bible().categoryData(materialCategory(material));
     m_gameState.components().populate(new_id, materialData["components"]);
   }
 
-  if (m_initialized)
+  if (m_initialized && GAME.lua().hasEntityFunction(new_id, OnCreate))
   {
-    GAME.lua().callEntityFunction("on_create", new_id, {}, true);
+    GAME.lua().call<bool>(OnCreate, new_id, true);
   }
 
   return EntityId(new_id);
 }
 
-EntityId EntityFactory::createTileEntity(MapTile* mapTile, EntitySpecs specs)
+EntityId EntityFactory::createTileEntity(MapID map, IntVec2 coords, EntitySpecs specs)
 {
   EntityId new_id = create(specs);
 
-  MapID map = mapTile->map();
-  IntVec2 position = mapTile->getCoords();
-  m_gameState.components().position[new_id].set(map, position);
+  m_gameState.components().position[new_id].set(map, coords);
 
   return EntityId(new_id);
 }
@@ -82,6 +77,13 @@ EntityId EntityFactory::clone(EntityId original)
 
   components.clone(original, newId);
 
+  // The clone is wherever the original was, so the spatial index needs to
+  // know about it.
+  if (components.position.existsFor(newId))
+  {
+    SYSTEMS.geometry().updateSpatialIndex(newId);
+  }
+
   return newId;
 }
 
@@ -123,7 +125,7 @@ void EntityFactory::morph(EntityId id, EntitySpecs specs)
 
   if (!specs.material.empty() && (specs.material != oldMaterial))
   {
-    json& materialData = Config::bible().categoryData("material." + specs.material);
+    json& materialData = Config::bible().categoryData(materialCategory(specs.material));
     components.populate(id, materialData["components"]);
   }
 
@@ -153,3 +155,35 @@ void EntityFactory::destroy(EntityId id)
     throw std::runtime_error("Attempted to destroy Void object!");
   }
 }
+
+Atom EntityFactory::materialCategory(Atom material)
+{
+  auto iter = m_materialCategories.find(material);
+  if (iter == m_materialCategories.end())
+  {
+    iter = m_materialCategories.emplace(material, Atom("material." + material.str())).first;
+  }
+  return iter->second;
+}
+
+Atom EntityFactory::defaultMaterial(Atom category, json& jsonComponents)
+{
+  auto iter = m_defaultMaterials.find(category);
+  if (iter != m_defaultMaterials.end()) return iter->second;
+
+  Atom material;
+  if (jsonComponents.count("materials") != 0)
+  {
+    auto& jsonMaterials = jsonComponents["materials"];
+
+    if (jsonMaterials.is_array() && jsonMaterials.size() > 0)
+    {
+      /// @todo Choose one material randomly.
+      ///       Right now, we just use the first one.
+      material = StringTransforms::squishWhitespace(jsonMaterials[0].get<std::string>());
+    }
+  }
+
+  m_defaultMaterials.emplace(category, material);
+  return material;
+}
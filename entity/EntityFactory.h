@@ -6,7 +6,6 @@
 // Forward declarations
 class GameState;
 class Entity;
-class MapTile;
 namespace Systems
 {
   class Manager;
@@ -29,10 +28,11 @@ public:
   EntityId create(EntitySpecs specs);
 
   /// Create an entity bound to a tile (e.g. the floor, or the space above the floor).
-  /// @param mapTile Pointer to the map tile associated.
+  /// @param map ID of the map the tile is on.
+  /// @param coords Coordinates of the tile on the map.
   /// @param specs The category and optional material of the object to create.
   /// @return EntityId of the new object created.
-  EntityId createTileEntity(MapTile* mapTile, EntitySpecs specs);
+  EntityId createTileEntity(MapID map, IntVec2 coords, EntitySpecs specs);
 
   /// Clone a particular object.
   /// @param original ID of the object to clone.
@@ -67,6 +67,13 @@ public:
   void destroy(EntityId id);
 
 protected:
+  /// Get the material a category's entities are made of by default, if it
+  /// has one, reading it from the category's data only the first time.
+  Atom defaultMaterial(Atom category, json& jsonComponents);
+
+  /// Get the category holding a material's data ("material.NAME"), interning
+  /// it only the first time each material is seen.
+  Atom materialCategory(Atom material);
 
 private:
   /// Reference to the game state.
@@ -77,4 +84,10 @@ private:
 
   /// Counter indicating the next EntityId to be created.
   uint64_t m_nextEntityId = 0;
+
+  /// Default materials, by category.
+  std::unordered_map<Atom, Atom> m_defaultMaterials;
+
+  /// Categories of materials, by material.
+  std::unordered_map<Atom, Atom> m_materialCategories;
 };
\ No newline at end of file
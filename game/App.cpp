@@ -14,6 +14,7 @@
 #include "state_machine/StateMachine.h"
 #include "tilesheet/TileSheet.h"
 #include "types/Color.h"
+#include "utilities/RNGUtils.h"
 #include "game_windows/MessageLogView.h"
 
 // Global declarations
@@ -61,46 +62,16 @@ App::App(sf::RenderWindow& appWindow, sfg::SFGUI& sfgui, sfg::Desktop& desktop)
     throw std::runtime_error("Tried to create more than one App instance");
   }
 
-  // Register loggers.
-  SET_UP_LOGGER("App",                false);
-  SET_UP_LOGGER("Action",             false);
-  SET_UP_LOGGER("Component",          false);
-  SET_UP_LOGGER("ConfigSettings",     false);
-  SET_UP_LOGGER("Director",           false);
-  SET_UP_LOGGER("Entity",             false);
-  SET_UP_LOGGER("EntityFactory",      false);
-  SET_UP_LOGGER("EventSystem",        false);
-  SET_UP_LOGGER("Game",               true);
-  SET_UP_LOGGER("GameRules",          false);
-  SET_UP_LOGGER("GameState",          false);
-  SET_UP_LOGGER("Geometry",           false);
-  SET_UP_LOGGER("GUI",                true);
-  SET_UP_LOGGER("Inventory",          false);
-  SET_UP_LOGGER("InventoryArea",      true);
-  SET_UP_LOGGER("InventorySelection", false);
-  SET_UP_LOGGER("Lighting",           false);
-  SET_UP_LOGGER("Lua",                false);
-  SET_UP_LOGGER("Map",                false);
-  SET_UP_LOGGER("MapFactory",         false);
-  SET_UP_LOGGER("MapGenerator",       false);
-  SET_UP_LOGGER("Object",             true);
-  SET_UP_LOGGER("Narrator",           false);
-  SET_UP_LOGGER("PlayerHandler",      false);
-  SET_UP_LOGGER("Property",           false);
-  SET_UP_LOGGER("PropertyDictionary", false);
-  SET_UP_LOGGER("SenseSight",         false);
-  SET_UP_LOGGER("StateMachine",       false);
-  SET_UP_LOGGER("Strings",            false);
-  SET_UP_LOGGER("StringTransforms",   false);
-  SET_UP_LOGGER("Systems",            true);
-  SET_UP_LOGGER("TileSheet",          false);
-  SET_UP_LOGGER("Types",              false);
-  SET_UP_LOGGER("Utilities",          false);
+  setUpLoggers();
 
   auto& config = Config::settings();
   auto& paths = Config::paths();
   auto& resourcesPath = paths.resources();
 
+  // Seed the random number generators. A fixed seed reproduces a session.
+  RNG::setGlobalSeed(config.get("rng-seed").get<uint64_t>());
+  CLOG(INFO, "App") << "Random seed is " << RNG::globalSeed();
+
   // Create the view controller.
   m_vc.reset(NEW AppVC(paths, config, appWindow));
 
@@ -274,6 +245,51 @@ int App::frameCounter() const
   return m_frameCounter;
 }
 
+void App::setUpLoggers()
+{
+  SET_UP_LOGGER("App",                false);
+  SET_UP_LOGGER("Action",             false);
+  SET_UP_LOGGER("Archivist",          false);
+  SET_UP_LOGGER("ChunkPager",         false);
+  SET_UP_LOGGER("Component",          false);
+  SET_UP_LOGGER("ConfigSettings",     false);
+  SET_UP_LOGGER("Director",           false);
+  SET_UP_LOGGER("Entity",             false);
+  SET_UP_LOGGER("EntityFactory",      false);
+  SET_UP_LOGGER("EventSystem",        false);
+  SET_UP_LOGGER("Game",               true);
+  SET_UP_LOGGER("GameRules",          false);
+  SET_UP_LOGGER("GameState",          false);
+  SET_UP_LOGGER("Geometry",           false);
+  SET_UP_LOGGER("GUI",                true);
+  SET_UP_LOGGER("Inventory",          false);
+  SET_UP_LOGGER("InventoryArea",      true);
+  SET_UP_LOGGER("InventorySelection", false);
+  SET_UP_LOGGER("Lighting",           false);
+  SET_UP_LOGGER("Lua",                false);
+  SET_UP_LOGGER("Map",                false);
+  SET_UP_LOGGER("MapFactory",         false);
+  SET_UP_LOGGER("MapGenerator",       false);
+  SET_UP_LOGGER("Object",             true);
+  SET_UP_LOGGER("Narrator",           false);
+  SET_UP_LOGGER("PlayerHandler",      false);
+  SET_UP_LOGGER("Property",           false);
+  SET_UP_LOGGER("PropertyDictionary", false);
+  SET_UP_LOGGER("SenseSight",         false);
+  SET_UP_LOGGER("StateMachine",       false);
+  SET_UP_LOGGER("Strings",            false);
+  SET_UP_LOGGER("StringTransforms",   false);
+  SET_UP_LOGGER("Systems",            true);
+  SET_UP_LOGGER("TileSheet",          false);
+  SET_UP_LOGGER("Types",              false);
+  SET_UP_LOGGER("Utilities",          false);
+}
+
+bool App::exists()
+{
+  return (s_instance != nullptr);
+}
+
 App& App::instance()
 {
   if (s_instance)
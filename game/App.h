@@ -101,6 +101,14 @@ public:
   /// Get the current frame counter.
   int frameCounter() const;
 
+  /// Register and configure the loggers used throughout the game.
+  /// Called by the constructor; tools that run without an App call it
+  /// themselves.
+  static void setUpLoggers();
+
+  /// Get whether an App instance currently exists.
+  static bool exists();
+
   /// Get the current App instance.
   /// If no App instance currently exists, throws an exception.
   static App& instance();
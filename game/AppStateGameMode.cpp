@@ -125,8 +125,9 @@ void AppStateGameMode::execute()
     m_systemManager->lighting().setMap(map);
     m_systemManager->senseSight().setMap(map);
 
-    // Run systems.
+    // Run systems, then collect a little of the garbage they left.
     m_systemManager->runOneCycle();
+    game.lua().collectGarbage();
 
     // Update view's cached tile data.
     m_mapView->updateTiles(player, m_systemManager->lighting());
@@ -138,6 +139,12 @@ void AppStateGameMode::execute()
       resetInventorySelection();
     }
   }
+  else
+  {
+    // Nothing else to do while waiting on the player, so collect Lua's
+    // garbage in the meantime.
+    game.lua().collectGarbage(std::chrono::microseconds(Config::settings().get("lua-gc-idle-budget-us").get<int>()));
+  }
 }
 
 bool AppStateGameMode::initialize()
@@ -999,6 +1006,25 @@ bool AppStateGameMode::onEvent(Event const& event)
       of << gameStateJSON.dump(2);
       m_gameState->addMessage("...Dump complete.");
     }
+    else if (command == "lua memory")
+    {
+      // Show what Lua's memory is being used for.
+      auto& memory = m_gameState->lua().memory();
+      m_gameState->addMessage("Lua memory: " + std::to_string(memory.bytesInUse() / 1024) + " KB in use, peak " +
+                              std::to_string(memory.peakBytesInUse() / 1024) + " KB");
+      for (int index = 0; index < static_cast<int>(LuaMemory::Phase::Count); ++index)
+      {
+        auto phase = static_cast<LuaMemory::Phase>(index);
+        auto& stats = memory.stats(phase);
+        m_gameState->addMessage(boost::lexical_cast<std::string>(phase) + ": " +
+                                std::to_string(stats.allocations) + " allocations, " +
+                                std::to_string(stats.bytesAllocated / 1024) + " KB");
+      }
+      auto& collector = memory.collector();
+      m_gameState->addMessage("GC: " + std::to_string(collector.steps) + " steps, " +
+                              std::to_string(collector.cycles) + " cycles, " +
+                              std::to_string(collector.time.count() / 1000) + " ms");
+    }
     else
     {
       if (luaL_dostring(m_gameState->lua().state(), info.command.c_str()))
@@ -1006,6 +1032,9 @@ bool AppStateGameMode::onEvent(Event const& event)
         std::string result = lua_tostring(m_gameState->lua().state(), -1);
         m_gameState->addMessage(result);
       }
+
+      // The command may have defined or replaced functions.
+      m_gameState->lua().clear_function_cache();
     }
 
     return false;
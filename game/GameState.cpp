@@ -5,6 +5,7 @@
 #include "components/ComponentManager.h"
 #include "entity/EntityId.h"
 #include "entity/EntityFactory.h"
+#include "lua/LuaFFI.h"
 #include "lua/LuaObject.h"
 #include "map/Map.h"
 #include "map/MapFactory.h"
@@ -55,6 +56,10 @@ void GameState::initialize(json const& j)
     m_mapFactory.reset(NEW MapFactory(*this));
   }
 
+  // Give Lua scripts direct views of hot components. (Needs the component
+  // manager to be in place, as the views point into it.)
+  LuaFFI::initialize(*m_lua);
+
   /// Reset the message log.
   /// @todo Save the log as part of the game state -- this is not yet done.
   m_gameLog.reset(NEW GameLog());
@@ -0,0 +1,192 @@
+#include "stdafx.h"
+
+#include "lua/LuaFFI.h"
+
+#include "components/ComponentManager.h"
+#include "config/Paths.h"
+#include "game/GameState.h"
+#include "lua/LuaObject.h"
+
+static_assert(sizeof(bool) == 1, "Lua FFI views assume a one-byte bool");
+static_assert(sizeof(int) == sizeof(int32_t), "Lua FFI views assume a 32-bit int");
+static_assert(std::is_standard_layout<EntityId>::value && (sizeof(EntityId) == sizeof(uint64_t)),
+              "Lua FFI views assume EntityId is a bare 64-bit integer");
+
+namespace LuaFFI
+{
+  /// One field of a view.
+  struct Field
+  {
+    char const* ctype;
+    char const* name;
+    size_t offset;
+    size_t size;
+    bool writable;
+  };
+
+  /// One view, with its fields in the order they are stored.
+  struct View
+  {
+    Kind kind;
+
+    /// Name of the view in Lua, e.g. `ComponentView.health`.
+    char const* name;
+
+    /// Name of the FFI struct type.
+    char const* ctype;
+
+    /// Size of the component class.
+    size_t size;
+
+    std::vector<Field> fields;
+  };
+
+  /// Measures the layouts of the components with views.
+  /// (A friend of the components whose fields are private.)
+  struct Layouts
+  {
+    static std::vector<View> all()
+    {
+      using namespace Components;
+
+      ComponentHealth health;
+      ComponentPhysical physical;
+      ComponentLightSource lightSource;
+      ComponentPosition position;
+
+      return
+      {
+        { Kind::Health, "health", "metahack_health", sizeof(ComponentHealth),
+          {
+            { "int32_t", "hp",              offsetIn(health, health.m_hp),             sizeof(int),  true },
+            { "int32_t", "max_hp",          offsetIn(health, health.m_maxHp),          sizeof(int),  true },
+            { "bool",    "dead",            offsetIn(health, health.m_dead),           sizeof(bool), true },
+            { "bool",    "living_creature", offsetIn(health, health.m_livingCreature), sizeof(bool), false }
+          }
+        },
+        { Kind::Physical, "physical", "metahack_physical", sizeof(ComponentPhysical),
+          {
+            { "int32_t", "mass",   offsetIn(physical, physical.mass()),   sizeof(int), true },
+            { "int32_t", "volume", offsetIn(physical, physical.volume()), sizeof(int), true }
+          }
+        },
+        { Kind::LightSource, "light_source", "metahack_light_source", sizeof(ComponentLightSource),
+          {
+            { "bool",    "lit",      offsetIn(lightSource, lightSource.lit()),      sizeof(bool), true },
+            { "int32_t", "strength", offsetIn(lightSource, lightSource.strength()), sizeof(int),  true }
+          }
+        },
+        // Positions are read-only: moving an entity has to go through
+        // Geometry, which keeps inventories and the spatial index in step.
+        // The raw coordinates are only meaningful if there is no parent, so
+        // they are hidden; the view's coords() method follows the parent
+        // chain, as ComponentPosition::coords() does.
+        { Kind::Position, "position", "metahack_position", sizeof(ComponentPosition),
+          {
+            { "uint64_t", "parent", offsetIn(position, position.m_parent),   sizeof(uint64_t), false },
+            { "int32_t",  "_x",     offsetIn(position, position.m_coords.x), sizeof(int32_t),  false },
+            { "int32_t",  "_y",     offsetIn(position, position.m_coords.y), sizeof(int32_t),  false }
+          }
+        }
+      };
+    }
+
+    /// Get the offset of a member within an object.
+    template <typename T, typename M>
+    static size_t offsetIn(T const& object, M const& member)
+    {
+      return reinterpret_cast<char const*>(&member) - reinterpret_cast<char const*>(&object);
+    }
+  };
+
+  namespace
+  {
+    /// Build the FFI declaration of a view: its fields at the offsets they
+    /// have in the component, with padding over everything else.
+    std::string makeDeclaration(View view)
+    {
+      std::sort(view.fields.begin(), view.fields.end(),
+                [](Field const& first, Field const& second) { return first.offset < second.offset; });
+
+      std::stringstream code;
+      size_t position = 0;
+      int padding = 0;
+
+      code << "typedef struct { ";
+      for (auto& field : view.fields)
+      {
+        if (field.offset > position)
+        {
+          code << "uint8_t _padding" << padding++ << "[" << (field.offset - position) << "]; ";
+        }
+        code << (field.writable ? "" : "const ") << field.ctype << " " << field.name << "; ";
+        position = field.offset + field.size;
+      }
+      if (view.size > position)
+      {
+        code << "uint8_t _padding" << padding++ << "[" << (view.size - position) << "]; ";
+      }
+      code << "} " << view.ctype << ";";
+
+      return code.str();
+    }
+
+    template <typename T>
+    void* find(Components::ComponentMapConcrete<T>& components, EntityId entity)
+    {
+      auto& data = components.data();
+      auto iter = data.find(entity);
+      return (iter != data.end()) ? &(iter->second) : nullptr;
+    }
+  }
+
+  void initialize(Lua& lua)
+  {
+    lua_State* L = lua.state();
+
+    // Hand the layouts over to the script in a global table. (+1, -1)
+    lua_newtable(L);
+    for (auto& view : Layouts::all())
+    {
+      lua_newtable(L);
+      lua_pushinteger(L, static_cast<lua_Integer>(view.kind));
+      lua_setfield(L, -2, "kind");
+      lua_pushstring(L, view.ctype);
+      lua_setfield(L, -2, "ctype");
+      lua_pushstring(L, makeDeclaration(view).c_str());
+      lua_setfield(L, -2, "declaration");
+      lua_setfield(L, -2, view.name);
+    }
+    lua_setglobal(L, "component_view_layouts");
+
+    lua.require(Config::paths().resources() + "/script/component_views");
+  }
+}
+
+void* metahack_component_of(uint32_t kind, uint64_t entity)
+{
+  auto& components = COMPONENTS;
+
+  switch (static_cast<LuaFFI::Kind>(kind))
+  {
+    case LuaFFI::Kind::Health:      return LuaFFI::find(components.health, entity);
+    case LuaFFI::Kind::Physical:    return LuaFFI::find(components.physical, entity);
+    case LuaFFI::Kind::LightSource: return LuaFFI::find(components.lightSource, entity);
+    case LuaFFI::Kind::Position:    return LuaFFI::find(components.position, entity);
+    default:                        return nullptr;
+  }
+}
+
+uint32_t const* metahack_component_epoch(uint32_t kind)
+{
+  auto& components = COMPONENTS;
+
+  switch (static_cast<LuaFFI::Kind>(kind))
+  {
+    case LuaFFI::Kind::Health:      return &components.health.epoch();
+    case LuaFFI::Kind::Physical:    return &components.physical.epoch();
+    case LuaFFI::Kind::LightSource: return &components.lightSource.epoch();
+    case LuaFFI::Kind::Position:    return &components.position.epoch();
+    default:                        return nullptr;
+  }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+
+// Forward declarations
+class Lua;
+
+#ifdef _WIN32
+#define LUA_FFI_EXPORT extern "C" __declspec(dllexport)
+#else
+#define LUA_FFI_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+/// Views of hot components for Lua scripts, through the LuaJIT FFI.
+///
+/// Instead of calling a C function per field (`get_hp`, `is_lit`...),
+/// scripts can ask for a view of an entity's component and read and write
+/// its fields directly in native storage, which the JIT compiles down to
+/// plain memory accesses:
+///
+/// ```
+/// local health = ComponentView.health(id)
+/// if health ~= nil and health.hp < health.max_hp then
+///     health.hp = health.hp + 1
+/// end
+/// ```
+///
+/// The layout of each view is measured from the component class itself, so
+/// it can't drift out of step with the C++ code. Only the fields listed in
+/// LuaFFI.cpp can be reached, and fields that must not be changed behind
+/// the game's back (such as positions) are read-only. A view checks the
+/// component map's removal epoch before each access, and looks the
+/// component up again if anything has been removed since, so a view that
+/// outlives its component raises a Lua error instead of touching freed
+/// memory.
+namespace LuaFFI
+{
+  /// Kinds of component with views.
+  enum class Kind : uint32_t
+  {
+    Health = 0,
+    Physical,
+    LightSource,
+    Position,
+    Count
+  };
+
+  /// Define the view types in a Lua instance and load the script that wraps
+  /// them (resources/script/component_views.lua).
+  void initialize(Lua& lua);
+}
+
+/// Get a pointer to an entity's component of a particular kind.
+/// @return The pointer, or null if the entity doesn't have one.
+LUA_FFI_EXPORT void* metahack_component_of(uint32_t kind, uint64_t entity);
+
+/// Get a pointer to the removal epoch of the component map of a particular
+/// kind. The pointer is valid for as long as the game state is.
+LUA_FFI_EXPORT uint32_t const* metahack_component_epoch(uint32_t kind);
@@ -19,11 +19,16 @@ extern "C"
 #include "entity/EntityFactory.h"
 #include "entity/EntityId.h"
 #include "lua/LuaObject.h"
+#include "map/DijkstraMap.h"
+#include "map/Map.h"
+#include "map/MapFactory.h"
+#include "map/MapPathfinder.h"
 #include "systems/Manager.h"
 #include "systems/SystemDirector.h"
 #include "systems/SystemGeometry.h"
 #include "systems/SystemJanitor.h"
 #include "systems/SystemLuaLiaison.h"
+#include "systems/SystemSenseSight.h"
 
 namespace LuaFunctions
 {
@@ -44,7 +49,7 @@ namespace LuaFunctions
     }
 
     EntityId entity = EntityId(lua_tointeger(L, 1));
-    std::string newEntityType = lua_tostring(L, 2);
+    Atom newEntityType = lua_tostring(L, 2);
 
     // Check to make sure the Entity is actually creatable.
     /// @todo Might want the ability to disable this check for debugging purposes?
@@ -193,6 +198,10 @@ namespace LuaFunctions
     auto result = Config::bible().categoryData(gameState.components().category[entity]).value(key, json());
     auto slot_count = gameState.lua().push_value(result);
 
+    // The value is pushed onto the main thread; move it over if we were
+    // called from a coroutine.
+    lua_xmove(gameState.lua().state(), L, slot_count);
+
     return slot_count;
   }
 
@@ -343,6 +352,383 @@ namespace LuaFunctions
     return 1;
   }
 
+  int entity_can_see(lua_State* L)
+  {
+    auto& systems = Systems::LuaLiaison::systems();
+
+    int num_args = lua_gettop(L);
+
+    if (num_args != 2)
+    {
+      CLOG(WARNING, "Lua") << "expected 2 arguments, got " << num_args;
+      return 0;
+    }
+
+    EntityId subject = EntityId(lua_tointeger(L, 1));
+    EntityId target = EntityId(lua_tointeger(L, 2));
+
+    bool result = systems.senseSight().subjectCanSeeEntity(subject, target);
+
+    lua_pushboolean(L, static_cast<int>(result));
+
+    return 1;
+  }
+
+  int entity_get_observers(lua_State* L)
+  {
+    auto& systems = Systems::LuaLiaison::systems();
+
+    int num_args = lua_gettop(L);
+
+    if (num_args != 2)
+    {
+      CLOG(WARNING, "Lua") << "expected 2 arguments, got " << num_args;
+      return 0;
+    }
+
+    EntityId target = EntityId(lua_tointeger(L, 1));
+
+    if (!lua_istable(L, 2))
+    {
+      CLOG(WARNING, "Lua") << "expected a table of entities as argument 2";
+      return 0;
+    }
+
+    std::vector<EntityId> subjects;
+    size_t subjectCount = lua_objlen(L, 2);
+    for (size_t index = 1; index <= subjectCount; ++index)
+    {
+      lua_rawgeti(L, 2, static_cast<int>(index));
+      subjects.push_back(EntityId(lua_tointeger(L, -1)));
+      lua_pop(L, 1);
+    }
+
+    auto observers = systems.senseSight().subjectsThatCanSee(subjects, target);
+
+    lua_createtable(L, static_cast<int>(observers.size()), 0);
+    for (size_t index = 0; index < observers.size(); ++index)
+    {
+      lua_pushinteger(L, observers[index]);
+      lua_rawseti(L, -2, static_cast<int>(index + 1));
+    }
+
+    return 1;
+  }
+
+  /// Build an entity filter from an optional table of component names at a
+  /// stack index. The filter accepts entities that have all of them.
+  /// @return True if the argument was valid (absent, nil, or a table of
+  ///         known component names), false otherwise.
+  bool get_component_filter(lua_State* L, int index, Systems::Geometry::EntityFilter& filter)
+  {
+    auto& gameState = Systems::LuaLiaison::gameState();
+
+    if (lua_gettop(L) < index || lua_isnil(L, index)) return true;
+
+    if (!lua_istable(L, index))
+    {
+      CLOG(WARNING, "Lua") << "expected a table of component names as argument " << index;
+      return false;
+    }
+
+    std::vector<Components::ComponentMap const*> required;
+    size_t nameCount = lua_objlen(L, index);
+    for (size_t nameIndex = 1; nameIndex <= nameCount; ++nameIndex)
+    {
+      lua_rawgeti(L, index, static_cast<int>(nameIndex));
+      std::string name = lua_isstring(L, -1) ? lua_tostring(L, -1) : "";
+      lua_pop(L, 1);
+
+      auto component = gameState.components().byName(name);
+      if (component == nullptr)
+      {
+        CLOG(WARNING, "Lua") << "unknown component \"" << name << "\" in argument " << index;
+        return false;
+      }
+      required.push_back(component);
+    }
+
+    if (!required.empty())
+    {
+      filter = [required](EntityId entity)
+      {
+        for (auto component : required)
+        {
+          if (!component->existsFor(entity)) return false;
+        }
+        return true;
+      };
+    }
+
+    return true;
+  }
+
+  /// Push a list of entities onto the Lua stack as an array.
+  void push_entity_list(lua_State* L, std::vector<EntityId> const& entities)
+  {
+    lua_createtable(L, static_cast<int>(entities.size()), 0);
+    for (size_t index = 0; index < entities.size(); ++index)
+    {
+      lua_pushinteger(L, entities[index]);
+      lua_rawseti(L, -2, static_cast<int>(index + 1));
+    }
+  }
+
+  int map_get_entities_in_rect(lua_State* L)
+  {
+    auto& systems = Systems::LuaLiaison::systems();
+
+    int num_args = lua_gettop(L);
+
+    if (num_args < 5 || num_args > 6)
+    {
+      CLOG(WARNING, "Lua") << "expected 5 or 6 arguments, got " << num_args;
+      return 0;
+    }
+
+    MapID map = lua_tostring(L, 1);
+    IntVec2 upperLeft{ static_cast<int>(lua_tointeger(L, 2)), static_cast<int>(lua_tointeger(L, 3)) };
+    IntVec2 lowerRight{ static_cast<int>(lua_tointeger(L, 4)), static_cast<int>(lua_tointeger(L, 5)) };
+
+    Systems::Geometry::EntityFilter filter;
+    if (!get_component_filter(L, 6, filter)) return 0;
+
+    push_entity_list(L, systems.geometry().entitiesInRect(map, upperLeft, lowerRight, filter));
+
+    return 1;
+  }
+
+  int map_get_entities_in_radius(lua_State* L)
+  {
+    auto& systems = Systems::LuaLiaison::systems();
+
+    int num_args = lua_gettop(L);
+
+    if (num_args < 4 || num_args > 5)
+    {
+      CLOG(WARNING, "Lua") << "expected 4 or 5 arguments, got " << num_args;
+      return 0;
+    }
+
+    MapID map = lua_tostring(L, 1);
+    IntVec2 center{ static_cast<int>(lua_tointeger(L, 2)), static_cast<int>(lua_tointeger(L, 3)) };
+    int radius = static_cast<int>(lua_tointeger(L, 4));
+
+    Systems::Geometry::EntityFilter filter;
+    if (!get_component_filter(L, 5, filter)) return 0;
+
+    push_entity_list(L, systems.geometry().entitiesInRadius(map, center, radius, filter));
+
+    return 1;
+  }
+
+  int entity_get_visible_entities(lua_State* L)
+  {
+    auto& gameState = Systems::LuaLiaison::gameState();
+
+    int num_args = lua_gettop(L);
+
+    if (num_args < 1 || num_args > 2)
+    {
+      CLOG(WARNING, "Lua") << "expected 1 or 2 arguments, got " << num_args;
+      return 0;
+    }
+
+    EntityId observer = EntityId(lua_tointeger(L, 1));
+    auto& senseSight = gameState.components().senseSight;
+
+    Systems::Geometry::EntityFilter filter;
+    if (!get_component_filter(L, 2, filter)) return 0;
+
+    if (!senseSight.existsFor(observer))
+    {
+      lua_createtable(L, 0, 0);
+      return 1;
+    }
+
+    auto& visible = senseSight.of(observer).visibleEntities();
+
+    lua_createtable(L, static_cast<int>(visible.size()), 0);
+    int luaIndex = 0;
+    for (auto& entity : visible)
+    {
+      if (filter && !filter(entity.id)) continue;
+      lua_pushinteger(L, entity.id);
+      lua_rawseti(L, -2, ++luaIndex);
+    }
+
+    return 1;
+  }
+
+  int entity_find_path(lua_State* L)
+  {
+    auto& gameState = Systems::LuaLiaison::gameState();
+
+    int num_args = lua_gettop(L);
+
+    if (num_args < 3 || num_args > 4)
+    {
+      CLOG(WARNING, "Lua") << "expected 3 or 4 arguments, got " << num_args;
+      return 0;
+    }
+
+    EntityId entity = EntityId(lua_tointeger(L, 1));
+    IntVec2 goal{ static_cast<int>(lua_tointeger(L, 2)), static_cast<int>(lua_tointeger(L, 3)) };
+    auto algorithm = MapPathfinder::Algorithm::JumpPoint;
+
+    if (num_args == 4)
+    {
+      std::string algorithmName = lua_isstring(L, 4) ? lua_tostring(L, 4) : "";
+      if (algorithmName == "astar")
+      {
+        algorithm = MapPathfinder::Algorithm::AStar;
+      }
+      else if (algorithmName != "jps")
+      {
+        CLOG(WARNING, "Lua") << "unknown pathfinding algorithm \"" << algorithmName << "\"";
+        return 0;
+      }
+    }
+
+    auto& position = gameState.components().position;
+    if (!position.existsFor(entity) || position.of(entity).map().empty())
+    {
+      lua_pushnil(L);
+      return 1;
+    }
+
+    auto& map = gameState.maps().get(position.of(entity).map());
+    std::vector<IntVec2> path;
+    if (!map.pathfinder().findPath(entity, position.of(entity).coords(), goal, algorithm, path))
+    {
+      lua_pushnil(L);
+      return 1;
+    }
+
+    lua_createtable(L, static_cast<int>(path.size()), 0);
+    for (size_t index = 0; index < path.size(); ++index)
+    {
+      lua_createtable(L, 0, 2);
+      lua_pushinteger(L, path[index].x);
+      lua_setfield(L, -2, "x");
+      lua_pushinteger(L, path[index].y);
+      lua_setfield(L, -2, "y");
+      lua_rawseti(L, -2, static_cast<int>(index + 1));
+    }
+
+    return 1;
+  }
+
+  int entity_get_dijkstra_step(lua_State* L)
+  {
+    auto& gameState = Systems::LuaLiaison::gameState();
+
+    int num_args = lua_gettop(L);
+
+    if (num_args < 2 || num_args > 3)
+    {
+      CLOG(WARNING, "Lua") << "expected 2 or 3 arguments, got " << num_args;
+      return 0;
+    }
+
+    EntityId entity = EntityId(lua_tointeger(L, 1));
+    std::string name = lua_tostring(L, 2);
+    bool flee = (num_args == 3) && lua_toboolean(L, 3);
+
+    auto& position = gameState.components().position;
+    if (!position.existsFor(entity) || position.of(entity).map().empty())
+    {
+      lua_pushnil(L);
+      return 1;
+    }
+
+    auto& dijkstraMap = gameState.maps().get(position.of(entity).map()).dijkstraMap(name);
+    IntVec2 from = position.of(entity).coords();
+    IntVec2 step;
+    bool hasStep = flee ? dijkstraMap.fleeStep(from, step) : dijkstraMap.nextStep(from, step);
+    if (!hasStep)
+    {
+      lua_pushnil(L);
+      return 1;
+    }
+
+    lua_pushinteger(L, step.x);
+    lua_pushinteger(L, step.y);
+
+    return 2;
+  }
+
+  int map_set_dijkstra_goals(lua_State* L)
+  {
+    auto& gameState = Systems::LuaLiaison::gameState();
+
+    int num_args = lua_gettop(L);
+
+    if (num_args != 3)
+    {
+      CLOG(WARNING, "Lua") << "expected 3 arguments, got " << num_args;
+      return 0;
+    }
+
+    MapID map = lua_tostring(L, 1);
+    std::string name = lua_tostring(L, 2);
+
+    if (!lua_istable(L, 3))
+    {
+      CLOG(WARNING, "Lua") << "expected a table of {x, y} goals as argument 3";
+      return 0;
+    }
+
+    std::vector<IntVec2> goals;
+    size_t goalCount = lua_objlen(L, 3);
+    for (size_t index = 1; index <= goalCount; ++index)
+    {
+      lua_rawgeti(L, 3, static_cast<int>(index));
+      if (lua_istable(L, -1))
+      {
+        lua_getfield(L, -1, "x");
+        lua_getfield(L, -2, "y");
+        goals.push_back({ static_cast<int>(lua_tointeger(L, -2)), static_cast<int>(lua_tointeger(L, -1)) });
+        lua_pop(L, 2);
+      }
+      lua_pop(L, 1);
+    }
+
+    gameState.maps().get(map).dijkstraMap(name).setGoals(std::move(goals));
+
+    return 0;
+  }
+
+  int map_get_dijkstra_distance(lua_State* L)
+  {
+    auto& gameState = Systems::LuaLiaison::gameState();
+
+    int num_args = lua_gettop(L);
+
+    if (num_args < 4 || num_args > 5)
+    {
+      CLOG(WARNING, "Lua") << "expected 4 or 5 arguments, got " << num_args;
+      return 0;
+    }
+
+    MapID map = lua_tostring(L, 1);
+    std::string name = lua_tostring(L, 2);
+    IntVec2 coords{ static_cast<int>(lua_tointeger(L, 3)), static_cast<int>(lua_tointeger(L, 4)) };
+    bool flee = (num_args == 5) && lua_toboolean(L, 5);
+
+    auto& dijkstraMap = gameState.maps().get(map).dijkstraMap(name);
+    int distance = flee ? dijkstraMap.fleeDistance(coords) : dijkstraMap.distance(coords);
+    if (distance == DijkstraMap::Unreachable)
+    {
+      lua_pushnil(L);
+      return 1;
+    }
+
+    lua_pushinteger(L, distance);
+
+    return 1;
+  }
+
   int get_player(lua_State* L)
   {
     auto& gameState = Systems::LuaLiaison::gameState();
@@ -373,6 +759,15 @@ namespace LuaFunctions
     LUA_REGISTER(entity_queue_targeted_action);
     LUA_REGISTER(entity_queue_directional_action);
     LUA_REGISTER(entity_move_into);
+    LUA_REGISTER(entity_can_see);
+    LUA_REGISTER(entity_get_observers);
+    LUA_REGISTER(entity_get_visible_entities);
+    LUA_REGISTER(map_get_entities_in_rect);
+    LUA_REGISTER(map_get_entities_in_radius);
+    LUA_REGISTER(entity_find_path);
+    LUA_REGISTER(entity_get_dijkstra_step);
+    LUA_REGISTER(map_set_dijkstra_goals);
+    LUA_REGISTER(map_get_dijkstra_distance);
     LUA_REGISTER(get_player);
   }
 
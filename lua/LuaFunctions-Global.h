@@ -103,12 +103,30 @@ namespace LuaFunctions
     return 0;
   }
 
+  int clear_function_cache(lua_State* L)
+  {
+    auto& gameState = Systems::LuaLiaison::gameState();
+
+    int num_args = lua_gettop(L);
+
+    if (num_args != 0)
+    {
+      CLOG(WARNING, "Lua") << "expected 0 arguments, got " << num_args;
+      return 0;
+    }
+
+    gameState.lua().clear_function_cache();
+
+    return 0;
+  }
+
   void registerFunctionsGlobal(Lua& lua)
   {
     LUA_REGISTER(get_config);
     LUA_REGISTER(get_frame_counter);
     LUA_REGISTER(message);
     LUA_REGISTER(redirect_print);
+    LUA_REGISTER(clear_function_cache);
   }
 
 } // end namespace
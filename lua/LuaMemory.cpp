@@ -0,0 +1,256 @@
+#include "stdafx.h"
+
+#include "lua/LuaMemory.h"
+
+#include <cstring>
+
+namespace
+{
+  /// Sizes of the blocks in the pool. Each is a multiple of 16, so blocks
+  /// carved out of an arena are as well aligned as the arena itself.
+  size_t const SizeClasses[] = { 16, 32, 48, 64, 96, 128, 192, 256 };
+
+  size_t const SizeClassCount = sizeof(SizeClasses) / sizeof(SizeClasses[0]);
+
+  /// Size of each arena the pool's blocks are carved out of.
+  size_t const ArenaSize = 64 * 1024;
+}
+
+LuaMemory::LuaMemory(bool usePool)
+  :
+  m_usePool{ usePool },
+  m_freeBlocks(SizeClassCount, nullptr)
+{}
+
+LuaMemory::~LuaMemory()
+{
+  for (auto arena : m_arenas)
+  {
+    std::free(arena);
+  }
+}
+
+void* LuaMemory::allocate(void* memory, void* block, size_t oldSize, size_t newSize)
+{
+  auto& self = *static_cast<LuaMemory*>(memory);
+  if (block == nullptr) oldSize = 0;
+
+  void* result;
+  int oldClass = (self.m_usePool && (block != nullptr)) ? sizeClass(oldSize) : -1;
+  int newClass = (self.m_usePool && (newSize != 0)) ? sizeClass(newSize) : -1;
+
+  if ((oldClass < 0) && (newClass < 0))
+  {
+    result = self.allocateUpstream(block, oldSize, newSize);
+  }
+  else if (oldClass == newClass)
+  {
+    // Still fits the block it has.
+    result = block;
+  }
+  else
+  {
+    // Moving into, out of, or around the pool.
+    result = nullptr;
+    if (newSize != 0)
+    {
+      result = (newClass >= 0) ? self.allocateFromPool(newClass) : self.allocateUpstream(nullptr, 0, newSize);
+
+      // Lua expects the old block to be left alone if this fails.
+      if (result == nullptr) return nullptr;
+
+      if (block != nullptr) std::memcpy(result, block, std::min(oldSize, newSize));
+    }
+
+    if (block != nullptr)
+    {
+      if (oldClass >= 0)
+      {
+        self.freeToPool(block, oldClass);
+      }
+      else
+      {
+        self.allocateUpstream(block, oldSize, 0);
+      }
+    }
+  }
+
+  if ((result != nullptr) || (newSize == 0)) self.count(oldSize, newSize);
+  return result;
+}
+
+void LuaMemory::wrap(lua_State* L)
+{
+  m_upstream = lua_getallocf(L, &m_upstreamData);
+  m_usePool = false;
+
+  // Whatever the state allocated before now belongs to no phase.
+  m_bytesInUse = (static_cast<uint64_t>(lua_gc(L, LUA_GCCOUNT, 0)) * 1024) + lua_gc(L, LUA_GCCOUNTB, 0);
+  m_peakBytesInUse = m_bytesInUse;
+
+  lua_setallocf(L, LuaMemory::allocate, this);
+}
+
+void LuaMemory::unwrap(lua_State* L)
+{
+  if (m_upstream != nullptr)
+  {
+    lua_setallocf(L, m_upstream, m_upstreamData);
+    m_upstream = nullptr;
+    m_upstreamData = nullptr;
+  }
+}
+
+LuaMemory::Phase LuaMemory::phase() const
+{
+  return m_phase;
+}
+
+LuaMemory::PhaseStats const& LuaMemory::stats(Phase phase) const
+{
+  return m_stats[static_cast<size_t>(phase)];
+}
+
+uint64_t LuaMemory::bytesInUse() const
+{
+  return m_bytesInUse;
+}
+
+uint64_t LuaMemory::peakBytesInUse() const
+{
+  return m_peakBytesInUse;
+}
+
+bool LuaMemory::pooled() const
+{
+  return m_usePool;
+}
+
+LuaMemory::CollectorStats& LuaMemory::collector()
+{
+  return m_collector;
+}
+
+void LuaMemory::logStats() const
+{
+  CLOG(DEBUG, "Lua") << "Lua memory: " << m_bytesInUse << " bytes in use, peak " << m_peakBytesInUse <<
+    (m_usePool ? ", " + std::to_string(m_arenas.size()) + " pool arenas" : std::string(", pool not in use"));
+
+  for (size_t index = 0; index < m_stats.size(); ++index)
+  {
+    auto& stats = m_stats[index];
+    CLOG(DEBUG, "Lua") << "Lua memory, phase " << static_cast<Phase>(index) << ": " <<
+      stats.allocations << " allocations (" << stats.bytesAllocated << " bytes), " <<
+      stats.frees << " frees (" << stats.bytesFreed << " bytes)";
+  }
+
+  CLOG(DEBUG, "Lua") << "Lua garbage collection: " << m_collector.steps << " steps, " <<
+    m_collector.cycles << " cycles finished, " << m_collector.time.count() << " us";
+}
+
+void to_json(json& j, LuaMemory const& obj)
+{
+  j = json::object();
+  j["bytes_in_use"] = obj.m_bytesInUse;
+  j["peak_bytes_in_use"] = obj.m_peakBytesInUse;
+  j["pooled"] = obj.m_usePool;
+  j["pool_arenas"] = obj.m_arenas.size();
+
+  json phases = json::object();
+  for (size_t index = 0; index < obj.m_stats.size(); ++index)
+  {
+    auto& stats = obj.m_stats[index];
+    json phase;
+    phase["allocations"] = stats.allocations;
+    phase["frees"] = stats.frees;
+    phase["bytes_allocated"] = stats.bytesAllocated;
+    phase["bytes_freed"] = stats.bytesFreed;
+    phases[boost::lexical_cast<std::string>(static_cast<LuaMemory::Phase>(index))] = phase;
+  }
+  j["phases"] = phases;
+
+  json collector;
+  collector["steps"] = obj.m_collector.steps;
+  collector["cycles"] = obj.m_collector.cycles;
+  collector["time_ms"] = obj.m_collector.time.count() / 1000.0;
+  j["gc"] = collector;
+}
+
+int LuaMemory::sizeClass(size_t size)
+{
+  for (size_t index = 0; index < SizeClassCount; ++index)
+  {
+    if (size <= SizeClasses[index]) return static_cast<int>(index);
+  }
+  return -1;
+}
+
+void* LuaMemory::allocateFromPool(int sizeClass)
+{
+  FreeBlock*& head = m_freeBlocks[sizeClass];
+  if (head != nullptr)
+  {
+    FreeBlock* block = head;
+    head = block->next;
+    return block;
+  }
+
+  size_t size = SizeClasses[sizeClass];
+  if (m_arenaLeft < size)
+  {
+    // Whatever is left of the old arena is too small for this class, and
+    // is simply wasted.
+    char* arena = static_cast<char*>(std::malloc(ArenaSize));
+    if (arena == nullptr) return nullptr;
+
+    m_arenas.push_back(arena);
+    m_arenaNext = arena;
+    m_arenaLeft = ArenaSize;
+  }
+
+  void* block = m_arenaNext;
+  m_arenaNext += size;
+  m_arenaLeft -= size;
+  return block;
+}
+
+void LuaMemory::freeToPool(void* block, int sizeClass)
+{
+  FreeBlock* freeBlock = static_cast<FreeBlock*>(block);
+  freeBlock->next = m_freeBlocks[sizeClass];
+  m_freeBlocks[sizeClass] = freeBlock;
+}
+
+void* LuaMemory::allocateUpstream(void* block, size_t oldSize, size_t newSize)
+{
+  if (m_upstream != nullptr)
+  {
+    return m_upstream(m_upstreamData, block, oldSize, newSize);
+  }
+
+  if (newSize == 0)
+  {
+    std::free(block);
+    return nullptr;
+  }
+  return std::realloc(block, newSize);
+}
+
+void LuaMemory::count(size_t oldSize, size_t newSize)
+{
+  auto& stats = m_stats[static_cast<size_t>(m_phase)];
+
+  if (newSize > oldSize)
+  {
+    ++stats.allocations;
+    stats.bytesAllocated += newSize - oldSize;
+    m_bytesInUse += newSize - oldSize;
+    m_peakBytesInUse = std::max(m_peakBytesInUse, m_bytesInUse);
+  }
+  else if (newSize < oldSize)
+  {
+    if (newSize == 0) ++stats.frees;
+    stats.bytesFreed += oldSize - newSize;
+    m_bytesInUse -= std::min<uint64_t>(m_bytesInUse, oldSize - newSize);
+  }
+}
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+/// Memory allocator and statistics for a Lua state.
+///
+/// Every allocation the Lua state makes goes through `allocate`, which
+/// counts the bytes and blocks allocated and freed, split up by what the
+/// game was doing at the time (its "phase"; see `Scope`).
+///
+/// If the state can be created with a custom allocator, small blocks (which
+/// are most of what Lua allocates: strings, tables, closures) come from
+/// per-size-class free lists carved out of large arenas, instead of the
+/// system allocator. Memory in the arenas is reused by Lua, but is only
+/// handed back to the system when the state is closed.
+///
+/// LuaJIT on 64-bit platforms won't create a state with a custom allocator,
+/// since its own has to keep the heap in the low 2GB of address space. In
+/// that case `wrap` puts the counters in front of LuaJIT's allocator
+/// instead, and the pool is not used.
+class LuaMemory
+{
+public:
+  /// What the game is running Lua for.
+  enum class Phase
+  {
+    Other = 0,    ///< Loading scripts, console commands, anything else
+    AI,           ///< Entity AI, run by the Director
+    Callbacks,    ///< Entity and action callbacks
+    MapScript,    ///< Map generation scripts
+    Count
+  };
+
+  friend std::ostream& operator<<(std::ostream& os, Phase const& phase)
+  {
+    switch (phase)
+    {
+      case Phase::Other:      os << "Other"; break;
+      case Phase::AI:         os << "AI"; break;
+      case Phase::Callbacks:  os << "Callbacks"; break;
+      case Phase::MapScript:  os << "MapScript"; break;
+      default:                os << "??? (" << static_cast<int>(phase) << ")"; break;
+    }
+    return os;
+  }
+
+  /// Counts of allocations made during one phase.
+  struct PhaseStats
+  {
+    /// Blocks allocated or grown.
+    uint64_t allocations = 0;
+
+    /// Blocks freed.
+    uint64_t frees = 0;
+
+    /// Bytes allocated, including growth of existing blocks.
+    uint64_t bytesAllocated = 0;
+
+    /// Bytes freed, including shrinking of existing blocks.
+    uint64_t bytesFreed = 0;
+  };
+
+  /// Counts of garbage collection run by `Lua::collectGarbage`.
+  struct CollectorStats
+  {
+    /// Incremental steps run.
+    uint64_t steps = 0;
+
+    /// Collection cycles finished by those steps.
+    uint64_t cycles = 0;
+
+    /// Total time spent in those steps.
+    std::chrono::microseconds time{ 0 };
+  };
+
+  /// Sets the phase for as long as it exists. Scopes nest, and the
+  /// outermost one wins: callbacks run by AI scripts count as AI.
+  class Scope
+  {
+  public:
+    Scope(LuaMemory& memory, Phase phase)
+      :
+      m_memory{ memory },
+      m_previous{ memory.m_phase }
+    {
+      if (m_previous == Phase::Other) m_memory.m_phase = phase;
+    }
+
+    ~Scope()
+    {
+      m_memory.m_phase = m_previous;
+    }
+
+  private:
+    LuaMemory& m_memory;
+    Phase m_previous;
+  };
+
+  /// @param usePool  Whether to allocate small blocks from the pool, if
+  ///                 the Lua state is created with `allocate`.
+  LuaMemory(bool usePool);
+
+  ~LuaMemory();
+
+  /// The allocator function to create a Lua state with, as in
+  /// `lua_newstate(LuaMemory::allocate, memory)`.
+  static void* allocate(void* memory, void* block, size_t oldSize, size_t newSize);
+
+  /// Put the counters in front of the allocator a Lua state already has.
+  /// The pool is not used.
+  void wrap(lua_State* L);
+
+  /// Give a wrapped Lua state its own allocator back. Must be called
+  /// before closing it, so the allocator can clean up after itself.
+  void unwrap(lua_State* L);
+
+  /// Get the current phase.
+  Phase phase() const;
+
+  /// Get the counts for a phase.
+  PhaseStats const& stats(Phase phase) const;
+
+  /// Get the number of bytes Lua has in use.
+  uint64_t bytesInUse() const;
+
+  /// Get the largest number of bytes Lua has had in use at once.
+  uint64_t peakBytesInUse() const;
+
+  /// Get whether small blocks are coming from the pool.
+  bool pooled() const;
+
+  /// Get the garbage collection counts, to be updated by the caller.
+  CollectorStats& collector();
+
+  /// Write a summary of the statistics to the log.
+  void logStats() const;
+
+  friend void to_json(json& j, LuaMemory const& obj);
+
+protected:
+  /// Helper method for `allocate`. Get the size class of a block.
+  /// @return The index of the class, or -1 if too big for the pool.
+  static int sizeClass(size_t size);
+
+  /// Helper method for `allocate`. Get a block from the pool.
+  void* allocateFromPool(int sizeClass);
+
+  /// Helper method for `allocate`. Return a block to the pool.
+  void freeToPool(void* block, int sizeClass);
+
+  /// Helper method for `allocate`. Allocate, resize or free a block that
+  /// isn't in the pool.
+  void* allocateUpstream(void* block, size_t oldSize, size_t newSize);
+
+  /// Helper method for `allocate`. Count an allocation in the current
+  /// phase.
+  void count(size_t oldSize, size_t newSize);
+
+private:
+  /// A free block in the pool, linked to the next one of the same size.
+  struct FreeBlock
+  {
+    FreeBlock* next;
+  };
+
+  /// Allocator the state was created with, when wrapped.
+  lua_Alloc m_upstream = nullptr;
+  void* m_upstreamData = nullptr;
+
+  /// Whether to use the pool.
+  bool m_usePool;
+
+  /// Current phase.
+  Phase m_phase = Phase::Other;
+
+  /// Counts by phase.
+  std::array<PhaseStats, static_cast<size_t>(Phase::Count)> m_stats;
+
+  /// Bytes in use, and the most there have ever been.
+  uint64_t m_bytesInUse = 0;
+  uint64_t m_peakBytesInUse = 0;
+
+  /// Garbage collection counts.
+  CollectorStats m_collector;
+
+  /// Heads of the free lists, one per size class.
+  std::vector<FreeBlock*> m_freeBlocks;
+
+  /// Arenas the pool's blocks are carved out of.
+  std::vector<char*> m_arenas;
+
+  /// Next unused byte in the newest arena, and the number left after it.
+  char* m_arenaNext = nullptr;
+  size_t m_arenaLeft = 0;
+};
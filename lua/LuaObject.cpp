@@ -6,15 +6,44 @@
 #include "components/ComponentManager.h"
 #include "config/Bible.h"
 #include "config/Paths.h"
+#include "config/Settings.h"
 #include "entity/EntityId.h"
 #include "types/Direction.h"
 #include "types/Color.h"
 #include "types/Gender.h"
 
+namespace
+{
+  /// Called on an error outside of any protected call. (luaL_newstate sets
+  /// up one of its own.)
+  int panic(lua_State* L)
+  {
+    CLOG(FATAL, "Lua") << "Unprotected error in Lua: " << lua_tostring(L, -1);
+    return 0;
+  }
+
+  /// Parts of the names of functions called on entities.
+  Atom const BatchSuffix{ "_batch" };
+  Atom const CoroutineSuffix{ "_coroutine" };
+  Atom const DoPrefix{ "do_" };
+  Atom const OnObjectOfPrefix{ "on_object_of_" };
+}
+
 Lua::Lua()
 {
-  // Initialize the Lua interpreter.
-  L_ = luaL_newstate();
+  // Initialize the Lua interpreter. 64-bit LuaJIT insists on using its own
+  // allocator, so there the allocator can only be wrapped.
+  m_memory.reset(NEW LuaMemory(Config::settings().get("lua-pool-allocator").get<bool>()));
+  L_ = (sizeof(void*) == 4) ? lua_newstate(LuaMemory::allocate, m_memory.get()) : nullptr;
+  if (L_ != nullptr)
+  {
+    lua_atpanic(L_, panic);
+  }
+  else
+  {
+    L_ = luaL_newstate();
+    m_memory->wrap(L_);
+  }
 
   // Load the base libraries.
   luaL_openlibs(L_);
@@ -35,13 +64,18 @@ Lua::Lua()
 
 Lua::~Lua()
 {
+  logCallCounts();
+  m_memory->logStats();
+
   /// Clean up Lua.
+  m_memory->unwrap(L_);
   lua_close(L_);
 }
 
 void Lua::register_function(std::string name, lua_CFunction func)
 {
   lua_register(L_, name.c_str(), func);
+  clear_function_cache();
 }
 
 void Lua::do_file(FileName filename)
@@ -51,6 +85,7 @@ void Lua::do_file(FileName filename)
   {
     fprintf(stderr, "%s\n", lua_tostring(L_, -1));
   }
+  clear_function_cache();
 }
 
 void Lua::require(FileName packagename, bool fatal)
@@ -62,6 +97,9 @@ void Lua::require(FileName packagename, bool fatal)
   lua_pushstring(L_, packagename.c_str());     // arg 0: module name
   err = lua_pcall(L_, 1, 1, 0);
 
+  // The script may have defined or replaced functions.
+  clear_function_cache();
+
   if (err)
   {
     if (fatal)
@@ -256,6 +294,12 @@ int Lua::push_value(std::string value)
   return 1;
 }
 
+int Lua::push_value(Atom value)
+{
+  lua_pushstring(L_, value.c_str());
+  return 1;
+}
+
 int Lua::push_value(UintVec2 value)
 {
   lua_pushinteger(L_, static_cast<lua_Integer>(value.x));
@@ -434,8 +478,109 @@ unsigned int Lua::stack_slots(Lua::Type type) const
   }
 }
 
+bool Lua::read_value(int index, int available, bool& value) const
+{
+  if (available < 1) return false;
+  value = (lua_toboolean(L_, index) != 0);
+  return true;
+}
+
+bool Lua::read_value(int index, int available, int& value) const
+{
+  if (available < 1) return false;
+  value = static_cast<int>(lua_tointeger(L_, index));
+  return true;
+}
+
+bool Lua::read_value(int index, int available, unsigned int& value) const
+{
+  if (available < 1) return false;
+  value = static_cast<unsigned int>(lua_tointeger(L_, index));
+  return true;
+}
+
+bool Lua::read_value(int index, int available, EntityId& value) const
+{
+  if (available < 1) return false;
+  value = EntityId(lua_tointeger(L_, index));
+  return true;
+}
+
+bool Lua::read_value(int index, int available, float& value) const
+{
+  if (available < 1) return false;
+  value = static_cast<float>(lua_tonumber(L_, index));
+  return true;
+}
+
+bool Lua::read_value(int index, int available, double& value) const
+{
+  if (available < 1) return false;
+  value = static_cast<double>(lua_tonumber(L_, index));
+  return true;
+}
+
+bool Lua::read_value(int index, int available, std::string& value) const
+{
+  if ((available < 1) || !lua_isstring(L_, index)) return false;
+  value = lua_tostring(L_, index);
+  return true;
+}
+
+bool Lua::read_value(int index, int available, UintVec2& value) const
+{
+  if (available < 2) return false;
+  value = UintVec2(static_cast<uint32_t>(lua_tointeger(L_, index)),
+                   static_cast<uint32_t>(lua_tointeger(L_, index + 1)));
+  return true;
+}
+
+bool Lua::read_value(int index, int available, IntVec2& value) const
+{
+  if (available < 2) return false;
+  value = IntVec2(static_cast<int32_t>(lua_tointeger(L_, index)),
+                  static_cast<int32_t>(lua_tointeger(L_, index + 1)));
+  return true;
+}
+
+bool Lua::read_value(int index, int available, RealVec2& value) const
+{
+  if (available < 2) return false;
+  value = RealVec2(static_cast<float>(lua_tonumber(L_, index)),
+                   static_cast<float>(lua_tonumber(L_, index + 1)));
+  return true;
+}
+
+bool Lua::read_value(int index, int available, Direction& value) const
+{
+  if (available < 3) return false;
+  value = Direction(static_cast<int>(lua_tointeger(L_, index)),
+                    static_cast<int>(lua_tointeger(L_, index + 1)),
+                    static_cast<int>(lua_tointeger(L_, index + 2)));
+  return true;
+}
+
+bool Lua::read_value(int index, int available, Color& value) const
+{
+  if (available < 4) return false;
+  value = Color(static_cast<uint8_t>(lua_tointeger(L_, index)),
+                static_cast<uint8_t>(lua_tointeger(L_, index + 1)),
+                static_cast<uint8_t>(lua_tointeger(L_, index + 2)),
+                static_cast<uint8_t>(lua_tointeger(L_, index + 3)));
+  return true;
+}
+
 std::string Lua::find_lua_function(std::string category, std::string suffix) const
 {
+  return resolve_lua_function(category, suffix).name.str();
+}
+
+Lua::ResolvedFunction Lua::resolve_lua_function(Atom category, Atom suffix) const
+{
+  uint64_t key = (static_cast<uint64_t>(category.value()) << 32) | suffix.value();
+  auto iter = m_functionCache.find(key);
+  if (iter != m_functionCache.end()) return iter->second;
+
   std::string result = find_lua_function_(category, suffix);
   if (result.empty())
   {
@@ -444,12 +589,65 @@ std::string Lua::find_lua_function(std::string category, std::string suffix) con
     for (size_t index = 0; index < templates.size(); ++index)
     {
       result = find_lua_function_(templates[index].get<std::string>(), suffix);
-      if (result != "") return result;
+      if (result != "") break;
     }
   }
 
-  // Nothing found, return empty string.
-  return result;
+  // Keep a reference to the function itself, so calling it doesn't need a
+  // global lookup. Functions that weren't found are cached too.
+  ResolvedFunction function;
+  if (!result.empty())
+  {
+    // Push the function onto the stack, then pop it into the registry. (+1, -1)
+    lua_getglobal(L_, result.c_str());
+    function.reference = luaL_ref(L_, LUA_REGISTRYINDEX);
+    function.name = result;
+  }
+
+  m_functionCache[key] = function;
+  return function;
+}
+
+Atom Lua::joined_name(Atom first, Atom second) const
+{
+  uint64_t key = (static_cast<uint64_t>(first.value()) << 32) | second.value();
+  auto iter = m_joinedNames.find(key);
+  if (iter == m_joinedNames.end())
+  {
+    iter = m_joinedNames.emplace(key, Atom(first.str() + second.str())).first;
+  }
+  return iter->second;
+}
+
+bool Lua::hasEntityFunction(EntityId entity, Atom suffix)
+{
+  if (resolve_lua_function(COMPONENTS.category[entity], suffix).exists()) return true;
+
+  ++m_callCounts[suffix].elided;
+  return false;
+}
+
+std::unordered_map<Atom, Lua::CallCounts> const& Lua::callCounts() const
+{
+  return m_callCounts;
+}
+
+void Lua::logCallCounts() const
+{
+  for (auto& pair : m_callCounts)
+  {
+    CLOG(DEBUG, "Lua") << "Entity function " << pair.first << ": " <<
+      pair.second.made << " calls made, " << pair.second.elided << " elided";
+  }
+}
+
+void Lua::clear_function_cache()
+{
+  for (auto& pair : m_functionCache)
+  {
+    if (pair.second.exists()) luaL_unref(L_, LUA_REGISTRYINDEX, pair.second.reference);
+  }
+  m_functionCache.clear();
 }
 
 std::string Lua::find_lua_function_(std::string category, std::string suffix) const
@@ -473,35 +671,36 @@ std::string Lua::find_lua_function_(std::string category, std::string suffix) co
   }
 }
 
-json Lua::callEntityFunction(std::string function_name,
+json Lua::callEntityFunction(Atom function_name,
                              EntityId caller,
                              json const& args,
                              json default_result)
 {
+  LuaMemory::Scope scope(*m_memory, LuaMemory::Phase::Callbacks);
   json return_value = default_result;
   Lua::Type return_type;
-  std::string caller_type = COMPONENTS.category[caller];
+  Atom caller_type = COMPONENTS.category[caller];
 
   int start_stack = lua_gettop(L_);
 
-  auto original_function_name = caller_type + "_" + function_name;
-
-  // Get full function name (with type prefixed).
-  auto full_function_name = find_lua_function(caller_type, function_name);
+  // Get the function (with type prefixed).
+  auto function = resolve_lua_function(caller_type, function_name);
 
   // If it doesn't exist after going all the way up the family tree, return
   // the default result.
-  if (full_function_name.empty())
+  if (!function.exists())
   {
     CLOG(TRACE, "Lua") << "Could not find Lua function "
-      << original_function_name << " after traversing family tree";
+      << caller_type << "_" << function_name << " after traversing family tree";
 
+    ++m_callCounts[function_name].elided;
     return default_result;
   }
 
-  // Push name of function onto the stack. (+1)
-  // (Shouldn't fail here; if it does, find_lua_function() is borked.)
-  lua_getglobal(L_, full_function_name.c_str());
+  ++m_callCounts[function_name].made;
+
+  // Push the function onto the stack. (+1)
+  lua_rawgeti(L_, LUA_REGISTRYINDEX, function.reference);
 
   // Push the caller's ID onto the stack. (+1)
   lua_pushinteger(L_, caller);
@@ -530,8 +729,8 @@ json Lua::callEntityFunction(std::string function_name,
   {
     // Get the error message.
     char const* error_message = lua_tostring(L_, -1);
-    CLOG(ERROR, "Lua") << "Error calling " << full_function_name <<
-      " (" << original_function_name << "): " << error_message;
+    CLOG(ERROR, "Lua") << "Error calling " << function.name <<
+      " (" << caller_type << "_" << function_name << "): " << error_message;
 
     // Pop the error message off the stack. (-1)
     lua_pop(L_, 1);
@@ -541,32 +740,235 @@ json Lua::callEntityFunction(std::string function_name,
 
   if (start_stack != end_stack)
   {
-    CLOG(FATAL, "Lua") << "*** LUA STACK MISMATCH (" << full_function_name <<
-      " (" << original_function_name << "): Started at " << start_stack <<
+    CLOG(FATAL, "Lua") << "*** LUA STACK MISMATCH (" << function.name <<
+      " (" << caller_type << "_" << function_name << "): Started at " << start_stack <<
       ", ended at " << end_stack;
   }
 
   return return_value;
 }
 
+Lua::ResolvedFunction Lua::push_entity_function(Atom function_name, EntityId caller)
+{
+  Atom caller_type = COMPONENTS.category[caller];
+  auto function = resolve_lua_function(caller_type, function_name);
+
+  if (!function.exists())
+  {
+    CLOG(TRACE, "Lua") << "Could not find Lua function "
+      << caller_type << "_" << function_name << " after traversing family tree";
+
+    ++m_callCounts[function_name].elided;
+    return function;
+  }
+
+  ++m_callCounts[function_name].made;
+
+  // Push the function and the caller's ID onto the stack. (+2)
+  lua_rawgeti(L_, LUA_REGISTRYINDEX, function.reference);
+  lua_pushinteger(L_, caller);
+
+  return function;
+}
+
+bool Lua::pcall_entity_function(ResolvedFunction const& function, int args)
+{
+  if (lua_pcall(L_, args, LUA_MULTRET, 0) == 0) return true;
+
+  CLOG(ERROR, "Lua") << "Error calling " << function.name << ": " << lua_tostring(L_, -1);
+
+  // Pop the error message off the stack. (-1)
+  lua_pop(L_, 1);
+  return false;
+}
+
+std::vector<json> Lua::callEntityBatchFunction(Atom function_name,
+                                               Atom category,
+                                               std::vector<EntityId> const& entities)
+{
+  std::vector<json> results(entities.size());
+  if (entities.empty()) return results;
+
+  int start_stack = lua_gettop(L_);
+
+  auto batch_function = resolve_lua_function(category, joined_name(function_name, BatchSuffix));
+
+  if (!batch_function.exists())
+  {
+    // No batch function, so call the single-entity one for each entity.
+    auto function = resolve_lua_function(category, function_name);
+    if (!function.exists())
+    {
+      CLOG(TRACE, "Lua") << "Could not find Lua function "
+        << category << "_" << function_name << " after traversing family tree";
+      return results;
+    }
+
+    for (auto entity : entities)
+    {
+      // Push the function and the entity's ID onto the stack. (+2)
+      lua_rawgeti(L_, LUA_REGISTRYINDEX, function.reference);
+      lua_pushinteger(L_, entity);
+
+      // Call the function, discarding any results. (-2)
+      if (lua_pcall(L_, 1, 0, 0) != 0)
+      {
+        CLOG(ERROR, "Lua") << "Error calling " << function.name <<
+          " for entity " << entity << ": " << lua_tostring(L_, -1);
+
+        // Pop the error message off the stack. (-1)
+        lua_pop(L_, 1);
+      }
+    }
+  }
+  else
+  {
+    // Push the function onto the stack. (+1)
+    lua_rawgeti(L_, LUA_REGISTRYINDEX, batch_function.reference);
+
+    // Push an array of the entities' IDs onto the stack. (+1)
+    lua_createtable(L_, static_cast<int>(entities.size()), 0);
+    for (size_t index = 0; index < entities.size(); ++index)
+    {
+      lua_pushinteger(L_, entities[index]);
+      lua_rawseti(L_, -2, static_cast<int>(index + 1));
+    }
+
+    // Call the function with one argument and one result. (-2, +1)
+    if (lua_pcall(L_, 1, 1, 0) == 0)
+    {
+      if (lua_istable(L_, -1))
+      {
+        for (size_t index = 0; index < entities.size(); ++index)
+        {
+          // Push the entity's entry onto the stack. (+1)
+          lua_rawgeti(L_, -1, static_cast<int>(index + 1));
+          results[index] = read_batch_action(L_);
+          // Pop the entry off the stack. (-1)
+          lua_pop(L_, 1);
+        }
+      }
+      else if (!lua_isnoneornil(L_, -1))
+      {
+        CLOG(WARNING, "Lua") << batch_function.name << " returned a " <<
+          luaL_typename(L_, -1) << " instead of a table";
+      }
+    }
+    else
+    {
+      CLOG(ERROR, "Lua") << "Error calling " << batch_function.name << ": " <<
+        lua_tostring(L_, -1);
+    }
+
+    // Pop the result or error message off the stack. (-1)
+    lua_pop(L_, 1);
+  }
+
+  int end_stack = lua_gettop(L_);
+
+  if (start_stack != end_stack)
+  {
+    CLOG(FATAL, "Lua") << "*** LUA STACK MISMATCH (" << category << "_" <<
+      function_name << " batch): Started at " << start_stack <<
+      ", ended at " << end_stack;
+  }
+
+  return results;
+}
+
+bool Lua::resumeEntityCoroutines(Atom function_name,
+                                 Atom category,
+                                 std::vector<EntityId> const& entities,
+                                 std::vector<json>& results)
+{
+  auto function = resolve_lua_function(category, joined_name(function_name, CoroutineSuffix));
+  if (!function.exists()) return false;
+
+  results.assign(entities.size(), json());
+
+  for (size_t index = 0; index < entities.size(); ++index)
+  {
+    EntityId entity = entities[index];
+    lua_State* thread;
+    int args;
+
+    auto iter = m_coroutines.find(entity);
+    if (iter != m_coroutines.end())
+    {
+      // Pick up where the coroutine left off.
+      thread = iter->second.thread;
+      args = 0;
+    }
+    else
+    {
+      // Start a new coroutine, keeping a reference to it in the registry so
+      // it isn't collected while it is suspended. (+1, -1)
+      thread = lua_newthread(L_);
+      int reference = luaL_ref(L_, LUA_REGISTRYINDEX);
+      m_coroutines[entity] = { reference, thread };
+
+      // Push the function and the entity's ID onto its stack. (+2)
+      lua_rawgeti(thread, LUA_REGISTRYINDEX, function.reference);
+      lua_pushinteger(thread, entity);
+      args = 1;
+    }
+
+    int status = lua_resume(thread, args);
+
+    if ((status == LUA_YIELD) || (status == 0))
+    {
+      // Whatever was yielded or returned last is the action, if any.
+      if (lua_gettop(thread) > 0)
+      {
+        results[index] = read_batch_action(thread);
+      }
+      lua_settop(thread, 0);
+    }
+    else
+    {
+      CLOG(ERROR, "Lua") << "Error in " << function.name <<
+        " for entity " << entity << ": " << lua_tostring(thread, -1);
+    }
+
+    // A coroutine that has returned or failed can't be resumed; the next
+    // time the entity is idle it will start over.
+    if (status != LUA_YIELD)
+    {
+      releaseEntityCoroutine(entity);
+    }
+  }
+
+  return true;
+}
+
+void Lua::releaseEntityCoroutine(EntityId entity)
+{
+  auto iter = m_coroutines.find(entity);
+  if (iter != m_coroutines.end())
+  {
+    luaL_unref(L_, LUA_REGISTRYINDEX, iter->second.reference);
+    m_coroutines.erase(iter);
+  }
+}
+
 bool Lua::doReflexiveAction(EntityId subject, Actions::Action& action)
 {
-  return callEntityFunction("do_" + action.getType(), subject, {}, true);
+  return call<bool>(joined_name(DoPrefix, action.getType()), subject, true);
 }
 
 bool Lua::doSubjectActionObject(EntityId subject, Actions::Action& action, EntityId object)
 {
-  return callEntityFunction("on_object_of_" + action.getType(), object, subject, true);
+  return call<bool>(joined_name(OnObjectOfPrefix, action.getType()), object, true, subject);
 }
 
 bool Lua::doSubjectActionObjectTarget(EntityId subject, Actions::Action& action, EntityId object, EntityId target)
 {
-  return callEntityFunction("on_object_of_" + action.getType(), object, { subject, target }, true);
+  return call<bool>(joined_name(OnObjectOfPrefix, action.getType()), object, true, subject, target);
 }
 
 bool Lua::doSubjectActionObjectDirection(EntityId subject, Actions::Action& action, EntityId object, Direction direction)
 {
-  return callEntityFunction("on_object_of_" + action.getType(), object, { subject, direction }, true);
+  return call<bool>(joined_name(OnObjectOfPrefix, action.getType()), object, true, subject, direction);
 }
 
 json Lua::callModifierFunction(std::string property_name,
@@ -576,6 +978,7 @@ json Lua::callModifierFunction(std::string property_name,
                                EntityId responsible_id,
                                std::string suffix)
 {
+  LuaMemory::Scope scope(*m_memory, LuaMemory::Phase::Callbacks);
   json return_value = unmodified_value;
   Lua::Type return_type;
   std::string function_name = "modify_property_" + property_name;
@@ -586,24 +989,21 @@ json Lua::callModifierFunction(std::string property_name,
 
   int start_stack = lua_gettop(L_);
 
-  auto original_function_name = responsible_group + "_" + function_name;
-
-  // Get full function name (with type prefixed).
-  auto full_function_name = find_lua_function(responsible_group, function_name);
+  // Get the function (with type prefixed).
+  auto function = resolve_lua_function(responsible_group, function_name);
 
   // If it doesn't exist after going all the way up the family tree, return
   // the default result.
-  if (full_function_name.empty())
+  if (!function.exists())
   {
     CLOG(TRACE, "Lua") << "Could not find Lua function "
-      << original_function_name << " after traversing family tree";
+      << responsible_group << "_" << function_name << " after traversing family tree";
 
     return return_value;
   }
 
-  // Push name of function onto the stack. (+1)
-  // (Shouldn't fail here; if it does, find_lua_function() is borked.)
-  lua_getglobal(L_, full_function_name.c_str());
+  // Push the function onto the stack. (+1)
+  lua_rawgeti(L_, LUA_REGISTRYINDEX, function.reference);
 
   // Push the affected entity's ID onto the stack. (+1)
   lua_pushinteger(L_, affected_id);
@@ -629,8 +1029,8 @@ json Lua::callModifierFunction(std::string property_name,
   {
     // Get the error message.
     char const* error_message = lua_tostring(L_, -1);
-    CLOG(ERROR, "Lua") << "Error calling " << full_function_name <<
-      " (" << original_function_name << "): " << error_message;
+    CLOG(ERROR, "Lua") << "Error calling " << function.name <<
+      " (" << responsible_group << "_" << function_name << "): " << error_message;
 
     // Pop the error message off the stack. (-1)
     lua_pop(L_, 1);
@@ -639,6 +1039,106 @@ json Lua::callModifierFunction(std::string property_name,
   return return_value;
 }
 
+json Lua::read_batch_action(lua_State* L)
+{
+  if (!lua_istable(L, -1)) return json();
+
+  json action;
+
+  lua_getfield(L, -1, "action");
+  if (lua_isstring(L, -1)) action["action"] = lua_tostring(L, -1);
+  lua_pop(L, 1);
+
+  if (action.is_null())
+  {
+    CLOG(WARNING, "Lua") << "Batch action table has no \"action\" field";
+    return json();
+  }
+
+  lua_getfield(L, -1, "target");
+  if (lua_isnumber(L, -1)) action["target"] = EntityId(lua_tointeger(L, -1));
+  lua_pop(L, 1);
+
+  lua_getfield(L, -1, "direction");
+  if (lua_istable(L, -1))
+  {
+    json direction = json::array();
+    for (int index = 1; index <= 3; ++index)
+    {
+      lua_rawgeti(L, -1, index);
+      direction.push_back(static_cast<int>(lua_tointeger(L, -1)));
+      lua_pop(L, 1);
+    }
+    action["direction"] = direction;
+  }
+  lua_pop(L, 1);
+
+  lua_getfield(L, -1, "objects");
+  if (lua_istable(L, -1))
+  {
+    json objects = json::array();
+    int count = static_cast<int>(lua_objlen(L, -1));
+    for (int index = 1; index <= count; ++index)
+    {
+      lua_rawgeti(L, -1, index);
+      objects.push_back(EntityId(lua_tointeger(L, -1)));
+      lua_pop(L, 1);
+    }
+    action["objects"] = objects;
+  }
+  lua_pop(L, 1);
+
+  return action;
+}
+
+LuaMemory& Lua::memory()
+{
+  return *m_memory;
+}
+
+void Lua::collectGarbage(std::chrono::microseconds budget)
+{
+  auto& settings = Config::settings();
+  if (!settings.get("lua-gc-between-cycles").get<bool>()) return;
+
+  // Between cycles, Lua's automatic collector is left armed as a backstop,
+  // for when this isn't called for a while (e.g. during a long script). The
+  // step that finishes a cycle arms it at this percentage of what is left.
+  lua_gc(L_, LUA_GCSETPAUSE, settings.get("lua-gc-backstop-pause").get<int>());
+
+  // Steps have to keep pace with allocation, or a cycle would never end.
+  int inUse = lua_gc(L_, LUA_GCCOUNT, 0);
+  int stepSize = std::max(settings.get("lua-gc-step-kb").get<int>(), inUse - m_collectLastInUse);
+  m_collectLastInUse = inUse;
+
+  if (!m_collecting && (inUse < m_collectThreshold)) return;
+
+  // Take over from the automatic collector for the rest of the cycle.
+  lua_gc(L_, LUA_GCSTOP, 0);
+  m_collecting = true;
+
+  auto& collector = m_memory->collector();
+  auto startTime = std::chrono::steady_clock::now();
+  auto endTime = startTime + budget;
+
+  do
+  {
+    ++collector.steps;
+    if (lua_gc(L_, LUA_GCSTEP, stepSize) != 0)
+    {
+      ++collector.cycles;
+      m_collecting = false;
+      m_collectThreshold = (lua_gc(L_, LUA_GCCOUNT, 0) * settings.get("lua-gc-pause").get<int>()) / 100;
+    }
+  } while (m_collecting && (std::chrono::steady_clock::now() < endTime));
+
+  // Stepping restarts the automatic collector, so stop it again if the
+  // cycle isn't over.
+  if (m_collecting) lua_gc(L_, LUA_GCSTOP, 0);
+  m_collectLastInUse = lua_gc(L_, LUA_GCCOUNT, 0);
+  collector.time += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+}
+
 lua_State* Lua::state()
 {
   return L_;
@@ -1,6 +1,9 @@
 #pragma once
 // Lua enum binding modified from code Copyright (c) 2010 Tom Distler.
 
+#include "entity/EntityId.h"
+#include "lua/LuaMemory.h"
+
 // Forward declarations
 namespace Actions
 {
@@ -8,7 +11,6 @@ namespace Actions
 }
 class Color;
 class Direction;
-class EntityId;
 class Property;
 
 /// This class encapsulates the Lua state and interface as an object.
@@ -220,6 +222,7 @@ public:
   int push_value(double value);
   int push_value(bool value);
   int push_value(std::string value);
+  int push_value(Atom value);
   int push_value(UintVec2 value);
   int push_value(IntVec2 value);
   int push_value(RealVec2 value);
@@ -240,14 +243,65 @@ public:
   /// Return the number of Lua stack slots associated with a particular value.
   unsigned int stack_slots(Type type) const;
 
+  /// Read a value from the Lua stack without popping it, the counterpart of
+  /// the typed `push_value` overloads.
+  ///
+  /// @param    index       Stack index of the value's first slot.
+  /// @param    available   Number of slots available from `index` upwards.
+  /// @param    value       Set to the value read.
+  /// @return               True if there were enough slots to read it.
+  bool read_value(int index, int available, bool& value) const;
+  bool read_value(int index, int available, int& value) const;
+  bool read_value(int index, int available, unsigned int& value) const;
+  bool read_value(int index, int available, EntityId& value) const;
+  bool read_value(int index, int available, float& value) const;
+  bool read_value(int index, int available, double& value) const;
+  bool read_value(int index, int available, std::string& value) const;
+  bool read_value(int index, int available, UintVec2& value) const;
+  bool read_value(int index, int available, IntVec2& value) const;
+  bool read_value(int index, int available, RealVec2& value) const;
+  bool read_value(int index, int available, Direction& value) const;
+  bool read_value(int index, int available, Color& value) const;
+
   /// Given an entity type and a suffix, look for a Lua function name equal to
   /// "EntityType_suffix". If it doesn't exist, search the entity's templates
   /// and repeat. Do so until a matching name is found.
+  /// The result is cached; see `resolve_lua_function`.
   /// @param type     Entity type to look for
   /// @param suffix   Suffix of the function to call
   /// @return A matching function name, or a blank string if none was found.
   std::string find_lua_function(std::string type, std::string suffix) const;
 
+  /// Get whether an entity's category, or one of its templates, defines a
+  /// function with a particular suffix.
+  /// Call sites use this to skip building the arguments for, and calling,
+  /// handlers that don't exist; when it returns false, the call is counted
+  /// as elided. The answer is cached, so this is cheap.
+  bool hasEntityFunction(EntityId entity, Atom suffix);
+
+  /// Numbers of calls to entity functions with a particular suffix.
+  struct CallCounts
+  {
+    /// Calls that ran a Lua function.
+    uint64_t made = 0;
+
+    /// Calls skipped because there was no function to run.
+    uint64_t elided = 0;
+  };
+
+  /// Get the numbers of calls to entity functions, by suffix.
+  std::unordered_map<Atom, CallCounts> const& callCounts() const;
+
+  /// Write the numbers of calls to entity functions to the log.
+  void logCallCounts() const;
+
+  /// Forget every function found by `find_lua_function`. Called whenever a
+  /// script is loaded or a function registered, since either may define
+  /// new functions or replace old ones. A script that redefines entity
+  /// functions on the fly must call this too; scripts can do so through
+  /// the `clear_function_cache()` Lua function.
+  void clear_function_cache();
+
   /// Try to call a Lua function that takes the caller and a vector of
   /// arguments and returns a result.
   ///
@@ -262,11 +316,109 @@ public:
   ///                       after traversing the entire parent tree.
   ///
   /// @return The result of the call.
-  json callEntityFunction(std::string function_name,
+  json callEntityFunction(Atom function_name,
                            EntityId caller,
                            json const& args,
                            json default_result);
 
+  /// Call a Lua entity function with typed arguments and a typed result.
+  /// The function is found the same way as for `callEntityFunction`, but
+  /// the arguments are pushed with the typed `push_value` overloads and the
+  /// result is read straight off the stack with `read_value`, so nothing is
+  /// converted to or from JSON. The LuaType the function returns after its
+  /// result is not needed, and is ignored.
+  ///
+  /// @param function_name  Name of the function to call
+  /// @param caller         EntityId of the entity calling the function
+  /// @param default_result The result if the function is not found, fails,
+  ///                       or doesn't return enough values.
+  /// @param args           Arguments to pass to the function
+  ///
+  /// @return The result of the call.
+  template <typename R, typename... Args>
+  R call(Atom function_name, EntityId caller, R default_result, Args const&... args)
+  {
+    LuaMemory::Scope scope(*m_memory, LuaMemory::Phase::Callbacks);
+    int start_stack = lua_gettop(L_);
+
+    // Push the function and the caller's ID onto the stack. (+2)
+    auto function = push_entity_function(function_name, caller);
+    if (!function.exists()) return default_result;
+
+    // Push the arguments onto the stack. (+N)
+    int lua_args = 1;
+    int pushed[] = { 0, (lua_args += push_value(args))... };
+    (void)pushed;
+
+    R result = default_result;
+    if (pcall_entity_function(function, lua_args))
+    {
+      int results = lua_gettop(L_) - start_stack;
+      if (!read_value(start_stack + 1, results, result)) result = default_result;
+    }
+
+    // Pop the results off the stack. (-R)
+    lua_settop(L_, start_stack);
+    return result;
+  }
+
+  /// Call a Lua function on a batch of entities of the same category in one
+  /// go, instead of once per entity.
+  ///
+  /// Looks for "Category_suffix_batch" up the category's family tree. If it
+  /// exists, it is called once with an array of the entities' IDs, and
+  /// returns an array with an entry for each entity: nil or a boolean if the
+  /// entity has nothing more to do, or a table describing an action to queue
+  /// for it, with the fields:
+  ///   * `action`    - Type of the action
+  ///   * `target`    - ID of the entity to target (optional)
+  ///   * `direction` - Direction to target, as `{ x, y, z }` (optional)
+  ///   * `objects`   - Array of the IDs of the objects (optional)
+  ///
+  /// Otherwise "Category_suffix" is looked up once and called for each
+  /// entity in turn, and its results are ignored.
+  ///
+  /// @param function_name  Suffix of the function to call
+  /// @param category       Category shared by all of the entities
+  /// @param entities       Entities to pass to the function
+  ///
+  /// @return An entry for each entity, in the same order: null if there is
+  ///         nothing to queue, or an object with the fields above.
+  std::vector<json> callEntityBatchFunction(Atom function_name,
+                                            Atom category,
+                                            std::vector<EntityId> const& entities);
+
+  /// Run or resume a Lua coroutine for each of a batch of entities of the
+  /// same category.
+  ///
+  /// Looks for "Category_suffix_coroutine" up the category's family tree. If
+  /// it exists, each entity gets a coroutine running it, which is passed the
+  /// entity's ID. Each time it yields an action table (in the same form as
+  /// `callEntityBatchFunction` returns), the action is returned for the
+  /// entity, and the coroutine is resumed from that point the next time
+  /// this is called for the entity. Yielding nil does nothing for a turn.
+  /// Once the function returns or raises an error, its coroutine is thrown
+  /// away and the next call starts it over.
+  ///
+  /// Coroutines live only as long as this object, so they are not saved
+  /// with the game; scripts should be able to start over from scratch.
+  ///
+  /// @param function_name  Suffix of the function to run
+  /// @param category       Category shared by all of the entities
+  /// @param entities       Entities to run the coroutines of
+  /// @param results        Filled with an entry for each entity, as for
+  ///                       `callEntityBatchFunction`.
+  ///
+  /// @return True if the function exists; if not, nothing is done.
+  bool resumeEntityCoroutines(Atom function_name,
+                              Atom category,
+                              std::vector<EntityId> const& entities,
+                              std::vector<json>& results);
+
+  /// Throw away an entity's coroutine, if it has one. Must be called when
+  /// the entity is destroyed.
+  void releaseEntityCoroutine(EntityId entity);
+
   /// Call Lua function associated with a reflexive action.
   ///
   /// @param subject  The subject of the action.
@@ -316,6 +468,27 @@ public:
                               EntityId responsible_id,
                               std::string suffix = "");
 
+  /// Get the allocator and memory statistics of the Lua state.
+  LuaMemory& memory();
+
+  /// Run the garbage collector between game cycles.
+  ///
+  /// If the "lua-gc-between-cycles" setting is on, this takes over from
+  /// Lua's automatic collector, so it never runs in the middle of a cycle.
+  /// Each call runs incremental steps of "lua-gc-step-kb", or of however
+  /// much has been allocated since the last call if that is more, until the
+  /// time budget runs out or a collection cycle finishes, and holds whatever
+  /// is left of the cycle over to the next call. A new cycle is only started
+  /// once memory use reaches "lua-gc-pause" percent of what was left after
+  /// the last one.
+  ///
+  /// The automatic collector is only stopped while a cycle is in progress.
+  /// Between cycles it is left armed at "lua-gc-backstop-pause" percent, so
+  /// memory can't grow without bound if this isn't called for a while.
+  ///
+  /// @param budget   Time to spend; zero runs a single step.
+  void collectGarbage(std::chrono::microseconds budget = std::chrono::microseconds(0));
+
   /// Return the Lua state.
   /// @todo For cleanliness, this should not be exposed; all Lua interaction
   ///       should go through the Lua class.
@@ -332,13 +505,91 @@ public:
   void addLuaTypeEnumToLua();
 
 protected:
+  /// A Lua function found by `resolve_lua_function`.
+  struct ResolvedFunction
+  {
+    /// Registry reference to the function, or LUA_NOREF if none was found.
+    int reference = LUA_NOREF;
+
+    /// Full name of the function.
+    Atom name;
+
+    bool exists() const
+    {
+      return reference != LUA_NOREF;
+    }
+  };
+
+  /// Find a function the way `find_lua_function` does, caching the result
+  /// (found or not) by category and suffix. The cache holds a registry
+  /// reference to the function, so calling it needs no lookup by name.
+  ResolvedFunction resolve_lua_function(Atom category, Atom suffix) const;
+
+  /// Get the atom for two names joined together (e.g. "do_" and an action
+  /// type), building and interning it only the first time it is asked for.
+  Atom joined_name(Atom first, Atom second) const;
+
+  /// Helper method for `call`. Find an entity's function and push it and the
+  /// entity's ID onto the stack, counting the call as made or elided.
+  /// @return The function; nothing is pushed if it doesn't exist.
+  ResolvedFunction push_entity_function(Atom function_name, EntityId caller);
+
+  /// Helper method for `call`. Call the function pushed by
+  /// `push_entity_function`, leaving all of its results on the stack.
+  /// @return True if the call succeeded; if not, the error is logged and
+  ///         nothing is left on the stack.
+  bool pcall_entity_function(ResolvedFunction const& function, int args);
+
   /// Helper method for `find_lua_function`.
   std::string find_lua_function_(std::string category, std::string suffix) const;
 
+  /// Helper method for `callEntityBatchFunction` and
+  /// `resumeEntityCoroutines`. Reads the action table at the top of a Lua
+  /// stack, if there is one.
+  json read_batch_action(lua_State* L);
+
   /// Helper method to set a Lua path.
   void addToLuaPath(std::string path);
 
 private:
+  /// A suspended entity coroutine.
+  struct Coroutine
+  {
+    /// Registry reference keeping the thread alive.
+    int reference;
+
+    /// The thread itself.
+    lua_State* thread;
+  };
+
+  /// Allocator and memory statistics of the Lua state. Declared before the
+  /// state, since it has to outlive it.
+  std::unique_ptr<LuaMemory> m_memory;
+
   /// Private Lua state.
   lua_State mutable* L_;
+
+  /// Whether a garbage collection cycle started by `collectGarbage` is
+  /// still in progress.
+  bool m_collecting = false;
+
+  /// Memory use, in kilobytes, at which `collectGarbage` will start the
+  /// next collection cycle.
+  int m_collectThreshold = 0;
+
+  /// Memory use, in kilobytes, when `collectGarbage` last returned.
+  int m_collectLastInUse = 0;
+
+  /// Suspended coroutines, by the entity they belong to.
+  std::unordered_map<EntityId, Coroutine> m_coroutines;
+
+  /// Functions found by `resolve_lua_function`, keyed by the values of the
+  /// category and suffix atoms.
+  std::unordered_map<uint64_t, ResolvedFunction> mutable m_functionCache;
+
+  /// Names built by `joined_name`, keyed by the values of the two atoms.
+  std::unordered_map<uint64_t, Atom> mutable m_joinedNames;
+
+  /// Numbers of calls to entity functions, by suffix.
+  std::unordered_map<Atom, CallCounts> m_callCounts;
 };
@@ -19,7 +19,12 @@ int LUA_getValue(lua_State* L, std::function<ReturnType(EntityId)> getValue)
   EntityId entity = EntityId(lua_tointeger(L, 1));
 
   ReturnType result = getValue(entity);
-  auto slot_count = GameState::instance().lua().push_value(result);
+  auto& lua = GameState::instance().lua();
+  auto slot_count = lua.push_value(result);
+
+  // The value is pushed onto the main thread; move it over if we were called
+  // from a coroutine.
+  lua_xmove(lua.state(), L, slot_count);
   return slot_count;
 }
 
@@ -38,7 +43,12 @@ int LUA_getValueOfString(lua_State* L, std::function<ReturnType(EntityId, std::s
   std::string str = lua_tostring(L, 2);
 
   ReturnType result = getValue(entity, str);
-  auto slot_count = GameState::instance().lua().push_value(result);
+  auto& lua = GameState::instance().lua();
+  auto slot_count = lua.push_value(result);
+
+  // The value is pushed onto the main thread; move it over if we were called
+  // from a coroutine.
+  lua_xmove(lua.state(), L, slot_count);
   return slot_count;
 }
 
@@ -0,0 +1,238 @@
+#include "stdafx.h"
+
+#include "map/DijkstraMap.h"
+
+#include "map/Map.h"
+#include "maptile/MapTile.h"
+
+namespace
+{
+  /// Cost of a straight move; matches MapPathfinder.
+  int const StraightCost = 10;
+
+  /// Cost of a diagonal move; matches MapPathfinder.
+  int const DiagonalCost = 14;
+
+  IntVec2 const AllDirections[] =
+  {
+    { 0, -1 }, { 1, -1 }, { 1, 0 }, { 1, 1 },
+    { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }
+  };
+}
+
+int const DijkstraMap::Unreachable = std::numeric_limits<int>::max();
+
+DijkstraMap::DijkstraMap(Map const& map, float fleeCoefficient)
+  :
+  m_map{ map },
+  m_fleeCoefficient{ fleeCoefficient }
+{}
+
+DijkstraMap::~DijkstraMap()
+{}
+
+void DijkstraMap::setGoals(std::vector<IntVec2> goals)
+{
+  if (goals == m_goals) return;
+
+  m_goals = std::move(goals);
+  m_dirty = true;
+}
+
+std::vector<IntVec2> const& DijkstraMap::goals() const
+{
+  return m_goals;
+}
+
+bool DijkstraMap::update()
+{
+  unsigned int version = m_map.getPassabilityVersion();
+  if (!m_dirty && (m_generation > 0) && (version == m_passabilityVersion)) return false;
+
+  if ((m_generation == 0) || (version != m_passabilityVersion))
+  {
+    readPassability();
+  }
+
+  IntVec2 const& size = m_map.getSize();
+  m_chase.distance.assign(static_cast<size_t>(size.x) * size.y, Unreachable);
+  for (auto& goal : m_goals)
+  {
+    size_t index;
+    if (lookup(goal, index) && m_passable[index]) m_chase.distance[index] = 0;
+  }
+
+  propagate(m_chase);
+
+  m_dirty = false;
+  m_passabilityVersion = version;
+  ++m_generation;
+  return true;
+}
+
+unsigned int DijkstraMap::generation() const
+{
+  return m_generation;
+}
+
+int DijkstraMap::distance(IntVec2 coords)
+{
+  update();
+
+  size_t index;
+  return lookup(coords, index) ? m_chase.distance[index] : Unreachable;
+}
+
+bool DijkstraMap::nextStep(IntVec2 from, IntVec2& step)
+{
+  update();
+
+  size_t index;
+  if (!lookup(from, index) || (m_chase.next[index] < 0)) return false;
+
+  step = AllDirections[m_chase.next[index]];
+  return true;
+}
+
+int DijkstraMap::fleeDistance(IntVec2 coords)
+{
+  updateFlee();
+
+  size_t index;
+  return lookup(coords, index) ? m_flee.distance[index] : Unreachable;
+}
+
+bool DijkstraMap::fleeStep(IntVec2 from, IntVec2& step)
+{
+  updateFlee();
+
+  size_t index;
+  if (!lookup(from, index) || (m_flee.next[index] < 0)) return false;
+
+  step = AllDirections[m_flee.next[index]];
+  return true;
+}
+
+void DijkstraMap::readPassability()
+{
+  IntVec2 const& size = m_map.getSize();
+  m_passable.resize(static_cast<size_t>(size.x) * size.y);
+
+  for (int y = 0; y < size.y; ++y)
+  {
+    for (int x = 0; x < size.x; ++x)
+    {
+      m_passable[(static_cast<size_t>(y) * size.x) + x] = m_map.getTile({ x, y }).isPassable() ? 1 : 0;
+    }
+  }
+}
+
+void DijkstraMap::propagate(Field& field)
+{
+  IntVec2 const& size = m_map.getSize();
+  using Entry = std::pair<int, int>;
+  std::vector<Entry> open;
+
+  for (size_t index = 0; index < field.distance.size(); ++index)
+  {
+    if (field.distance[index] != Unreachable)
+    {
+      open.emplace_back(field.distance[index], static_cast<int>(index));
+    }
+  }
+  std::make_heap(open.begin(), open.end(), std::greater<Entry>());
+
+  while (!open.empty())
+  {
+    std::pop_heap(open.begin(), open.end(), std::greater<Entry>());
+    Entry current = open.back();
+    open.pop_back();
+
+    // Skip entries that were improved on after being pushed.
+    if (current.first != field.distance[current.second]) continue;
+
+    int x = current.second % size.x;
+    int y = current.second / size.x;
+
+    for (auto& direction : AllDirections)
+    {
+      if (!canStep(x, y, direction.x, direction.y)) continue;
+
+      int stepCost = ((direction.x != 0) && (direction.y != 0)) ? DiagonalCost : StraightCost;
+      int neighbor = ((y + direction.y) * size.x) + (x + direction.x);
+      int cost = current.first + stepCost;
+      if (cost < field.distance[neighbor])
+      {
+        field.distance[neighbor] = cost;
+        open.emplace_back(cost, neighbor);
+        std::push_heap(open.begin(), open.end(), std::greater<Entry>());
+      }
+    }
+  }
+
+  // Work out the best step from each tile: the neighbor with the lowest
+  // value, if it is lower than the tile's own.
+  field.next.assign(field.distance.size(), -1);
+  for (int y = 0; y < size.y; ++y)
+  {
+    for (int x = 0; x < size.x; ++x)
+    {
+      size_t index = (static_cast<size_t>(y) * size.x) + x;
+      int best = field.distance[index];
+      if (best == Unreachable) continue;
+
+      for (int direction = 0; direction < 8; ++direction)
+      {
+        IntVec2 const& offset = AllDirections[direction];
+        if (!canStep(x, y, offset.x, offset.y)) continue;
+
+        int value = field.distance[((y + offset.y) * size.x) + (x + offset.x)];
+        if (value < best)
+        {
+          best = value;
+          field.next[index] = static_cast<int8_t>(direction);
+        }
+      }
+    }
+  }
+}
+
+void DijkstraMap::updateFlee()
+{
+  update();
+  if (m_fleeGeneration == m_generation) return;
+
+  m_flee.distance.resize(m_chase.distance.size());
+  for (size_t index = 0; index < m_chase.distance.size(); ++index)
+  {
+    int chase = m_chase.distance[index];
+    m_flee.distance[index] = (chase == Unreachable) ?
+      Unreachable : static_cast<int>(chase * m_fleeCoefficient);
+  }
+
+  propagate(m_flee);
+  m_fleeGeneration = m_generation;
+}
+
+bool DijkstraMap::canStep(int x, int y, int dx, int dy) const
+{
+  IntVec2 const& size = m_map.getSize();
+  auto passable = [&](int tx, int ty)
+  {
+    return (tx >= 0) && (ty >= 0) && (tx < size.x) && (ty < size.y) &&
+      (m_passable[(static_cast<size_t>(ty) * size.x) + tx] != 0);
+  };
+
+  if (!passable(x + dx, y + dy)) return false;
+
+  // Diagonal moves may not cut corners.
+  return (dx == 0) || (dy == 0) || (passable(x + dx, y) && passable(x, y + dy));
+}
+
+bool DijkstraMap::lookup(IntVec2 coords, size_t& index) const
+{
+  if (!m_map.isInBounds(coords) || m_chase.distance.empty()) return false;
+
+  index = (static_cast<size_t>(coords.y) * m_map.getSize().x) + coords.x;
+  return true;
+}
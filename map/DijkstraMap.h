@@ -0,0 +1,135 @@
+#pragma once
+
+#include <vector>
+
+#include "types/Vec2.h"
+
+// Forward declarations
+class Map;
+
+/// Distance field ("Dijkstra map") over the passable tiles of a map.
+/// Every tile holds the cost of the cheapest path from it to the nearest of a
+/// set of goals, using the same move costs as MapPathfinder (octile, no
+/// cutting corners). The best step from each tile is worked out at the same
+/// time, so any number of entities can ask which way to go in constant time,
+/// instead of each running its own search.
+///
+/// A field is only recalculated when its goals change or a tile on the map
+/// changes passability, and then only when next asked about.
+///
+/// Each field also has a "flee" field, for running away from the goals: the
+/// distances are scaled by a negative coefficient and then smoothed out the
+/// same way, so fleeing entities head for open space rather than cornering
+/// themselves.
+///
+/// The field is dense on purpose: it covers every tile reachable from the
+/// goals, which is usually most of the map. It is only allocated when first
+/// calculated, and the map only creates fields that are asked for by name.
+class DijkstraMap
+{
+public:
+  /// Distance of a tile that can't reach any goal.
+  static int const Unreachable;
+
+  /// Constructor.
+  /// @param map              Map the field covers.
+  /// @param fleeCoefficient  Amount the distances are scaled by to make the
+  ///                         flee field. Should be negative, and a little
+  ///                         further from zero than -1.
+  DijkstraMap(Map const& map, float fleeCoefficient);
+
+  ~DijkstraMap();
+
+  /// Set the goals. Nothing is recalculated if they are the same as before.
+  void setGoals(std::vector<IntVec2> goals);
+
+  /// Get the goals.
+  std::vector<IntVec2> const& goals() const;
+
+  /// Recalculate the field if its goals or the map's passability have
+  /// changed since it was last calculated.
+  /// @return True if the field was recalculated.
+  bool update();
+
+  /// Get the number of times the field has been calculated.
+  unsigned int generation() const;
+
+  /// Get the distance from a tile to the nearest goal, in the units used by
+  /// MapPathfinder (10 per straight step).
+  /// @return The distance, or Unreachable.
+  int distance(IntVec2 coords);
+
+  /// Get the best step to take from a tile towards the nearest goal.
+  /// @param from   Tile to step from.
+  /// @param step   Set to the offset of the tile to step onto.
+  /// @return True if there is a step to take; false if the tile is a goal,
+  ///         can't reach one, or is out of bounds.
+  bool nextStep(IntVec2 from, IntVec2& step);
+
+  /// Get the value of the flee field at a tile. Lower is safer.
+  /// @return The value, or Unreachable.
+  int fleeDistance(IntVec2 coords);
+
+  /// Get the best step to take from a tile away from the goals.
+  /// @param from   Tile to step from.
+  /// @param step   Set to the offset of the tile to step onto.
+  /// @return True if there is a step to take; false if there is nowhere
+  ///         safer to go.
+  bool fleeStep(IntVec2 from, IntVec2& step);
+
+protected:
+  /// Distances and best steps for each tile.
+  struct Field
+  {
+    std::vector<int> distance;
+    std::vector<int8_t> next;
+  };
+
+  /// Copy the passability of every tile from the map.
+  void readPassability();
+
+  /// Spread a field out from the tiles already holding a distance, so each
+  /// tile ends up with the lowest of its own value and its neighbors' values
+  /// plus the cost of stepping to them. Then work out the best steps.
+  void propagate(Field& field);
+
+  /// Make sure the flee field is up to date.
+  void updateFlee();
+
+  /// Get whether a move from a tile in a direction is allowed.
+  bool canStep(int x, int y, int dx, int dy) const;
+
+  /// Look up a tile in a field; true if the tile is in bounds.
+  bool lookup(IntVec2 coords, size_t& index) const;
+
+private:
+  /// Map the field covers.
+  Map const& m_map;
+
+  /// Amount distances are scaled by to make the flee field.
+  float m_fleeCoefficient;
+
+  /// Goals of the field.
+  std::vector<IntVec2> m_goals;
+
+  /// Whether the goals have changed since the field was calculated.
+  bool m_dirty = true;
+
+  /// Passability version of the map when the field was calculated.
+  unsigned int m_passabilityVersion = 0;
+
+  /// Number of times the field has been calculated.
+  unsigned int m_generation = 0;
+
+  /// Generation the flee field was calculated from, or 0 if it never was.
+  unsigned int m_fleeGeneration = 0;
+
+  /// Passability of each tile, as of the last calculation.
+  std::vector<uint8_t> m_passable;
+
+  /// Distances to the goals.
+  Field m_chase;
+
+  /// Flee field.
+  Field m_flee;
+};
@@ -5,23 +5,41 @@
 #include "AssertHelper.h"
 #include "components/ComponentInventory.h"
 #include "components/ComponentManager.h"
+#include "components/ComponentPhysical.h"
 #include "config/Bible.h"
 #include "config/Paths.h"
+#include "config/Settings.h"
 #include "game/App.h"
 #include "game/GameState.h"
 #include "entity/EntityFactory.h"
+#include "lua/LuaObject.h"
 #include "maptile/MapTile.h"
+#include "types/ChunkPager.h"
 #include "types/Color.h"
 #include "types/LightInfluence.h"
 #include "types/ShaderEffect.h"
 #include "utilities/MathUtils.h"
 #include "utilities/RNGUtils.h"
 
+#include "map/DijkstraMap.h"
 #include "map/MapFeature.h"
 #include "map/MapGenerator.h"
+#include "map/MapPathfinder.h"
+#include "map/MapRegionGraph.h"
 
 #define VERTEX(x, y) (20 * (m_size.x * y) + x)
-#define TILE(x, y) (m_tiles->get({ x, y }))
+
+namespace
+{
+  /// Get a new opacity version. Versions are drawn from one counter for all
+  /// maps, so a map recreated under an old map's ID can't repeat a version
+  /// that FOV and line-of-sight results were cached under.
+  unsigned int nextOpacityVersion()
+  {
+    static unsigned int s_lastOpacityVersion = 0;
+    return ++s_lastOpacityVersion;
+  }
+}
 
 /// @todo Have this take an IntVec2 instead of width x height
 Map::Map(GameState& gameState, MapID id, int width, int height)
@@ -30,18 +48,20 @@ Map::Map(GameState& gameState, MapID id, int width, int height)
   m_gameState{ gameState },
   m_id{ id },
   m_size{ width, height },
-  m_generator{ NEW MapGenerator(*this) }
+  m_generator{ NEW MapGenerator(*this) },
+  m_rng{ NEW RNG(RNG::named("map/" + id.str())) },
+  m_tiles{ IntVec2(width, height) },
+  m_opacityVersion{ nextOpacityVersion() }
 {
   CLOG(TRACE, "Map") << "Creating map of size " << width << " x " << height;
 
-  m_tiles.reset(NEW Grid2D<MapTile>({ width, height },
-                                    [&](IntVec2 coords) -> MapTile*
+  // Tiles are only created once something touches their chunk.
+  m_tileChunkLastUsed.resize(m_tiles.chunkCount().x * m_tiles.chunkCount().y);
+  m_tiles.setChunkInitializer([this](IntVec2 chunkCoords, TileGrid::Chunk& chunk)
   {
-    MapTile* new_tile = NEW MapTile(coords, id,
-                                    gameState.entities(),
-                                    gameState.components());
-    return new_tile;
-  }));
+    createTileChunk(chunkCoords, chunk);
+  });
+  setDefaultTileType(EntitySpecs(Atom("OpenSpace")), EntitySpecs(Atom("Pit")));
 
   CLOG(TRACE, "Map") << "Map created.";
 
@@ -50,11 +70,26 @@ Map::Map(GameState& gameState, MapID id, int width, int height)
 
 void Map::initialize()
 {
+  auto startTime = std::chrono::steady_clock::now();
+  auto elapsed = [&]
+  {
+    auto now = std::chrono::steady_clock::now();
+    auto result = std::chrono::duration_cast<std::chrono::microseconds>(now - startTime);
+    startTime = now;
+    return result;
+  };
+
   // If the map isn't the 1x1 "limbo" map...
   if ((m_size.x != 1) && (m_size.y != 1))
   {
     // Generate the map.
-    m_generator->generate();
+    m_generator->begin();
+    m_generationStats.setup += elapsed();
+    while (!m_generator->step()) {}
+
+    // Feature placement is done counting passable tiles.
+    releasePassableTileIndex();
+    m_generationStats.features += elapsed();
 
     // Run Lua script associated with this map.
     /// @todo Different scripts for different maps.
@@ -62,8 +97,11 @@ void Map::initialize()
     ///       should be done via scripting. But for now
     ///       this will do.
     CLOG(TRACE, "Map") << "Executing Map Lua script.";
-    m_gameState.lua().set_global("current_map_id", m_id);
-    m_gameState.lua().require(Config::paths().resources() + "/script/map");
+    auto& lua = m_gameState.lua();
+    LuaMemory::Scope scope(lua.memory(), LuaMemory::Phase::MapScript);
+    lua.set_global("current_map_id", m_id);
+    lua.require(Config::paths().resources() + "/script/map");
+    m_generationStats.script += elapsed();
   }
 
   CLOG(TRACE, "Map") << "Map initialized.";
@@ -76,6 +114,49 @@ Map::~Map()
   //dtor
 }
 
+void Map::destroyTileEntities()
+{
+  auto& entities = m_gameState.entities();
+  auto& inventory = m_gameState.components().inventory;
+
+  std::function<void(EntityId)> destroyWithContents = [&](EntityId entity)
+  {
+    if (entity == EntityId::Void) return;
+    if (inventory.existsFor(entity))
+    {
+      // Copy the contents, as destroying them changes the inventory.
+      std::vector<EntityId> contents;
+      for (auto& pair : inventory.of(entity)) contents.push_back(pair.second);
+      for (auto child : contents) destroyWithContents(child);
+    }
+    entities.destroy(entity);
+  };
+
+  // Paged-out chunks still have entities, so bring them back first.
+  for (int cy = 0; cy < m_tiles.chunkCount().y; ++cy)
+  {
+    for (int cx = 0; cx < m_tiles.chunkCount().x; ++cx)
+    {
+      if (m_tiles.isChunkEvicted({ cx, cy }))
+      {
+        tileData({ cx * TileGrid::chunkSide, cy * TileGrid::chunkSide });
+      }
+    }
+  }
+
+  size_t count = 0;
+  m_tiles.forEachAllocated([&](IntVec2 coords, TileData& data)
+  {
+    destroyWithContents(data.space);
+    destroyWithContents(data.floor);
+    data.space = EntityId::Void;
+    data.floor = EntityId::Void;
+    count += 2;
+  });
+
+  CLOG(TRACE, "Map") << "Destroyed " << count << " tile entities of map " << m_id;
+}
+
 int Map::getIndex(IntVec2 coords) const
 {
   return (coords.y * m_size.x) + coords.x;
@@ -101,6 +182,16 @@ MapID Map::getMapID() const
   return m_id;
 }
 
+Map::GenerationStats const& Map::getGenerationStats() const
+{
+  return m_generationStats;
+}
+
+RNG& Map::rng()
+{
+  return *m_rng;
+}
+
 IntVec2 const& Map::getSize() const
 {
   return m_size;
@@ -121,24 +212,23 @@ bool Map::setStartCoords(IntVec2 start_coords)
   return false;
 }
 
-MapTile const& Map::getTile(IntVec2 tile) const
+MapTile const Map::getTile(IntVec2 tile) const
 {
-  if (tile.x < 0) tile.x = 0;
-  if (tile.x >= m_size.x) tile.x = m_size.x - 1;
-  if (tile.y < 0) tile.y = 0;
-  if (tile.y >= m_size.y) tile.y = m_size.y - 1;
+  return MapTile(*this, clampToBounds(tile));
+}
 
-  return TILE(tile.x, tile.y);
+MapTile Map::getTile(IntVec2 tile)
+{
+  return MapTile(*this, clampToBounds(tile));
 }
 
-MapTile& Map::getTile(IntVec2 tile)
+IntVec2 Map::clampToBounds(IntVec2 tile) const
 {
   if (tile.x < 0) tile.x = 0;
   if (tile.x >= m_size.x) tile.x = m_size.x - 1;
   if (tile.y < 0) tile.y = 0;
   if (tile.y >= m_size.y) tile.y = m_size.y - 1;
-
-  return TILE(tile.x, tile.y);
+  return tile;
 }
 
 bool Map::tileIsOpaque(IntVec2 tile) const
@@ -148,19 +238,457 @@ bool Map::tileIsOpaque(IntVec2 tile) const
     return true;
   }
 
-  return TILE(tile.x, tile.y).isTotallyOpaque();
+  return (m_tiles.get(tile).flags & TileFlags::Opaque) != 0;
+}
+
+int Map::countPassableTiles(IntVec2 upperLeft, IntVec2 lowerRight) const
+{
+  if (!m_passableTilesBuilt)
+  {
+    m_passableTiles = FenwickGrid2D<int>(m_size);
+    m_passableTiles.build([&](IntVec2 coords)
+    {
+      return ((peekTileData(coords).flags & TileFlags::Passable) != 0) ? 1 : 0;
+    });
+    m_passableTilesBuilt = true;
+  }
+
+  return m_passableTiles.sum(upperLeft, lowerRight);
+}
+
+unsigned int Map::getOpacityVersion() const
+{
+  return m_opacityVersion;
+}
+
+void Map::invalidateOpacity()
+{
+  m_opacityVersion = nextOpacityVersion();
+}
+
+unsigned int Map::getPassabilityVersion() const
+{
+  return m_passabilityVersion;
+}
+
+MapPathfinder& Map::pathfinder()
+{
+  if (!m_pathfinder)
+  {
+    m_pathfinder.reset(NEW MapPathfinder(*this, Config::settings().get("pathfinding-cache-size").get<size_t>()));
+  }
+  return *m_pathfinder;
+}
+
+DijkstraMap& Map::dijkstraMap(std::string const& name)
+{
+  auto& dijkstraMap = m_dijkstraMaps[name];
+  if (!dijkstraMap)
+  {
+    dijkstraMap.reset(NEW DijkstraMap(*this, Config::settings().get("dijkstra-flee-coefficient").get<float>()));
+  }
+  return *dijkstraMap;
+}
+
+MapRegionGraph& Map::regionGraph()
+{
+  if (!m_regionGraph)
+  {
+    m_regionGraph.reset(NEW MapRegionGraph(*this));
+  }
+  return *m_regionGraph;
+}
+
+namespace
+{
+  /// Get whether morphing an entity with the given specs into new specs
+  /// would leave it unchanged. A new material that is empty means "keep the
+  /// current material", as it does for EntityFactory::morph.
+  bool specsAlreadyMatch(EntitySpecsId current, EntitySpecs const& specs)
+  {
+    auto& currentSpecs = EntitySpecs::fromId(current);
+    return (currentSpecs.category == specs.category) &&
+      (specs.material.empty() || (currentSpecs.material == specs.material));
+  }
+}
+
+template <class Visitor>
+void Map::setTileTypes(Visitor forEachTile, EntitySpecs const& floor, EntitySpecs const& space)
+{
+  auto& entities = m_gameState.entities();
+  MapTile probe{ *this, { 0, 0 } };
+  bool spaceChanged = false;
+
+  // Spaces with the same specs have the same flags, so each set of specs
+  // only needs its flags working out once per batch.
+  std::unordered_map<EntitySpecsId, uint8_t> flagsBySpecs;
+
+  forEachTile([&](IntVec2 coords)
+  {
+    if (!isInBounds(coords)) return;
+    auto& data = tileData(coords);
+
+    if (!specsAlreadyMatch(data.floorSpecs, floor))
+    {
+      entities.morph(data.floor, floor);
+      data.floorSpecs = probe.specsOf(data.floor).id();
+    }
+
+    if (!specsAlreadyMatch(data.spaceSpecs, space))
+    {
+      entities.morph(data.space, space);
+      data.spaceSpecs = probe.specsOf(data.space).id();
+
+      auto iter = flagsBySpecs.find(data.spaceSpecs);
+      if (iter == flagsBySpecs.end())
+      {
+        iter = flagsBySpecs.emplace(data.spaceSpecs, calculateTileFlags(data.space)).first;
+      }
+      setTileFlags(coords, data, iter->second);
+      spaceChanged = true;
+    }
+  });
+
+  if (spaceChanged)
+  {
+    invalidateOpacity();
+  }
+}
+
+void Map::setDefaultTileType(EntitySpecs floor, EntitySpecs space)
+{
+  m_defaultFloor = floor;
+  m_defaultSpace = space;
+
+  // Untouched tiles have no entities, so work out their data from throwaway
+  // entities of the same types.
+  auto& entities = m_gameState.entities();
+  MapTile tile{ *this, { 0, 0 } };
+  EntityId floorProbe = entities.create(floor);
+  EntityId spaceProbe = entities.create(space);
+
+  TileData defaultData;
+  defaultData.floorSpecs = tile.specsOf(floorProbe).id();
+  defaultData.spaceSpecs = tile.specsOf(spaceProbe).id();
+  defaultData.flags = calculateTileFlags(spaceProbe);
+  entities.destroy(floorProbe);
+  entities.destroy(spaceProbe);
+
+  m_tiles.setDefaultValue(defaultData);
+
+  // Tiles that have been paged out need changing too, so bring them back.
+  for (int cy = 0; cy < m_tiles.chunkCount().y; ++cy)
+  {
+    for (int cx = 0; cx < m_tiles.chunkCount().x; ++cx)
+    {
+      if (m_tiles.isChunkEvicted({ cx, cy }))
+      {
+        tileData({ cx * TileGrid::chunkSide, cy * TileGrid::chunkSide });
+      }
+    }
+  }
+
+  setTileTypes([&](auto&& visit)
+  {
+    m_tiles.forEachAllocated([&](IntVec2 coords, TileData&) { visit(coords); });
+  }, floor, space);
+
+  // Untouched tiles have changed too, so the passability index starts over.
+  releasePassableTileIndex();
+  ++m_passabilityVersion;
+  if (m_regionGraph) m_regionGraph->invalidate();
+
+  invalidateOpacity();
+}
+
+void Map::fillTiles(IntVec2 upperLeft, IntVec2 lowerRight, EntitySpecs floor, EntitySpecs space)
+{
+  int left = std::max(upperLeft.x, 0);
+  int top = std::max(upperLeft.y, 0);
+  int right = std::min(lowerRight.x, m_size.x - 1);
+  int bottom = std::min(lowerRight.y, m_size.y - 1);
+
+  setTileTypes([&](auto&& visit)
+  {
+    for (int y = top; y <= bottom; ++y)
+    {
+      for (int x = left; x <= right; ++x)
+      {
+        visit(IntVec2{ x, y });
+      }
+    }
+  }, floor, space);
+}
+
+void Map::stampTiles(IntVec2 origin, Grid2D<uint8_t> const& mask, EntitySpecs floor, EntitySpecs space)
+{
+  setTileTypes([&](auto&& visit)
+  {
+    IntVec2 const& maskSize = mask.size();
+    for (int y = 0; y < maskSize.y; ++y)
+    {
+      for (int x = 0; x < maskSize.x; ++x)
+      {
+        if (mask[{ x, y }] != 0)
+        {
+          visit(IntVec2{ origin.x + x, origin.y + y });
+        }
+      }
+    }
+  }, floor, space);
+}
+
+void Map::carveTiles(std::vector<IntVec2> const& points, EntitySpecs floor, EntitySpecs space)
+{
+  setTileTypes([&](auto&& visit)
+  {
+    if (points.size() == 1)
+    {
+      visit(points[0]);
+    }
+
+    // Bresenham's line algorithm, for each segment in turn.
+    for (size_t index = 1; index < points.size(); ++index)
+    {
+      IntVec2 from = points[index - 1];
+      IntVec2 to = points[index];
+      int dx = std::abs(to.x - from.x);
+      int dy = -std::abs(to.y - from.y);
+      int stepX = (from.x < to.x) ? 1 : -1;
+      int stepY = (from.y < to.y) ? 1 : -1;
+      int error = dx + dy;
+
+      while (true)
+      {
+        visit(from);
+        if (from == to) break;
+        int error2 = 2 * error;
+        if (error2 >= dy)
+        {
+          error += dy;
+          from.x += stepX;
+        }
+        if (error2 <= dx)
+        {
+          error += dx;
+          from.y += stepY;
+        }
+      }
+    }
+  }, floor, space);
+}
+
+bool Map::isTileChunkCreated(IntVec2 tile) const
+{
+  if (!isInBounds(tile)) return false;
+  IntVec2 chunkCoords = TileGrid::chunkCoordsOf(tile);
+  return m_tiles.isChunkAllocated(chunkCoords) || m_tiles.isChunkEvicted(chunkCoords);
+}
+
+size_t Map::getCreatedTileChunkCount() const
+{
+  return m_tiles.allocatedChunkCount();
+}
+
+size_t Map::getResidentTileBytes() const
+{
+  return m_tiles.storageBytes();
+}
+
+size_t Map::pageOutColdTileChunks(std::vector<IntVec2> const& activeTiles, int keepRadius, size_t budgetBytes)
+{
+  IntVec2 const& chunkCount = m_tiles.chunkCount();
+  ++m_tileUseClock;
+
+  // Everything near an actor counts as in use right now.
+  for (auto& tile : activeTiles)
+  {
+    if (!isInBounds(tile)) continue;
+    IntVec2 first = TileGrid::chunkCoordsOf(clampToBounds({ tile.x - keepRadius, tile.y - keepRadius }));
+    IntVec2 last = TileGrid::chunkCoordsOf(clampToBounds({ tile.x + keepRadius, tile.y + keepRadius }));
+    for (int cy = first.y; cy <= last.y; ++cy)
+    {
+      for (int cx = first.x; cx <= last.x; ++cx)
+      {
+        m_tileChunkLastUsed[m_tiles.chunkIndexOf({ cx, cy })] = m_tileUseClock;
+      }
+    }
+  }
+
+  size_t residentBytes = m_tiles.storageBytes();
+  if (residentBytes <= budgetBytes) return 0;
+
+  // Page out the least recently used chunks until the budget is met.
+  struct Candidate
+  {
+    uint32_t lastUsed;
+    IntVec2 chunkCoords;
+    TileGrid::Chunk const* chunk;
+  };
+
+  std::vector<Candidate> candidates;
+  m_tiles.forEachAllocatedChunk([&](IntVec2 chunkCoords, TileGrid::Chunk& chunk)
+  {
+    uint32_t lastUsed = m_tileChunkLastUsed[m_tiles.chunkIndexOf(chunkCoords)];
+    if (lastUsed != m_tileUseClock) candidates.push_back({ lastUsed, chunkCoords, &chunk });
+  });
+
+  std::sort(candidates.begin(), candidates.end(), [](Candidate const& a, Candidate const& b)
+  {
+    return a.lastUsed < b.lastUsed;
+  });
+
+  if (!m_tilePager && !candidates.empty())
+  {
+    static_assert(std::is_trivially_copyable<TileData>::value, "TileData must be plain data to be paged out");
+    m_tilePager.reset(NEW ChunkPager("map-" + m_id.str(), chunkCount.x * chunkCount.y, sizeof(TileGrid::Chunk)));
+  }
+
+  size_t pagedOut = 0;
+  for (auto& candidate : candidates)
+  {
+    if (residentBytes <= budgetBytes) break;
+    m_tilePager->store(m_tiles.chunkIndexOf(candidate.chunkCoords), candidate.chunk->data());
+    m_tiles.evictChunk(candidate.chunkCoords);
+    residentBytes -= sizeof(TileGrid::Chunk);
+    ++pagedOut;
+  }
+
+  CLOG(DEBUG, "Map") << "Paged out " << pagedOut << " tile chunks of map " << m_id << "; " <<
+    m_tiles.allocatedChunkCount() << " chunks (" << residentBytes << " bytes) still resident";
+
+  return pagedOut;
+}
+
+Map::TileData& Map::tileData(IntVec2 tile)
+{
+  auto& data = m_tiles[tile];
+  m_tileChunkLastUsed[m_tiles.chunkIndexOf(TileGrid::chunkCoordsOf(tile))] = m_tileUseClock;
+  return data;
+}
+
+Map::TileData const& Map::peekTileData(IntVec2 tile) const
+{
+  return m_tiles.get(tile);
+}
+
+void Map::createTileChunk(IntVec2 chunkCoords, TileGrid::Chunk& chunk)
+{
+  size_t index = m_tiles.chunkIndexOf(chunkCoords);
+  m_tileChunkLastUsed[index] = m_tileUseClock;
+
+  // A chunk that was paged out comes back from disk; its entities still
+  // exist, so if it can't be read back, making new ones won't fix it.
+  if (m_tilePager && m_tilePager->contains(index))
+  {
+    if (!m_tilePager->load(index, chunk.data()))
+    {
+      CLOG(FATAL, "Map") << "Could not page in tile chunk " << chunkCoords << " of map " << m_id;
+    }
+    CLOG(TRACE, "Map") << "Paged in tile chunk " << chunkCoords << " of map " << m_id;
+    return;
+  }
+
+  auto startTime = std::chrono::steady_clock::now();
+  auto& entities = m_gameState.entities();
+  int const side = TileGrid::chunkSide;
+  IntVec2 origin{ chunkCoords.x * side, chunkCoords.y * side };
+  int width = std::min(side, m_size.x - origin.x);
+  int height = std::min(side, m_size.y - origin.y);
+
+  for (int y = 0; y < height; ++y)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      IntVec2 coords{ origin.x + x, origin.y + y };
+      auto& data = chunk[(y * side) + x];
+
+      // Tile entities are created here; the space first, as it always was.
+      data.space = entities.createTileEntity(m_id, coords, m_defaultSpace);
+      data.floor = entities.createTileEntity(m_id, coords, m_defaultFloor);
+
+      MapTile tile{ *this, coords };
+      data.floorSpecs = tile.specsOf(data.floor).id();
+      data.spaceSpecs = tile.specsOf(data.space).id();
+      data.flags = calculateTileFlags(data.space);
+    }
+  }
+
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+  m_generationStats.tileEntities += elapsed;
+  m_generationStats.tileEntityCount += static_cast<size_t>(width) * height * 2;
+  CLOG(TRACE, "Map") << "Created tile chunk " << chunkCoords << " of map " << m_id << " in " <<
+    (elapsed.count() / 1000.0) << " ms; " << m_tiles.allocatedChunkCount() << " chunks use " <<
+    m_tiles.storageBytes() << " bytes";
+}
+
+uint8_t Map::calculateTileFlags(EntityId space) const
+{
+  auto& components = m_gameState.components();
+  uint8_t flags = 0;
+
+  // If the tile space has no opacity data, opacity is max (i.e. totally opaque).
+  Color opacity = components.appearance.existsFor(space) ?
+    components.appearance.of(space).opacity() : Color::White;
+  if (opacity == Color::White) flags |= TileFlags::Opaque;
+  if (opacity == Color::Black) flags |= TileFlags::Transparent;
+
+  // A tile is passable if its space has no Physical component, if it is
+  // fluid (it may kill you, but technically it's passable), or if its
+  // contents don't fill the entire tile.
+  if (!components.physical.existsFor(space))
+  {
+    flags |= TileFlags::Passable;
+  }
+  else if (components.matterState.existsFor(space) && components.matterState.of(space).isFluid())
+  {
+    flags |= TileFlags::Passable;
+  }
+  else if (components.physical.of(space).volume() < Components::ComponentPhysical::VOLUME_MAX_CC)
+  {
+    flags |= TileFlags::Passable;
+  }
+
+  return flags;
+}
+
+void Map::refreshTileFlags(IntVec2 tile)
+{
+  auto& data = tileData(tile);
+  setTileFlags(tile, data, calculateTileFlags(data.space));
+}
+
+void Map::setTileFlags(IntVec2 tile, TileData& data, uint8_t flags)
+{
+  bool wasPassable = (data.flags & TileFlags::Passable) != 0;
+  bool isPassable = (flags & TileFlags::Passable) != 0;
+  if (wasPassable != isPassable)
+  {
+    if (m_passableTilesBuilt) m_passableTiles.add(tile, isPassable ? 1 : -1);
+    ++m_passabilityVersion;
+    if (m_regionGraph) m_regionGraph->onTilePassabilityChanged(tile, isPassable);
+  }
+
+  data.flags = flags;
+}
+
+void Map::releasePassableTileIndex()
+{
+  m_passableTiles = FenwickGrid2D<int>();
+  m_passableTilesBuilt = false;
 }
 
 void Map::clearMapFeatures()
 {
   m_features.clear();
+  if (m_regionGraph) m_regionGraph->invalidate();
 }
 
 MapFeature& Map::getRandomMapFeature()
 {
   Assert("MapGenerator", m_features.size() >= 1, "getRandomMapFeature() called but map doesn't contain any features yet!");
 
-  int featureIndex = the_RNG.pick_uniform(0, static_cast<int>(m_features.size() - 1));
+  int featureIndex = m_rng->pick_uniform(0, static_cast<int>(m_features.size() - 1));
   return m_features[featureIndex];
 }
 
@@ -174,6 +702,7 @@ MapFeature& Map::addMapFeature(MapFeature* feature)
   if (feature != nullptr)
   {
     m_features.push_back(feature);
+    if (m_regionGraph) m_regionGraph->invalidate();
   }
   return *feature;
 }
@@ -191,7 +720,7 @@ int Map::LUA_getTileContents(lua_State* L)
   MapID map_id = MapID(lua_tostring(L, 1));
   IntVec2 coords = IntVec2(static_cast<int>(lua_tointeger(L, 2)), static_cast<int>(lua_tointeger(L, 3)));
 
-  auto& map_tile = GameState::instance().maps().get(map_id).getTile(coords);
+  auto map_tile = GameState::instance().maps().get(map_id).getTile(coords);
   EntityId contents = map_tile.getSpaceEntity();
 
   lua_pushinteger(L, contents);
@@ -246,3 +775,90 @@ int Map::LUA_mapAddFeature(lua_State* L)
 
   return 1;
 }
+
+int Map::LUA_getRegion(lua_State* L)
+{
+  int num_args = lua_gettop(L);
+
+  if (num_args != 3)
+  {
+    CLOG(WARNING, "Lua") << "expected 3 arguments, got " << num_args;
+    return 0;
+  }
+
+  MapID map_id = MapID(lua_tostring(L, 1));
+  IntVec2 coords{ static_cast<int>(lua_tointeger(L, 2)), static_cast<int>(lua_tointeger(L, 3)) };
+
+  auto& map = GameState::instance().maps().get(map_id);
+  int region = map.regionGraph().regionAt(coords);
+
+  if (region == MapRegionGraph::NoRegion)
+  {
+    lua_pushnil(L);
+  }
+  else
+  {
+    lua_pushinteger(L, region);
+  }
+
+  return 1;
+}
+
+int Map::LUA_tilesAreConnected(lua_State* L)
+{
+  int num_args = lua_gettop(L);
+
+  if (num_args != 5)
+  {
+    CLOG(WARNING, "Lua") << "expected 5 arguments, got " << num_args;
+    return 0;
+  }
+
+  MapID map_id = MapID(lua_tostring(L, 1));
+  IntVec2 first{ static_cast<int>(lua_tointeger(L, 2)), static_cast<int>(lua_tointeger(L, 3)) };
+  IntVec2 second{ static_cast<int>(lua_tointeger(L, 4)), static_cast<int>(lua_tointeger(L, 5)) };
+
+  auto& map = GameState::instance().maps().get(map_id);
+  bool connected = map.regionGraph().areConnected(first, second);
+
+  lua_pushboolean(L, static_cast<int>(connected));
+
+  return 1;
+}
+
+int Map::LUA_getRegionWaypoints(lua_State* L)
+{
+  int num_args = lua_gettop(L);
+
+  if (num_args != 5)
+  {
+    CLOG(WARNING, "Lua") << "expected 5 arguments, got " << num_args;
+    return 0;
+  }
+
+  MapID map_id = MapID(lua_tostring(L, 1));
+  IntVec2 from{ static_cast<int>(lua_tointeger(L, 2)), static_cast<int>(lua_tointeger(L, 3)) };
+  IntVec2 to{ static_cast<int>(lua_tointeger(L, 4)), static_cast<int>(lua_tointeger(L, 5)) };
+
+  auto& map = GameState::instance().maps().get(map_id);
+  std::vector<IntVec2> waypoints;
+
+  if (!map.regionGraph().findWaypoints(from, to, waypoints))
+  {
+    lua_pushnil(L);
+    return 1;
+  }
+
+  lua_createtable(L, static_cast<int>(waypoints.size()), 0);
+  for (size_t index = 0; index < waypoints.size(); ++index)
+  {
+    lua_createtable(L, 0, 2);
+    lua_pushinteger(L, waypoints[index].x);
+    lua_setfield(L, -2, "x");
+    lua_pushinteger(L, waypoints[index].y);
+    lua_setfield(L, -2, "y");
+    lua_rawseti(L, -2, static_cast<int>(index + 1));
+  }
+
+  return 1;
+}
@@ -4,18 +4,26 @@
 #include <boost/ptr_container/ptr_deque.hpp>
 
 #include "Object.h"
+#include "entity/EntityId.h"
 #include "map/MapFactory.h"
 #include "types/Direction.h"
+#include "types/EntitySpecs.h"
+#include "types/FenwickGrid2D.h"
+#include "types/ChunkedGrid2D.h"
 #include "types/Grid2D.h"
 #include "types/IRenderable.h"
 
 // Forward declarations
+class ChunkPager;
 class Color;
+class DijkstraMap;
 class GameState;
 class MapFeature;
 class MapGenerator;
+class MapPathfinder;
+class MapRegionGraph;
 class MapTile;
-class EntityId;
+class RNG;
 
 // VS compatibility
 #ifdef WIN32   //WINDOWS
@@ -28,23 +36,113 @@ class Map
   public Object
 {
   friend class MapFactory;
+  friend class MapTile;
   friend class MapView;
 
 public:
   ~Map();
 
-  /// The maximum length of one side.
-  static constexpr int max_dimension = 128;
+  /// Get a read-only view of a tile. Coordinates out of bounds are clamped
+  /// to the nearest edge of the map. The view never creates the tile's
+  /// chunk; see MapTile.
+  MapTile const getTile(IntVec2 tile) const;
 
-  /// The maximum area of a map.
-  static constexpr int max_area = max_dimension * max_dimension;
-
-  MapTile const & getTile(IntVec2 tile) const;
-
-  MapTile& getTile(IntVec2 tile);
+  /// Get a view of a tile. Coordinates out of bounds are clamped to the
+  /// nearest edge of the map.
+  MapTile getTile(IntVec2 tile);
 
   bool tileIsOpaque(IntVec2 tile) const;
 
+  /// Count the passable tiles in a rectangle, inclusive, without looking at
+  /// the tiles themselves. The rectangle is clipped to the map.
+  /// @param upperLeft    Upper-left corner of the rectangle.
+  /// @param lowerRight   Lower-right corner of the rectangle.
+  int countPassableTiles(IntVec2 upperLeft, IntVec2 lowerRight) const;
+
+  /// Get the map's opacity version.
+  /// The version changes whenever a tile on the map changes in a way that
+  /// might affect its opacity, and is never shared with another map (even
+  /// one that had the same ID), so it can be used to validate anything that
+  /// was calculated from the opacity of the map's tiles.
+  unsigned int getOpacityVersion() const;
+
+  /// Notify the map that the opacity of one of its tiles may have changed.
+  void invalidateOpacity();
+
+  /// Get the map's passability version.
+  /// The version changes whenever a tile on the map becomes passable or
+  /// impassable, so it can be used to validate anything that was calculated
+  /// from the passability of the map's tiles, such as paths.
+  unsigned int getPassabilityVersion() const;
+
+  /// Get the pathfinder for this map. It is created the first time it is
+  /// asked for.
+  MapPathfinder& pathfinder();
+
+  /// Get one of this map's Dijkstra maps, by name. It is created, with no
+  /// goals, the first time it is asked for.
+  DijkstraMap& dijkstraMap(std::string const& name);
+
+  /// Get the graph of this map's regions and the portals between them. It
+  /// is created the first time it is asked for.
+  MapRegionGraph& regionGraph();
+
+  /// Set the tile type used for every tile that hasn't been touched yet.
+  /// Tiles that already exist are set to the new type as well, so this can
+  /// be used to clear the whole map without creating every tile.
+  /// @param floor  Category/material of untouched tiles' floors.
+  /// @param space  Category/material of untouched tiles' spaces.
+  void setDefaultTileType(EntitySpecs floor, EntitySpecs space);
+
+  /// Set the type of every tile in a rectangle.
+  /// Tiles outside the map are skipped, and tiles that are already of the
+  /// right type are left alone. Opacity is invalidated once for the whole
+  /// region rather than once per tile.
+  /// @param upperLeft    Upper-left corner of the rectangle.
+  /// @param lowerRight   Lower-right corner of the rectangle (inclusive).
+  /// @param floor        Category/material to set tiles' floors to.
+  /// @param space        Category/material to set tiles' spaces to.
+  void fillTiles(IntVec2 upperLeft, IntVec2 lowerRight, EntitySpecs floor, EntitySpecs space);
+
+  /// Set the type of the tiles picked out by a mask, as fillTiles() does.
+  /// @param origin   Map coordinates of the mask's upper-left corner.
+  /// @param mask     Mask of tiles to set; tiles with nonzero entries are set.
+  /// @param floor    Category/material to set tiles' floors to.
+  /// @param space    Category/material to set tiles' spaces to.
+  void stampTiles(IntVec2 origin, Grid2D<uint8_t> const& mask, EntitySpecs floor, EntitySpecs space);
+
+  /// Set the type of the tiles along a polyline, as fillTiles() does.
+  /// @param points   Points on the line; each is joined to the next by a
+  ///                 straight line of tiles.
+  /// @param floor    Category/material to set tiles' floors to.
+  /// @param space    Category/material to set tiles' spaces to.
+  void carveTiles(std::vector<IntVec2> const& points, EntitySpecs floor, EntitySpecs space);
+
+  /// Get whether the chunk of tiles containing a tile has been created.
+  /// Untouched chunks have no tile entities; every tile in them is of the
+  /// default tile type.
+  bool isTileChunkCreated(IntVec2 tile) const;
+
+  /// Get the number of tile chunks that have been created.
+  size_t getCreatedTileChunkCount() const;
+
+  /// Get the number of bytes of tile data resident in memory.
+  size_t getResidentTileBytes() const;
+
+  /// Page tile chunks that haven't been used lately out to disk, least
+  /// recently used first, until the tile data left in memory fits within a
+  /// budget. Paged-out chunks come back transparently when next accessed,
+  /// read back synchronously.
+  ///
+  /// Only the TileData is paged: the tile entities and their components
+  /// stay in memory, so this bounds the tile grid, not the whole map.
+  /// @param activeTiles  Tiles that actors are on. Chunks near these are
+  ///                     counted as in use, and never paged out.
+  /// @param keepRadius   Radius around each active tile to keep, in tiles.
+  /// @param budgetBytes  Memory budget for resident tile data.
+  /// @return The number of chunks paged out.
+  size_t pageOutColdTileChunks(std::vector<IntVec2> const& activeTiles, int keepRadius, size_t budgetBytes);
+
   /// Get the map's size.
   IntVec2 const& getSize() const;
 
@@ -68,6 +166,35 @@ public:
   /// Get Map ID.
   MapID getMapID() const;
 
+  /// Timings and counts gathered while the map was generated, as reported
+  /// by tools/MapGenBench.
+  struct GenerationStats
+  {
+    /// Time spent filling the map and making the starting room.
+    std::chrono::microseconds setup{ 0 };
+
+    /// Time spent placing features.
+    std::chrono::microseconds features{ 0 };
+
+    /// Time spent running the map's Lua script.
+    std::chrono::microseconds script{ 0 };
+
+    /// Time spent creating tile entities. This is part of the other
+    /// times, not in addition to them.
+    std::chrono::microseconds tileEntities{ 0 };
+
+    /// Number of tile entities created.
+    size_t tileEntityCount = 0;
+  };
+
+  /// Get the timings and counts gathered while the map was generated.
+  GenerationStats const& getGenerationStats() const;
+
+  /// Get this map's random number stream. It is derived from the global
+  /// seed and the map ID, so a map comes out the same however much else
+  /// has been randomized before it.
+  RNG& rng();
+
   /// @todo Not sure all the "feature" stuff should be public.
   ///       But not sure how to scope it better either.
 
@@ -95,6 +222,75 @@ protected:
   /// can refer to it.
   void initialize();
 
+  /// Destroy the tile entities of every tile that has them, along with
+  /// everything on the tiles, before the map itself is destroyed.
+  void destroyTileEntities();
+
+  /// Flags cached for each tile, so hot queries (field of view, map
+  /// generation) don't have to go through the tile's components.
+  struct TileFlags
+  {
+    enum : uint8_t
+    {
+      Opaque = 1 << 0,
+      Transparent = 1 << 1,
+      Passable = 1 << 2
+    };
+  };
+
+  /// Data stored for each tile.
+  struct TileData
+  {
+    /// Entity representing the tile's floor.
+    EntityId floor;
+
+    /// Entity representing the tile's contents.
+    EntityId space;
+
+    /// Interned specs of the floor entity.
+    EntitySpecsId floorSpecs = 0;
+
+    /// Interned specs of the space entity.
+    EntitySpecsId spaceSpecs = 0;
+
+    /// Cached TileFlags.
+    uint8_t flags = 0;
+  };
+
+  /// Tile data, chunked so that memory scales with the area in use.
+  using TileGrid = ChunkedGrid2D<TileData>;
+
+  /// Clamp coordinates to the nearest edge of the map.
+  IntVec2 clampToBounds(IntVec2 tile) const;
+
+  /// Get a tile's data, creating its chunk (and tile entities) if necessary.
+  TileData& tileData(IntVec2 tile);
+
+  /// Get a tile's data without creating anything. Tiles in untouched chunks
+  /// return the default tile data, which has no entities.
+  TileData const& peekTileData(IntVec2 tile) const;
+
+  /// Create the tile entities for a newly allocated chunk of tiles.
+  void createTileChunk(IntVec2 chunkCoords, TileGrid::Chunk& chunk);
+
+  /// Calculate the flags of a tile from its space entity.
+  uint8_t calculateTileFlags(EntityId space) const;
+
+  /// Recalculate the cached flags of a tile from its space entity.
+  void refreshTileFlags(IntVec2 tile);
+
+  /// Set the cached flags of a tile, keeping the passability index in step.
+  void setTileFlags(IntVec2 tile, TileData& data, uint8_t flags);
+
+  /// Free the passability index; it is rebuilt when next needed.
+  void releasePassableTileIndex();
+
+  /// Set the type of a batch of tiles.
+  /// @param forEachTile  Functor that calls the functor passed to it with
+  ///                     the coordinates of each tile in the batch.
+  template <class Visitor>
+  void setTileTypes(Visitor forEachTile, EntitySpecs const& floor, EntitySpecs const& space);
+
 private:
   /// Reference to game state.
   GameState& m_gameState;
@@ -107,12 +303,56 @@ private:
 
   std::unique_ptr<MapGenerator> m_generator;
 
-  /// Grid of tiles.
-  std::unique_ptr< Grid2D< MapTile > > m_tiles;
+  /// Random number stream used to generate this map.
+  std::unique_ptr<RNG> m_rng;
+
+  /// Tile data.
+  TileGrid m_tiles;
+
+  /// Index of which tiles are passable, for counting them in rectangles.
+  /// It is deliberately dense (one cell per tile, chunks or not), since a
+  /// count over a rectangle needs every tile in it. To keep that off maps
+  /// that aren't being generated, it is only built when first counted,
+  /// and released once generation is done.
+  mutable FenwickGrid2D<int> m_passableTiles;
+
+  /// Whether m_passableTiles has been built.
+  mutable bool m_passableTilesBuilt = false;
+
+  /// Passability version of the map.
+  unsigned int m_passabilityVersion = 0;
+
+  /// Pathfinder for this map; created when first needed.
+  std::unique_ptr<MapPathfinder> m_pathfinder;
+
+  /// Dijkstra maps on this map, by name; each created when first needed.
+  std::unordered_map<std::string, std::unique_ptr<DijkstraMap>> m_dijkstraMaps;
+
+  /// Region graph of this map; created when first needed.
+  std::unique_ptr<MapRegionGraph> m_regionGraph;
+
+  /// Pager for cold tile chunks; created the first time one is paged out.
+  std::unique_ptr<ChunkPager> m_tilePager;
+
+  /// Value of the tile use clock when each tile chunk was last used.
+  std::vector<uint32_t> m_tileChunkLastUsed;
+
+  /// Clock advanced each time tile chunks are considered for paging out.
+  uint32_t m_tileUseClock = 0;
+
+  /// Types of untouched tiles' floors and spaces.
+  EntitySpecs m_defaultFloor;
+  EntitySpecs m_defaultSpace;
 
   /// Player starting location.
   IntVec2 m_start_coords;
 
+  /// Opacity version of the map.
+  unsigned int m_opacityVersion;
+
+  /// Timings and counts gathered during generation.
+  GenerationStats m_generationStats;
+
   /// Pointer deque of map features.
   boost::ptr_deque<MapFeature> m_features;
 
@@ -140,6 +380,33 @@ private:
   /// It returns:
   ///   - A boolean indicating whether the feature could be added to the map.
   static int LUA_mapAddFeature(lua_State* L);
+
+  /// Lua function to get the region a tile is in.
+  /// Takes three parameters:
+  ///   - The MapID of the map in question.
+  ///   - x, y location of the tile.
+  /// It returns:
+  ///   - The region ID, or nil if the tile isn't passable.
+  static int LUA_getRegion(lua_State* L);
+
+  /// Lua function to check whether one tile can be reached from another.
+  /// Takes five parameters:
+  ///   - The MapID of the map in question.
+  ///   - x, y location of the first tile.
+  ///   - x, y location of the second tile.
+  /// It returns:
+  ///   - A boolean indicating whether the tiles are connected.
+  static int LUA_tilesAreConnected(lua_State* L);
+
+  /// Lua function to plan a long route at the region level.
+  /// Takes five parameters:
+  ///   - The MapID of the map in question.
+  ///   - x, y location to start from.
+  ///   - x, y location to get to.
+  /// It returns:
+  ///   - A table of {x, y} waypoints ending with the destination, or nil if
+  ///     the destination can't be reached.
+  static int LUA_getRegionWaypoints(lua_State* L);
 };
 
 #endif // MAP_H
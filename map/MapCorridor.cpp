@@ -21,7 +21,7 @@ MapCorridor::MapCorridor(Map& m, PropertyDictionary const& s, GeoVector vec)
 
   while (numTries < maxRetries)
   {
-    int corridorLen = the_RNG.pick_uniform(minLength, maxLength);
+    int corridorLen = getMap().rng().pick_uniform(minLength, maxLength);
 
     int xMin, xMax, yMin, yMax;
 
@@ -72,17 +72,14 @@ MapCorridor::MapCorridor(Map& m, PropertyDictionary const& s, GeoVector vec)
       bool okay = true;
 
       // Verify that corridor and surrounding area are solid walls.
-      okay = doesBoxPassCriterion(
-      { xMin - 1, yMin - 1 },
-      { xMax + 1, yMax + 1 },
-                                     [&](MapTile& tile) { return !tile.isPassable(); });
+      okay = isBoxSolid({ xMin - 1, yMin - 1 }, { xMax + 1, yMax + 1 });
 
       if (okay)
       {
         /// @todo Deal with wall material if present
 
-        // Clear out the box.
-        setBox({ xMin, yMin }, { xMax, yMax }, { "Floor", floorMaterial }, { "OpenSpace" });
+        // Carve out the corridor.
+        getMap().carveTiles({ { xMin, yMin }, { xMax, yMax } }, { "Floor", floorMaterial }, { "OpenSpace" });
 
         setCoords(sf::IntRect(xMin, yMin, (xMax - xMin) + 1, (yMax - yMin) + 1));
 
@@ -106,7 +103,7 @@ MapCorridor::MapCorridor(Map& m, PropertyDictionary const& s, GeoVector vec)
 
         /// @todo: Put either a door or an open area at the starting coords.
         ///        Right now we just make it an open area.
-        auto& startTile = getMap().getTile(startingCoords);
+        auto startTile = getMap().getTile(startingCoords);
         startTile.setTileType({ "Floor", floorMaterial }, { "OpenSpace" });
 
         /// Check the tile two past the ending tile.
@@ -142,11 +139,11 @@ MapCorridor::MapCorridor(Map& m, PropertyDictionary const& s, GeoVector vec)
 
         if (getMap().isInBounds(checkCoords))
         {
-          auto& checkTile = getMap().getTile(checkCoords);
+          auto checkTile = getMap().getTile(checkCoords);
           if (checkTile.isPassable())
           {
             /// @todo Do a throw to see if it opens up. Right now it always does.
-            auto& endTile = getMap().getTile(m_endingCoords);
+            auto endTile = getMap().getTile(m_endingCoords);
             endTile.setTileType({ "Floor", floorMaterial }, { "OpenSpace" });
           }
         }
@@ -32,8 +32,8 @@ MapCrossCorridor::MapCrossCorridor(Map& m, PropertyDictionary const& s, GeoVecto
 
   while (numTries < maxRetries)
   {
-    int mainCorridorLen = the_RNG.pick_uniform(minLength, maxLength);
-    int subCorridorLen = the_RNG.pick_uniform(minLength, maxLength);
+    int mainCorridorLen = getMap().rng().pick_uniform(minLength, maxLength);
+    int subCorridorLen = getMap().rng().pick_uniform(minLength, maxLength);
 
     int mainXMin, mainXMax, mainYMin, mainYMax;
     int subXMin, subXMax, subYMin, subYMax;
@@ -83,16 +83,16 @@ MapCrossCorridor::MapCrossCorridor(Map& m, PropertyDictionary const& s, GeoVecto
     // Create sub corridor bounds.
     if ((direction == Direction::North) || (direction == Direction::South))
     {
-      subXMin = the_RNG.pick_uniform(mainXMin - subCorridorLen, mainXMin + subCorridorLen);
+      subXMin = getMap().rng().pick_uniform(mainXMin - subCorridorLen, mainXMin + subCorridorLen);
       subXMax = subXMin + (subCorridorLen - 1);
-      subYMin = the_RNG.pick_uniform(mainYMin, mainYMax);
+      subYMin = getMap().rng().pick_uniform(mainYMin, mainYMax);
       subYMax = subYMin;
     }
     else if ((direction == Direction::East) || (direction == Direction::West))
     {
-      subXMin = the_RNG.pick_uniform(mainXMin, mainXMax);
+      subXMin = getMap().rng().pick_uniform(mainXMin, mainXMax);
       subXMax = subXMin;
-      subYMin = the_RNG.pick_uniform(mainYMin - subCorridorLen, mainYMin + subCorridorLen);
+      subYMin = getMap().rng().pick_uniform(mainYMin - subCorridorLen, mainYMin + subCorridorLen);
       subYMax = subYMin + (subCorridorLen - 1);
 
     }
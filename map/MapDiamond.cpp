@@ -22,7 +22,7 @@ MapDiamond::MapDiamond(Map& m, PropertyDictionary const& s, GeoVector vec)
 
   while (numTries < max_retries)
   {
-    int diamondHalfSize = the_RNG.pick_uniform(minHsDist, maxHsDist);
+    int diamondHalfSize = getMap().rng().pick_uniform(minHsDist, maxHsDist);
 
     int xCenter, yCenter;
 
@@ -65,27 +65,21 @@ MapDiamond::MapDiamond(Map& m, PropertyDictionary const& s, GeoVector vec)
       /// @todo: Constrain this to only check around the edges of the
       ///        diamond, instead of the entire enclosing box.
 
-      okay = doesBoxPassCriterion({ xCenter - (diamondHalfSize + 1), yCenter - (diamondHalfSize + 1) },
-      { xCenter + (diamondHalfSize + 1), yCenter + (diamondHalfSize + 1) },
-                                     [&](MapTile& tile) { return !tile.isPassable(); });
+      okay = isBoxSolid({ xCenter - (diamondHalfSize + 1), yCenter - (diamondHalfSize + 1) },
+                        { xCenter + (diamondHalfSize + 1), yCenter + (diamondHalfSize + 1) });
 
       if (okay)
       {
         // Clear out a diamond.
-        for (int xCounter = -diamondHalfSize;
-             xCounter <= diamondHalfSize;
-             ++xCounter)
+        int diamondSize = (diamondHalfSize * 2) + 1;
+        Grid2D<uint8_t> mask({ diamondSize, diamondSize }, [&](IntVec2 coords) -> uint8_t
         {
-          for (int yCounter = -(diamondHalfSize - abs(xCounter));
-               yCounter <= diamondHalfSize - abs(xCounter);
-               ++yCounter)
-          {
-            int xCoord = xCenter + xCounter;
-            int yCoord = yCenter + yCounter;
-            auto& tile = getMap().getTile({ xCoord, yCoord });
-            tile.setTileType({ "Floor", floorMaterial }, { "OpenSpace" });
-          }
-        }
+          int xDist = abs(coords.x - diamondHalfSize);
+          int yDist = abs(coords.y - diamondHalfSize);
+          return (xDist + yDist <= diamondHalfSize) ? 1 : 0;
+        });
+        getMap().stampTiles({ xCenter - diamondHalfSize, yCenter - diamondHalfSize }, mask,
+                            { "Floor", floorMaterial }, { "OpenSpace" });
 
         setCoords(sf::IntRect(xCenter - diamondHalfSize,
                                yCenter - diamondHalfSize,
@@ -104,7 +98,7 @@ MapDiamond::MapDiamond(Map& m, PropertyDictionary const& s, GeoVector vec)
 
         /// @todo Put either a door or an open area at the starting coords.
         ///       Right now we just make it an open area.
-        auto& startTile = getMap().getTile(startingCoords);
+        auto startTile = getMap().getTile(startingCoords);
         startTile.setTileType({ "Floor", floorMaterial }, { "OpenSpace" });
 
         return;
@@ -31,33 +31,33 @@ MapDonutRoom::MapDonutRoom(Map& m, PropertyDictionary const& s, GeoVector vec)
   {
     sf::IntRect rect;
 
-    rect.width = the_RNG.pick_uniform(minWidth, maxWidth);
-    rect.height = the_RNG.pick_uniform(minHeight, maxHeight);
+    rect.width = getMap().rng().pick_uniform(minWidth, maxWidth);
+    rect.height = getMap().rng().pick_uniform(minHeight, maxHeight);
 
     if (direction == Direction::North)
     {
-      int offset = the_RNG.pick_uniform(0, rect.width - 1);
+      int offset = getMap().rng().pick_uniform(0, rect.width - 1);
 
       rect.top = starting_coords.y - rect.height;
       rect.left = starting_coords.x - offset;
     }
     else if (direction == Direction::South)
     {
-      int offset = the_RNG.pick_uniform(0, rect.width - 1);
+      int offset = getMap().rng().pick_uniform(0, rect.width - 1);
 
       rect.top = starting_coords.y + 1;
       rect.left = starting_coords.x - offset;
     }
     else if (direction == Direction::West)
     {
-      int offset = the_RNG.pick_uniform(0, rect.height - 1);
+      int offset = getMap().rng().pick_uniform(0, rect.height - 1);
 
       rect.top = starting_coords.y - offset;
       rect.left = starting_coords.x - rect.width;
     }
     else if (direction == Direction::East)
     {
-      int offset = the_RNG.pick_uniform(0, rect.height - 1);
+      int offset = getMap().rng().pick_uniform(0, rect.height - 1);
 
       rect.top = starting_coords.y - offset;
       rect.left = starting_coords.x + 1;
@@ -72,17 +72,16 @@ MapDonutRoom::MapDonutRoom(Map& m, PropertyDictionary const& s, GeoVector vec)
     {
       bool okay = true;
 
-      okay = doesBoxPassCriterion({ rect.left - 1, rect.top - 1 },
-      { rect.left + rect.width, rect.top + rect.height },
-                                     [&](MapTile& tile) { return !tile.isPassable(); });
+      okay = isBoxSolid({ rect.left - 1, rect.top - 1 },
+                        { rect.left + rect.width, rect.top + rect.height });
 
       // Create the hole location.
       sf::IntRect hole;
 
-      int x_hole_left = the_RNG.pick_uniform(rect.left + 1, rect.left + rect.width - 2);
-      int x_hole_right = the_RNG.pick_uniform(rect.left + 1, rect.left + rect.width - 2);
-      int y_hole_top = the_RNG.pick_uniform(rect.top + 1, rect.top + rect.height - 2);
-      int y_hole_bottom = the_RNG.pick_uniform(rect.top + 1, rect.top + rect.height - 2);
+      int x_hole_left = getMap().rng().pick_uniform(rect.left + 1, rect.left + rect.width - 2);
+      int x_hole_right = getMap().rng().pick_uniform(rect.left + 1, rect.left + rect.width - 2);
+      int y_hole_top = getMap().rng().pick_uniform(rect.top + 1, rect.top + rect.height - 2);
+      int y_hole_bottom = getMap().rng().pick_uniform(rect.top + 1, rect.top + rect.height - 2);
 
       // Make sure the hole isn't TOO small.
       // GSL GRUMBLE: WHY does abs() return a signed value?!?
@@ -98,22 +97,14 @@ MapDonutRoom::MapDonutRoom(Map& m, PropertyDictionary const& s, GeoVector vec)
       if (okay)
       {
         // Clear out the box EXCEPT FOR the hole.
-        for (int x_coord = rect.left;
-             x_coord <= rect.left + rect.width - 1;
-             ++x_coord)
+        Grid2D<uint8_t> mask({ rect.width, rect.height }, [&](IntVec2 coords) -> uint8_t
         {
-          for (int y_coord = rect.top;
-               y_coord <= rect.top + rect.height - 1;
-               ++y_coord)
-          {
-            if (!((x_coord >= x_hole_left) && (x_coord <= x_hole_right) &&
-              (y_coord >= y_hole_top) && (y_coord <= y_hole_bottom)))
-            {
-              auto& tile = getMap().getTile({ x_coord, y_coord });
-              tile.setTileType({ "Floor", floorMaterial }, { "OpenSpace" });
-            }
-          }
-        }
+          int x_coord = rect.left + coords.x;
+          int y_coord = rect.top + coords.y;
+          return ((x_coord >= x_hole_left) && (x_coord <= x_hole_right) &&
+                  (y_coord >= y_hole_top) && (y_coord <= y_hole_bottom)) ? 0 : 1;
+        });
+        getMap().stampTiles({ rect.left, rect.top }, mask, { "Floor", floorMaterial }, { "OpenSpace" });
 
         setCoords(rect);
 
@@ -152,7 +143,7 @@ MapDonutRoom::MapDonutRoom(Map& m, PropertyDictionary const& s, GeoVector vec)
 
         /// @todo Put either a door or an open area at the starting coords.
         ///       Right now we just make it an open area.
-        auto& startTile = getMap().getTile(starting_coords);
+        auto startTile = getMap().getTile(starting_coords);
         startTile.setTileType({ "Floor", floorMaterial }, { "OpenSpace" });
 
         return;
@@ -20,6 +20,9 @@ MapFactory::MapFactory(GameState& gameState)
   m_gameState.lua().register_function("map_get_tile_contents", Map::LUA_getTileContents);
   m_gameState.lua().register_function("map_get_start_coords", Map::LUA_getStartCoords);
   m_gameState.lua().register_function("map_add_feature", Map::LUA_mapAddFeature);
+  m_gameState.lua().register_function("map_get_region", Map::LUA_getRegion);
+  m_gameState.lua().register_function("map_tiles_are_connected", Map::LUA_tilesAreConnected);
+  m_gameState.lua().register_function("map_get_region_waypoints", Map::LUA_getRegionWaypoints);
 }
 
 MapFactory::~MapFactory()
@@ -92,6 +95,7 @@ bool MapFactory::destroy(MapID id)
 
   if (m_maps.count(id) != 0)
   {
+    m_maps.at(id)->destroyTileEntities();
     m_maps.erase(id);
     return true;
   }
@@ -26,6 +26,16 @@ public:
   /// Gets a reference to a Map by ID.
   Map& get(MapID map_id);
 
+  /// Calls a functor with a reference to every Map.
+  template <class Functor>
+  void forEach(Functor functor)
+  {
+    for (auto& pair : m_maps)
+    {
+      functor(*(pair.second));
+    }
+  }
+
   /// @todo Update so we pass in the MapID we want, and the function will
   ///       either use that ID, or create a similar one (e.g. if "main" is
   ///       passed in, and already exists, it will make a map named "main2"
@@ -46,12 +46,12 @@ GeoVector const& MapFeature::getRandomGrowthVector() const
 {
   if (m_highPriorityVecs.size() > 0)
   {
-    int randomVector = the_RNG.pick_uniform(0, static_cast<int>(m_highPriorityVecs.size() - 1));
+    int randomVector = getMap().rng().pick_uniform(0, static_cast<int>(m_highPriorityVecs.size() - 1));
     return m_highPriorityVecs[randomVector];
   }
   else if (m_lowPriorityVecs.size() > 0)
   {
-    int randomVector = the_RNG.pick_uniform(0, static_cast<int>(m_lowPriorityVecs.size() - 1));
+    int randomVector = getMap().rng().pick_uniform(0, static_cast<int>(m_lowPriorityVecs.size() - 1));
     return m_lowPriorityVecs[randomVector];
   }
   else
@@ -150,13 +150,13 @@ void MapFeature::addGrowthVector(GeoVector vec, bool highPriority)
 
 bool MapFeature::doesBoxPassCriterion(IntVec2 upperLeft,
                                       IntVec2 lowerRight,
-                                      std::function<bool(MapTile&)> criterion)
+                                      std::function<bool(MapTile const&)> criterion)
 {
   for (int xCheck = upperLeft.x; xCheck <= lowerRight.x; ++xCheck)
   {
     for (int yCheck = upperLeft.y; yCheck <= lowerRight.y; ++yCheck)
     {
-      auto& tile = getMap().getTile({ xCheck, yCheck });
+      auto tile = getMap().getTile({ xCheck, yCheck });
       if (!criterion(tile))
       {
         return false;
@@ -166,21 +166,14 @@ bool MapFeature::doesBoxPassCriterion(IntVec2 upperLeft,
   return true;
 }
 
-void MapFeature::setBox(IntVec2 upperLeft, IntVec2 lowerRight, EntitySpecs floor, EntitySpecs space)
+bool MapFeature::isBoxSolid(IntVec2 upperLeft, IntVec2 lowerRight)
 {
-  Map& map = getMap();
+  return getMap().countPassableTiles(upperLeft, lowerRight) == 0;
+}
 
-  for (int xCheck = upperLeft.x; xCheck <= lowerRight.x; ++xCheck)
-  {
-    for (int yCheck = upperLeft.y; yCheck <= lowerRight.y; ++yCheck)
-    {
-      if (map.isInBounds({ xCheck, yCheck }))
-      {
-        auto& tile = getMap().getTile({ xCheck, yCheck });
-        tile.setTileType(floor, space);
-      }
-    }
-  }
+void MapFeature::setBox(IntVec2 upperLeft, IntVec2 lowerRight, EntitySpecs floor, EntitySpecs space)
+{
+  getMap().fillTiles(upperLeft, lowerRight, floor, space);
 }
 
 void MapFeature::setBox(sf::IntRect rect, EntitySpecs floor, EntitySpecs space)
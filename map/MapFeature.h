@@ -77,7 +77,16 @@ protected:
   /// @return True if all tiles meet the criterion, false otherwise.
   bool doesBoxPassCriterion(IntVec2 upperLeft,
                             IntVec2 lowerRight,
-                            std::function<bool(MapTile&)> criterion);
+                            std::function<bool(MapTile const&)> criterion);
+
+  /// Check that no tiles within the area bounded by (upperLeft.x,
+  /// upperLeft.y) to (lowerRight.x, lowerRight.y), inclusive, are passable.
+  /// This uses the map's passability index, so it takes the same time
+  /// however big the box is.
+  /// @param upperLeft Coordinates of upper-left corner of box.
+  /// @param lowerRight Coordinates of lower-right corner of box.
+  /// @return True if the box is entirely solid, false otherwise.
+  bool isBoxSolid(IntVec2 upperLeft, IntVec2 lowerRight);
 
   /// Set all tiles within the area bounded by (upperLeft.x, upperLeft.y) to
   /// (lower_right.x, lower_right.y), inclusive, to the specified tile type.
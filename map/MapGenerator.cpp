@@ -19,6 +19,12 @@ MapGenerator::~MapGenerator()
 }
 
 void MapGenerator::generate()
+{
+  begin();
+  while (!step()) {}
+}
+
+void MapGenerator::begin()
 {
   PropertyDictionary feature_settings;
 
@@ -45,6 +51,8 @@ void MapGenerator::generate()
 
   MapFeature& startingRoom = m_game_map.addMapFeature(startRoom.get());
   startRoom.release();
+  m_frontier.clear();
+  m_frontier.push_back(&startingRoom);
 
   sf::IntRect startBox = startingRoom.getCoords();
   CLOG(TRACE, "MapGenerator") << "Starting room is at " << startBox;
@@ -58,69 +66,71 @@ void MapGenerator::generate()
 
   // Continue with additional map features.
   CLOG(TRACE, "MapGenerator") << "Making additional map features...";
+  m_featuresAdded = 0;
+}
 
-  unsigned int mapFeatures = 0;
+bool MapGenerator::step()
+{
+  if (m_featuresAdded >= m_limits.maxFeatures) return true;
 
-  while (mapFeatures < m_limits.maxFeatures)
+  PropertyDictionary feature_settings;
+
+  int chosen_feature = m_game_map.rng().pick_uniform(0, 8);
+  switch (chosen_feature)
   {
-    GeoVector nextGrowthVector;
+    case 0:
+      feature_settings.set("type", "room_diamond");
+      feature_settings.set("max_half_size", 4);
+      feature_settings.set("min_half_size", 2);
+      feature_settings.set("max_retries", 100);
+      break;
+
+    case 1:
+      feature_settings.set("type", "room_l");
+      feature_settings.set("horiz_leg_max_width", 20);
+      feature_settings.set("horiz_leg_min_width", 10);
+      feature_settings.set("horiz_leg_max_height", 7);
+      feature_settings.set("horiz_leg_min_height", 3);
+      feature_settings.set("vert_leg_max_width", 7);
+      feature_settings.set("vert_leg_min_width", 3);
+      feature_settings.set("vert_leg_max_height", 20);
+      feature_settings.set("vert_leg_min_height", 10);
+      feature_settings.set("max_retries", 500);
+      break;
+
+    case 2:
+      feature_settings.set("type", "room_torus");
+      feature_settings.set("max_width", 20);
+      feature_settings.set("min_width", 7);
+      feature_settings.set("max_height", 20);
+      feature_settings.set("min_height", 7);
+      feature_settings.set("min_hole_size", 5);
+      feature_settings.set("max_retries", 500);
+      break;
+
+    case 3:
+    case 4:
+    case 5:
+      feature_settings.set("type", "corridor");
+      feature_settings.set("max_length", 48);
+      feature_settings.set("min_length", 3);
+      feature_settings.set("max_retries", 100);
+      break;
+
+    default:
+      feature_settings.set("type", "room");
+      feature_settings.set("max_width", 15);
+      feature_settings.set("min_width", 3);
+      feature_settings.set("max_height", 15);
+      feature_settings.set("min_height", 3);
+      feature_settings.set("max_retries", 100);
+      break;
+  }
 
-    feature_settings.clear();
-    int chosen_feature = the_RNG.pick_uniform(0, 8);
-    switch (chosen_feature)
-    {
-      case 0:
-        feature_settings.set("type", "room_diamond");
-        feature_settings.set("max_half_size", 4);
-        feature_settings.set("min_half_size", 2);
-        feature_settings.set("max_retries", 100);
-        break;
-
-      case 1:
-        feature_settings.set("type", "room_l");
-        feature_settings.set("horiz_leg_max_width", 20);
-        feature_settings.set("horiz_leg_min_width", 10);
-        feature_settings.set("horiz_leg_max_height", 7);
-        feature_settings.set("horiz_leg_min_height", 3);
-        feature_settings.set("vert_leg_max_width", 7);
-        feature_settings.set("vert_leg_min_width", 3);
-        feature_settings.set("vert_leg_max_height", 20);
-        feature_settings.set("vert_leg_min_height", 10);
-        feature_settings.set("max_retries", 500);
-        break;
-
-      case 2:
-        feature_settings.set("type", "room_torus");
-        feature_settings.set("max_width", 20);
-        feature_settings.set("min_width", 7);
-        feature_settings.set("max_height", 20);
-        feature_settings.set("min_height", 7);
-        feature_settings.set("min_hole_size", 5);
-        feature_settings.set("max_retries", 500);
-        break;
-
-      case 3:
-      case 4:
-      case 5:
-        feature_settings.set("type", "corridor");
-        feature_settings.set("max_length", 48);
-        feature_settings.set("min_length", 3);
-        feature_settings.set("max_retries", 100);
-        break;
-
-      default:
-        feature_settings.set("type", "room");
-        feature_settings.set("max_width", 15);
-        feature_settings.set("min_width", 3);
-        feature_settings.set("max_height", 15);
-        feature_settings.set("min_height", 3);
-        feature_settings.set("max_retries", 100);
-        break;
-    }
+  add_feature(feature_settings);
+  ++m_featuresAdded;
 
-    add_feature(feature_settings);
-    ++mapFeatures;
-  }
+  return (m_featuresAdded >= m_limits.maxFeatures);
 }
 
 bool MapGenerator::add_feature(PropertyDictionary const& feature_settings)
@@ -135,7 +145,7 @@ bool MapGenerator::add_feature(PropertyDictionary const& feature_settings)
 
   if (feature)
   {
-    m_game_map.addMapFeature(feature.get());
+    m_frontier.push_back(&m_game_map.addMapFeature(feature.get()));
     feature.release();
     return true;
   }
@@ -144,30 +154,35 @@ bool MapGenerator::add_feature(PropertyDictionary const& feature_settings)
 }
 
 /// Fill map with stone.
+/// Only tiles that already exist are touched; the rest of the map is stone
+/// by default, and is created as features are carved out of it.
 void MapGenerator::clearMap()
 {
-  for (int y = 0; y < m_game_map.getSize().y; ++y)
-  {
-    for (int x = 0; x < m_game_map.getSize().x; ++x)
-    {
-      auto& tile = m_game_map.getTile({ x, y });
-      tile.setTileType({ "Floor", "Dirt" }, { "Wall", "Stone" });
-    }
-  }
+  m_game_map.setDefaultTileType({ "Floor", "Dirt" }, { "Wall", "Stone" });
 }
 
 /// Choose a random map feature and find a random place to tack on a new one.
+/// Only features on the frontier (those that might still have somewhere to
+/// grow from) are considered, so retries are only spent on growth vectors
+/// that have gone stale.
 bool MapGenerator::getGrowthVector(GeoVector& growthVector)
 {
   unsigned int numRetries = 0;
   IntVec2 const& mapSize = m_game_map.getSize();
 
-  while (numRetries < m_limits.maxAdjacentRetries)
+  while ((numRetries < m_limits.maxAdjacentRetries) && !m_frontier.empty())
   {
     ++numRetries;
 
-    MapFeature& feature = m_game_map.getRandomMapFeature();
-    if (feature.getNumOfGrowthVectors() > 0)
+    size_t featureIndex = m_game_map.rng().pick_uniform(0, static_cast<int>(m_frontier.size() - 1));
+    MapFeature& feature = *m_frontier[featureIndex];
+    if (feature.getNumOfGrowthVectors() == 0)
+    {
+      // Nowhere left to grow from, so drop it from the frontier.
+      m_frontier[featureIndex] = m_frontier.back();
+      m_frontier.pop_back();
+    }
+    else
     {
       GeoVector vec = feature.getRandomGrowthVector();
 
@@ -179,7 +194,7 @@ bool MapGenerator::getGrowthVector(GeoVector& growthVector)
       {
         if (vec.start_point.y > 0)
         {
-          auto& checkTile = m_game_map.getTile({ vec.start_point.x, vec.start_point.y - 1 });
+          auto checkTile = m_game_map.getTile({ vec.start_point.x, vec.start_point.y - 1 });
           vecOkay = !checkTile.isPassable();
         }
       }
@@ -187,7 +202,7 @@ bool MapGenerator::getGrowthVector(GeoVector& growthVector)
       {
         if (vec.start_point.x < mapSize.x - 1)
         {
-          auto& checkTile = m_game_map.getTile({ vec.start_point.x + 1, vec.start_point.y });
+          auto checkTile = m_game_map.getTile({ vec.start_point.x + 1, vec.start_point.y });
           vecOkay = !checkTile.isPassable();
         }
       }
@@ -195,7 +210,7 @@ bool MapGenerator::getGrowthVector(GeoVector& growthVector)
       {
         if (vec.start_point.y < mapSize.y - 1)
         {
-          auto& checkTile = m_game_map.getTile({ vec.start_point.x, vec.start_point.y + 1 });
+          auto checkTile = m_game_map.getTile({ vec.start_point.x, vec.start_point.y + 1 });
           vecOkay = !checkTile.isPassable();
         }
       }
@@ -203,7 +218,7 @@ bool MapGenerator::getGrowthVector(GeoVector& growthVector)
       {
         if (vec.start_point.x > 0)
         {
-          auto& checkTile = m_game_map.getTile({ vec.start_point.x - 1, vec.start_point.y });
+          auto checkTile = m_game_map.getTile({ vec.start_point.x - 1, vec.start_point.y });
           vecOkay = !checkTile.isPassable();
         }
       }
@@ -232,8 +247,8 @@ IntVec2 MapGenerator::getRandomSquare()
 {
   IntVec2 mapSize = m_game_map.getSize();
   IntVec2 coords;
-  coords.x = the_RNG.pick_uniform(1, mapSize.x - 2);
-  coords.y = the_RNG.pick_uniform(1, mapSize.y - 2);
+  coords.x = m_game_map.rng().pick_uniform(1, mapSize.x - 2);
+  coords.y = m_game_map.rng().pick_uniform(1, mapSize.y - 2);
   return coords;
 }
 
@@ -247,8 +262,8 @@ IntVec2 MapGenerator::getRandomFilledSquare()
 
   do
   {
-    coords.x = the_RNG.pick_uniform(1, mapSize.x - 2);
-    coords.y = the_RNG.pick_uniform(1, mapSize.y - 2);
+    coords.x = m_game_map.rng().pick_uniform(1, mapSize.x - 2);
+    coords.y = m_game_map.rng().pick_uniform(1, mapSize.y - 2);
   } while (m_game_map.getTile(coords).isPassable());
 
   return coords;
@@ -7,6 +7,7 @@
 
 // Forward declarations
 struct GeoVector;
+class MapFeature;
 
 /// The MapGenerator fills a map with dungeon features.
 class MapGenerator
@@ -15,8 +16,17 @@ public:
   explicit MapGenerator(Map& m);
   virtual ~MapGenerator();
 
+  /// Generate the whole map in one go.
   void generate();
 
+  /// Start generating the map: fill it with stone and make the starting
+  /// room. Follow with calls to step() until it returns true.
+  void begin();
+
+  /// Add the next feature to the map.
+  /// @return True once generation is finished.
+  bool step();
+
   bool add_feature(PropertyDictionary const& settings);
 
   struct FeatureLimits
@@ -64,6 +74,12 @@ private:
 
   /// Map feature variables.
   FeatureLimits m_limits;
+
+  /// Number of features added since generation began.
+  unsigned int m_featuresAdded = 0;
+
+  /// Features that may still have growth vectors left.
+  std::vector<MapFeature*> m_frontier;
 };
 
 #endif // MAPGENERATOR_H
@@ -34,55 +34,55 @@ MapLRoom::MapLRoom(Map& m, PropertyDictionary const& s, GeoVector vec)
     sf::IntRect horiz_rect;
     sf::IntRect vert_rect;
 
-    horiz_rect.width = the_RNG.pick_uniform(horizLegMinWidth, horizLegMaxWidth);
-    horiz_rect.height = the_RNG.pick_uniform(horizLegMinHeight, horizLegMaxHeight);
-    vert_rect.width = the_RNG.pick_uniform(vertLegMinWidth, vertLegMaxWidth);
-    vert_rect.height = the_RNG.pick_uniform(vertLegMinHeight, vertLegMaxHeight);
+    horiz_rect.width = getMap().rng().pick_uniform(horizLegMinWidth, horizLegMaxWidth);
+    horiz_rect.height = getMap().rng().pick_uniform(horizLegMinHeight, horizLegMaxHeight);
+    vert_rect.width = getMap().rng().pick_uniform(vertLegMinWidth, vertLegMaxWidth);
+    vert_rect.height = getMap().rng().pick_uniform(vertLegMinHeight, vertLegMaxHeight);
 
     if (direction == Direction::North)
     {
-      int offset = the_RNG.pick_uniform(0, horiz_rect.width - 1);
+      int offset = getMap().rng().pick_uniform(0, horiz_rect.width - 1);
 
       horiz_rect.top = starting_coords.y - horiz_rect.height;
       horiz_rect.left = starting_coords.x - offset;
 
       vert_rect.top = horiz_rect.top - vert_rect.height;
-      vert_rect.left = (the_RNG.flip_coin() ?
+      vert_rect.left = (getMap().rng().flip_coin() ?
                         horiz_rect.left :
                         horiz_rect.left + horiz_rect.width - vert_rect.width);
     }
     else if (direction == Direction::South)
     {
-      int offset = the_RNG.pick_uniform(0, horiz_rect.width - 1);
+      int offset = getMap().rng().pick_uniform(0, horiz_rect.width - 1);
 
       horiz_rect.top = starting_coords.y + 1;
       horiz_rect.left = starting_coords.x - offset;
 
       vert_rect.top = horiz_rect.top + horiz_rect.height;
-      vert_rect.left = (the_RNG.flip_coin() ?
+      vert_rect.left = (getMap().rng().flip_coin() ?
                         horiz_rect.left :
                         horiz_rect.left + horiz_rect.width - vert_rect.width);
     }
     else if (direction == Direction::West)
     {
-      int offset = the_RNG.pick_uniform(0, vert_rect.height - 1);
+      int offset = getMap().rng().pick_uniform(0, vert_rect.height - 1);
 
       vert_rect.top = starting_coords.y - offset;
       vert_rect.left = starting_coords.x - vert_rect.width;
 
-      horiz_rect.top = (the_RNG.flip_coin() ?
+      horiz_rect.top = (getMap().rng().flip_coin() ?
                         vert_rect.top :
                         vert_rect.top + vert_rect.height - horiz_rect.height);
       horiz_rect.left = vert_rect.left - horiz_rect.width;
     }
     else if (direction == Direction::East)
     {
-      int offset = the_RNG.pick_uniform(0, vert_rect.height - 1);
+      int offset = getMap().rng().pick_uniform(0, vert_rect.height - 1);
 
       vert_rect.top = starting_coords.y - offset;
       vert_rect.left = starting_coords.x + 1;
 
-      horiz_rect.top = (the_RNG.flip_coin() ?
+      horiz_rect.top = (getMap().rng().flip_coin() ?
                         vert_rect.top :
                         vert_rect.top + vert_rect.height - horiz_rect.height);
       horiz_rect.left = vert_rect.left + vert_rect.width;
@@ -100,13 +100,11 @@ MapLRoom::MapLRoom(Map& m, PropertyDictionary const& s, GeoVector vec)
       bool okay = true;
 
       // Verify that both boxes and surrounding area are solid walls.
-      okay = doesBoxPassCriterion({ vert_rect.left - 1, vert_rect.top - 1 },
-      { vert_rect.left + vert_rect.width, vert_rect.top + vert_rect.height },
-                                     [&](MapTile& tile) { return !tile.isPassable(); });
+      okay = isBoxSolid({ vert_rect.left - 1, vert_rect.top - 1 },
+                        { vert_rect.left + vert_rect.width, vert_rect.top + vert_rect.height });
 
-      okay &= doesBoxPassCriterion({ horiz_rect.left - 1, horiz_rect.top - 1 },
-      { horiz_rect.left + horiz_rect.width, horiz_rect.top + horiz_rect.height },
-                                      [&](MapTile& tile) { return !tile.isPassable(); });
+      okay &= isBoxSolid({ horiz_rect.left - 1, horiz_rect.top - 1 },
+                         { horiz_rect.left + horiz_rect.width, horiz_rect.top + horiz_rect.height });
 
       if (okay)
       {
@@ -163,7 +161,7 @@ MapLRoom::MapLRoom(Map& m, PropertyDictionary const& s, GeoVector vec)
 
         /// @todo Put either a door or an open area at the starting coords.
         ///       Right now we just make it an open area.
-        auto& startTile = getMap().getTile(starting_coords);
+        auto startTile = getMap().getTile(starting_coords);
         startTile.setTileType({ "Floor", floorMaterial }, { "OpenSpace" });
 
         return;
@@ -3,30 +3,127 @@
 #include "map/MapMemory.h"
 #include "utilities/JSONUtils.h"
 
+namespace
+{
+  /// Palette mapping interned specs to the indices used in saved memory.
+  class SpecsPalette
+  {
+  public:
+    SpecsPalette()
+    {
+      m_specs = json::array();
+      m_specs.push_back(EntitySpecs());
+      m_indices[0] = 0;
+    }
+
+    unsigned int indexOf(EntitySpecsId id)
+    {
+      auto iter = m_indices.find(id);
+      if (iter != m_indices.end()) return iter->second;
+
+      unsigned int newIndex = static_cast<unsigned int>(m_specs.size());
+      m_specs.push_back(EntitySpecs::fromId(id));
+      m_indices[id] = newIndex;
+      return newIndex;
+    }
+
+    json const& specs() const
+    {
+      return m_specs;
+    }
+
+  private:
+    json m_specs;
+    std::unordered_map<EntitySpecsId, unsigned int> m_indices;
+  };
+}
+
 void from_json(json const& j, MapMemory& obj)
 {
   obj.m_size = IntVec2(0, 0);
-  obj.m_chunks.clear();
+  obj.m_chunks = ChunkedGrid2D<MapMemoryChunk, MapMemory::blockSide>();
+  obj.m_overflow.clear();
+
+  JSONUtils::doIfPresent(j, "size", [&](auto& value) { obj.resize(value); });
 
-  JSONUtils::doIfPresent(j, "size", [&](auto& value) { obj.m_size = value; });
-  JSONUtils::doIfPresent(j, "chunks", [&](auto& value) 
-  { 
+  // Convert the saved palette back into interned specs.
+  std::vector<EntitySpecsId> palette;
+  JSONUtils::doIfPresent(j, "palette", [&](auto& value)
+  {
+    for (auto& entry : value)
+    {
+      EntitySpecs specs = entry;
+      palette.push_back(specs.id());
+    }
+  });
+
+  auto fromPalette = [&](unsigned int index) -> EntitySpecsId
+  {
+    return (index < palette.size()) ? palette[index] : 0;
+  };
+
+  // Squares are saved as runs of [index, floor, space, when] quads,
+  // skipping anything never seen.
+  JSONUtils::doIfPresent(j, "squares", [&](auto& value)
+  {
+    for (size_t i = 0; i + 3 < value.size(); i += 4)
+    {
+      unsigned int index = value[i];
+      IntVec2 coords{ static_cast<int>(index % std::max(obj.m_size.x, 1)),
+                      static_cast<int>(index / std::max(obj.m_size.x, 1)) };
+      if (obj.m_chunks.contains(coords))
+      {
+        obj.m_chunks[coords] = MapMemoryChunk(fromPalette(value[i + 1]),
+                                             fromPalette(value[i + 2]),
+                                             value[i + 3].template get<ElapsedTicks>());
+      }
+    }
+  });
+
+  JSONUtils::doIfPresent(j, "items", [&](auto& value)
+  {
     for (auto citer = value.cbegin(); citer != value.cend(); ++citer)
     {
-      obj.m_chunks[std::stoul(citer.key())] = citer.value();
+      auto& items = obj.m_overflow[std::stoul(citer.key())];
+      for (auto& item : citer.value())
+      {
+        items.push_back(fromPalette(item));
+      }
     }
   });
 }
 
 void to_json(json& j, MapMemory const& obj)
 {
-  j = json::object();
-  j["size"] = obj.m_size;
-  j["chunks"] = json::object();
-  for (auto citer = obj.m_chunks.cbegin(); citer != obj.m_chunks.cend(); ++citer)
+  SpecsPalette palette;
+  json squares = json::array();
+  json items = json::object();
+
+  obj.m_chunks.forEachAllocated([&](IntVec2 coords, MapMemoryChunk const& chunk)
+  {
+    if (chunk.isEmpty()) return;
+
+    squares.push_back(obj.index(coords));
+    squares.push_back(palette.indexOf(chunk.getFloor()));
+    squares.push_back(palette.indexOf(chunk.getSpace()));
+    squares.push_back(chunk.getTimeOfMemory());
+  });
+
+  for (auto& pair : obj.m_overflow)
   {
-    j["chunks"][std::to_string(citer->first)] = citer->second;
+    json indices = json::array();
+    for (auto item : pair.second)
+    {
+      indices.push_back(palette.indexOf(item));
+    }
+    items[std::to_string(pair.first)] = indices;
   }
+
+  j = json::object();
+  j["size"] = obj.m_size;
+  j["palette"] = palette.specs();
+  j["squares"] = squares;
+  j["items"] = items;
 }
 
 IntVec2 const& MapMemory::size() const
@@ -34,40 +131,70 @@ IntVec2 const& MapMemory::size() const
   return m_size;
 }
 
-MapMemoryChunk& MapMemory::at(IntVec2 coords)
-{
-  return m_chunks.at(index(coords));
-}
-
 MapMemoryChunk const& MapMemory::at(IntVec2 coords) const
 {
-  return m_chunks.at(index(coords));
+  if (!m_chunks.contains(coords)) throw std::out_of_range("MapMemory coordinates out of range");
+  return m_chunks.get(coords);
 }
 
 void MapMemory::clear()
 {
   m_chunks.clear();
+  m_overflow.clear();
 }
 
 bool MapMemory::contains(IntVec2 coords) const
 {
-  return m_chunks.count(index(coords)) != 0;
+  return m_chunks.contains(coords) && !m_chunks.get(coords).isEmpty();
 }
 
-MapMemoryChunk& MapMemory::operator[](IntVec2 coords)
+bool MapMemory::hasBlockAt(IntVec2 coords) const
 {
-  if (!contains(coords))
+  return m_chunks.contains(coords) && m_chunks.isChunkAllocated(m_chunks.chunkCoordsOf(coords));
+}
+
+bool MapMemory::remember(IntVec2 coords, EntitySpecsId floor, EntitySpecsId space, ElapsedTicks when)
+{
+  return m_chunks.at(coords).update(floor, space, when);
+}
+
+std::vector<EntitySpecsId> const& MapMemory::itemsAt(IntVec2 coords) const
+{
+  static std::vector<EntitySpecsId> const noItems;
+  auto iter = m_overflow.find(index(coords));
+  return (iter != m_overflow.end()) ? iter->second : noItems;
+}
+
+bool MapMemory::rememberItems(IntVec2 coords, std::vector<EntitySpecsId> const& items)
+{
+  auto iter = m_overflow.find(index(coords));
+
+  if (iter == m_overflow.end())
+  {
+    if (items.empty()) return false;
+    m_overflow[index(coords)] = items;
+    return true;
+  }
+
+  if (iter->second == items) return false;
+
+  if (items.empty())
+  {
+    m_overflow.erase(iter);
+  }
+  else
   {
-    m_chunks[index(coords)] = MapMemoryChunk();
+    iter->second = items;
   }
-  return m_chunks.at(index(coords));
+  return true;
 }
 
 void MapMemory::resize(IntVec2 size)
 {
   Assert("Map", (size.x > 0 && size.y > 0), "Invalid size (" << size.x << ", " << size.y << ") specified");
-  clear();
   m_size = size;
+  m_chunks = ChunkedGrid2D<MapMemoryChunk, blockSide>(size);
+  m_overflow.clear();
 }
 
 MapMemoryChunk const& MapMemory::valueOr(IntVec2 coords, MapMemoryChunk const& defaultValue) const
@@ -76,7 +203,7 @@ MapMemoryChunk const& MapMemory::valueOr(IntVec2 coords, MapMemoryChunk const& d
   {
     return defaultValue;
   }
-  return m_chunks.at(index(coords));
+  return m_chunks.get(coords);
 }
 
 unsigned int MapMemory::index(IntVec2 coords) const
@@ -1,28 +1,50 @@
 #pragma once
 
+#include <unordered_map>
 #include <vector>
 
+#include "types/ChunkedGrid2D.h"
 #include "types/MapMemoryChunk.h"
 #include "types/Vec2.h"
 
 #include "json.hpp"
 using json = ::nlohmann::json;
 
-// Map memory struct.
+/// An entity's memory of a map.
+/// Memory is stored as a sparse grid of chunks holding interned specs; only
+/// the parts of the map that have actually been seen take up any space. When
+/// saved, the specs used are gathered into a palette and each square is
+/// stored as indices into it.
 class MapMemory
 {
 public:
+  /// Length of one side of the blocks memory is stored in, in squares.
+  static constexpr int blockSide = 32;
 
   friend void from_json(json const& j, MapMemory& obj);
   friend void to_json(json& j, MapMemory const& obj);
 
   IntVec2 const& size() const;
 
-  MapMemoryChunk& at(IntVec2 coords);
   MapMemoryChunk const& at(IntVec2 coords) const;
   void clear();
   bool contains(IntVec2 coords) const;
-  MapMemoryChunk& operator[](IntVec2 coords);
+
+  /// Get whether anything has been remembered in the block of squares
+  /// containing a square. Blocks that haven't take up no memory.
+  bool hasBlockAt(IntVec2 coords) const;
+
+  /// Remember the floor and space of a square.
+  /// @return True if the memory of the square changed.
+  bool remember(IntVec2 coords, EntitySpecsId floor, EntitySpecsId space, ElapsedTicks when);
+
+  /// Get any other entities remembered on a square.
+  std::vector<EntitySpecsId> const& itemsAt(IntVec2 coords) const;
+
+  /// Remember the other entities on a square.
+  /// @return True if the memory of the square changed.
+  bool rememberItems(IntVec2 coords, std::vector<EntitySpecsId> const& items);
+
   void resize(IntVec2 size);
   MapMemoryChunk const& valueOr(IntVec2 coords, MapMemoryChunk const& defaultValue) const;
 
@@ -31,5 +53,10 @@ protected:
 
 private:
   IntVec2 m_size;
-  std::map<unsigned int, MapMemoryChunk> m_chunks;
-};
\ No newline at end of file
+
+  /// Sparse grid of remembered floors and spaces.
+  ChunkedGrid2D<MapMemoryChunk, blockSide> m_chunks;
+
+  /// Other entities remembered, for the few squares that have any.
+  std::unordered_map<unsigned int, std::vector<EntitySpecsId>> m_overflow;
+};
@@ -0,0 +1,418 @@
+#include "stdafx.h"
+
+#include "map/MapPathfinder.h"
+
+#include <boost/functional/hash.hpp>
+
+#include "map/Map.h"
+#include "maptile/MapTile.h"
+
+namespace
+{
+  /// Cost of a straight move.
+  int const StraightCost = 10;
+
+  /// Cost of a diagonal move (roughly StraightCost * sqrt(2)).
+  int const DiagonalCost = 14;
+
+  /// Get the octile distance between two tiles, which is the cost of the
+  /// cheapest path between them if nothing is in the way.
+  int octileDistance(IntVec2 from, IntVec2 to)
+  {
+    int dx = std::abs(to.x - from.x);
+    int dy = std::abs(to.y - from.y);
+    return (StraightCost * std::max(dx, dy)) + ((DiagonalCost - StraightCost) * std::min(dx, dy));
+  }
+
+  int sign(int value)
+  {
+    return (value > 0) - (value < 0);
+  }
+
+  IntVec2 const AllDirections[] =
+  {
+    { 0, -1 }, { 1, -1 }, { 1, 0 }, { 1, 1 },
+    { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }
+  };
+}
+
+MapPathfinder::MapPathfinder(Map const& map, size_t cacheCapacity)
+  :
+  m_map{ map },
+  m_capacity{ cacheCapacity }
+{
+  IntVec2 const& size = map.getSize();
+  size_t tileCount = static_cast<size_t>(size.x) * size.y;
+  m_traversable.resize(tileCount);
+  m_nodes.resize(tileCount);
+}
+
+MapPathfinder::~MapPathfinder()
+{}
+
+bool MapPathfinder::findPath(EntityId mover, IntVec2 start, IntVec2 goal, Algorithm algorithm, std::vector<IntVec2>& path)
+{
+  path.clear();
+
+  if (!m_map.isInBounds(start) || !m_map.isInBounds(goal)) return false;
+  if (start == goal) return true;
+
+  Key key{ mover, goal, algorithm };
+  unsigned int version = m_map.getPassabilityVersion();
+
+  // If the mover is somewhere along a path it was given before, and nothing
+  // has changed since, the rest of that path is still the best one.
+  auto iter = m_index.find(key);
+  if ((iter != m_index.end()) && (iter->second->second.passabilityVersion == version))
+  {
+    auto& tiles = iter->second->second.tiles;
+    auto here = std::find(tiles.begin(), tiles.end(), start);
+    if (here != tiles.end())
+    {
+      ++m_stats.hits;
+      path.assign(here + 1, tiles.end());
+      m_entries.splice(m_entries.begin(), m_entries, iter->second);
+      return true;
+    }
+  }
+
+  ++m_stats.misses;
+
+  beginSearch(mover);
+  if (!canTraverse(goal.x, goal.y)) return false;
+
+  bool found = (algorithm == Algorithm::JumpPoint) ?
+    searchJumpPoint(start, goal) :
+    searchAStar(start, goal);
+
+  if (!found) return false;
+
+  CachedPath cachedPath{ version, {} };
+  buildPath(start, goal, cachedPath.tiles);
+  path.assign(cachedPath.tiles.begin() + 1, cachedPath.tiles.end());
+
+  if (m_capacity > 0)
+  {
+    if (iter != m_index.end())
+    {
+      iter->second->second = std::move(cachedPath);
+      m_entries.splice(m_entries.begin(), m_entries, iter->second);
+    }
+    else
+    {
+      m_entries.emplace_front(key, std::move(cachedPath));
+      m_index[key] = m_entries.begin();
+      trim();
+    }
+  }
+
+  return true;
+}
+
+void MapPathfinder::clearCache()
+{
+  m_index.clear();
+  m_entries.clear();
+}
+
+size_t MapPathfinder::cacheCapacity() const
+{
+  return m_capacity;
+}
+
+void MapPathfinder::setCacheCapacity(size_t capacity)
+{
+  m_capacity = capacity;
+  trim();
+}
+
+MapPathfinder::Stats const& MapPathfinder::stats() const
+{
+  return m_stats;
+}
+
+void MapPathfinder::resetStats()
+{
+  m_stats = Stats();
+}
+
+bool MapPathfinder::canTraverse(int x, int y)
+{
+  if (!m_map.isInBounds({ x, y })) return false;
+
+  uint8_t& known = m_traversable[index(x, y)];
+  if (known == 0)
+  {
+    known = m_map.getTile({ x, y }).canBeTraversedBy(m_traversableMover) ? 1 : 2;
+  }
+  return known == 1;
+}
+
+bool MapPathfinder::canStep(int x, int y, int dx, int dy)
+{
+  if (!canTraverse(x + dx, y + dy)) return false;
+
+  // Diagonal moves may not cut corners.
+  return (dx == 0) || (dy == 0) || (canTraverse(x + dx, y) && canTraverse(x, y + dy));
+}
+
+void MapPathfinder::beginSearch(EntityId mover)
+{
+  unsigned int version = m_map.getPassabilityVersion();
+  if (!m_traversableValid || (m_traversableMover != mover) || (m_traversableVersion != version))
+  {
+    std::fill(m_traversable.begin(), m_traversable.end(), 0);
+    m_traversableMover = mover;
+    m_traversableVersion = version;
+    m_traversableValid = true;
+  }
+
+  ++m_searchStamp;
+  if (m_searchStamp == 0)
+  {
+    // The stamp wrapped around, so old nodes might look current.
+    for (auto& node : m_nodes) node.stamp = 0;
+    m_searchStamp = 1;
+  }
+
+  m_open.clear();
+}
+
+void MapPathfinder::relax(int index, int parent, int cost, IntVec2 goal)
+{
+  Node& node = m_nodes[index];
+  if (node.stamp != m_searchStamp)
+  {
+    node.stamp = m_searchStamp;
+    node.closed = false;
+  }
+  else if (node.closed || (cost >= node.cost))
+  {
+    return;
+  }
+
+  node.cost = cost;
+  node.parent = parent;
+
+  // Entries are never updated in place; stale ones are skipped when popped.
+  m_open.emplace_back(cost + octileDistance(coords(index), goal), index);
+  std::push_heap(m_open.begin(), m_open.end(), std::greater<std::pair<int, int>>());
+}
+
+int MapPathfinder::popOpen()
+{
+  while (!m_open.empty())
+  {
+    std::pop_heap(m_open.begin(), m_open.end(), std::greater<std::pair<int, int>>());
+    int index = m_open.back().second;
+    m_open.pop_back();
+
+    Node& node = m_nodes[index];
+    if (node.closed) continue;
+
+    node.closed = true;
+    ++m_stats.nodesExpanded;
+    return index;
+  }
+
+  return -1;
+}
+
+bool MapPathfinder::searchAStar(IntVec2 start, IntVec2 goal)
+{
+  int goalIndex = index(goal.x, goal.y);
+  relax(index(start.x, start.y), -1, 0, goal);
+
+  int current;
+  while ((current = popOpen()) >= 0)
+  {
+    if (current == goalIndex) return true;
+
+    IntVec2 here = coords(current);
+    int cost = m_nodes[current].cost;
+
+    for (auto& direction : AllDirections)
+    {
+      if (canStep(here.x, here.y, direction.x, direction.y))
+      {
+        int stepCost = ((direction.x != 0) && (direction.y != 0)) ? DiagonalCost : StraightCost;
+        relax(index(here.x + direction.x, here.y + direction.y), current, cost + stepCost, goal);
+      }
+    }
+  }
+
+  return false;
+}
+
+bool MapPathfinder::searchJumpPoint(IntVec2 start, IntVec2 goal)
+{
+  int goalIndex = index(goal.x, goal.y);
+  relax(index(start.x, start.y), -1, 0, goal);
+
+  std::vector<IntVec2> directions;
+  directions.reserve(8);
+
+  int current;
+  while ((current = popOpen()) >= 0)
+  {
+    if (current == goalIndex) return true;
+
+    IntVec2 here = coords(current);
+    Node const& node = m_nodes[current];
+    int x = here.x;
+    int y = here.y;
+
+    // Prune the directions worth searching, given the direction we came in.
+    directions.clear();
+    if (node.parent < 0)
+    {
+      directions.assign(std::begin(AllDirections), std::end(AllDirections));
+    }
+    else
+    {
+      IntVec2 parent = coords(node.parent);
+      int dx = sign(x - parent.x);
+      int dy = sign(y - parent.y);
+
+      if ((dx != 0) && (dy != 0))
+      {
+        directions.push_back({ 0, dy });
+        directions.push_back({ dx, 0 });
+        directions.push_back({ dx, dy });
+      }
+      else if (dx != 0)
+      {
+        directions.push_back({ dx, 0 });
+        directions.push_back({ dx, -1 });
+        directions.push_back({ dx, 1 });
+        directions.push_back({ 0, -1 });
+        directions.push_back({ 0, 1 });
+      }
+      else
+      {
+        directions.push_back({ 0, dy });
+        directions.push_back({ -1, dy });
+        directions.push_back({ 1, dy });
+        directions.push_back({ -1, 0 });
+        directions.push_back({ 1, 0 });
+      }
+    }
+
+    for (auto& direction : directions)
+    {
+      IntVec2 jumpPoint;
+      if (jump(here, direction, goal, jumpPoint))
+      {
+        relax(index(jumpPoint.x, jumpPoint.y), current, node.cost + octileDistance(here, jumpPoint), goal);
+      }
+    }
+  }
+
+  return false;
+}
+
+bool MapPathfinder::jump(IntVec2 from, IntVec2 direction, IntVec2 goal, IntVec2& result)
+{
+  int x = from.x;
+  int y = from.y;
+  int dx = direction.x;
+  int dy = direction.y;
+
+  while (canStep(x, y, dx, dy))
+  {
+    x += dx;
+    y += dy;
+
+    if ((x == goal.x) && (y == goal.y))
+    {
+      result = goal;
+      return true;
+    }
+
+    if ((dx != 0) && (dy != 0))
+    {
+      // A diagonal jump stops wherever a straight jump from it would.
+      IntVec2 unused;
+      if (jump({ x, y }, { dx, 0 }, goal, unused) || jump({ x, y }, { 0, dy }, goal, unused))
+      {
+        result = { x, y };
+        return true;
+      }
+    }
+    else if (dx != 0)
+    {
+      if ((canTraverse(x, y - 1) && !canTraverse(x - dx, y - 1)) ||
+          (canTraverse(x, y + 1) && !canTraverse(x - dx, y + 1)))
+      {
+        result = { x, y };
+        return true;
+      }
+    }
+    else
+    {
+      if ((canTraverse(x - 1, y) && !canTraverse(x - 1, y - dy)) ||
+          (canTraverse(x + 1, y) && !canTraverse(x + 1, y - dy)))
+      {
+        result = { x, y };
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+void MapPathfinder::buildPath(IntVec2 start, IntVec2 goal, std::vector<IntVec2>& path) const
+{
+  std::vector<IntVec2> waypoints;
+  for (int current = index(goal.x, goal.y); current >= 0; current = m_nodes[current].parent)
+  {
+    waypoints.push_back(coords(current));
+  }
+  std::reverse(waypoints.begin(), waypoints.end());
+
+  // Waypoints from a jump point search can be far apart, but always lie on
+  // a straight or diagonal line from each other.
+  path.clear();
+  path.push_back(start);
+  for (size_t waypoint = 1; waypoint < waypoints.size(); ++waypoint)
+  {
+    IntVec2 here = waypoints[waypoint - 1];
+    IntVec2 next = waypoints[waypoint];
+    IntVec2 step{ sign(next.x - here.x), sign(next.y - here.y) };
+    while (!(here == next))
+    {
+      here = { here.x + step.x, here.y + step.y };
+      path.push_back(here);
+    }
+  }
+}
+
+void MapPathfinder::trim()
+{
+  while (m_entries.size() > m_capacity)
+  {
+    m_index.erase(m_entries.back().first);
+    m_entries.pop_back();
+  }
+}
+
+int MapPathfinder::index(int x, int y) const
+{
+  return (y * m_map.getSize().x) + x;
+}
+
+IntVec2 MapPathfinder::coords(int index) const
+{
+  int width = m_map.getSize().x;
+  return{ index % width, index / width };
+}
+
+size_t MapPathfinder::KeyHash::operator()(Key const& key) const
+{
+  size_t seed = 0;
+  boost::hash_combine(seed, std::hash<EntityId>()(key.mover));
+  boost::hash_combine(seed, std::hash<IntVec2>()(key.goal));
+  boost::hash_combine(seed, static_cast<int>(key.algorithm));
+  return seed;
+}
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "entity/EntityId.h"
+#include "types/Vec2.h"
+
+// Forward declarations
+class Map;
+
+/// Finds paths across a map for entities to follow.
+/// Moves are in the eight compass directions. Diagonal moves cost more than
+/// straight ones (octile distance), so paths don't zig-zag, and they may not
+/// cut the corner of a tile the mover can't traverse.
+///
+/// Two searches are available: plain A*, and jump point search, which finds
+/// paths of the same length but skips over runs of open tiles instead of
+/// putting every one of them on the open list.
+///
+/// Paths found are cached by mover, goal and algorithm, along with the
+/// passability version of the map. An entity walking along a path it was
+/// given gets the rest of that path back on later turns without another
+/// search, until some tile on the map changes passability.
+///
+/// Search state is kept in flat per-tile arrays rather than following the
+/// map's chunks: a search can cross the whole map, and indexing them is the
+/// hot loop. The map only creates its pathfinder, and so these, when
+/// something first asks for a path.
+class MapPathfinder
+{
+public:
+  /// Search algorithms available.
+  enum class Algorithm
+  {
+    AStar,
+    JumpPoint
+  };
+
+  /// Usage counters, so the cache size can be tuned.
+  struct Stats
+  {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t nodesExpanded = 0;
+
+    /// Get the fraction of lookups that were hits, from 0 to 1.
+    double hitRate() const
+    {
+      uint64_t lookups = hits + misses;
+      return (lookups == 0) ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+    }
+  };
+
+  /// Constructor.
+  /// @param map            Map to find paths on.
+  /// @param cacheCapacity  Maximum number of paths to keep.
+  MapPathfinder(Map const& map, size_t cacheCapacity);
+
+  ~MapPathfinder();
+
+  /// Find a path from one tile to another.
+  /// @param mover      Entity that will follow the path. Tiles are checked
+  ///                   with MapTile::canBeTraversedBy.
+  /// @param start      Tile to start from.
+  /// @param goal       Tile to get to.
+  /// @param algorithm  Search algorithm to use.
+  /// @param path       Filled with the tiles to step onto, in order; the
+  ///                   start is not included, and the goal is last.
+  /// @return True if a path was found, false if the goal can't be reached.
+  bool findPath(EntityId mover, IntVec2 start, IntVec2 goal, Algorithm algorithm, std::vector<IntVec2>& path);
+
+  /// Discard all cached paths. Statistics are left intact.
+  void clearCache();
+
+  /// Get the maximum number of paths kept.
+  size_t cacheCapacity() const;
+
+  /// Set the maximum number of paths kept, evicting paths if needed.
+  void setCacheCapacity(size_t capacity);
+
+  /// Get the usage counters.
+  Stats const& stats() const;
+
+  /// Reset the usage counters.
+  void resetStats();
+
+protected:
+  /// Get whether the current mover can traverse a tile. Tiles out of bounds
+  /// never can be.
+  bool canTraverse(int x, int y);
+
+  /// Get whether a move from a tile in a direction is allowed.
+  bool canStep(int x, int y, int dx, int dy);
+
+  /// Start a new search for a mover, resetting what needs resetting.
+  void beginSearch(EntityId mover);
+
+  /// Offer a tile to the open list, if it improves on its known cost.
+  void relax(int index, int parent, int cost, IntVec2 goal);
+
+  /// Take the open tile with the lowest estimated total cost.
+  /// @return Index of the tile, or -1 if the open list is empty.
+  int popOpen();
+
+  /// Run an A* search. Results are left in the search nodes.
+  bool searchAStar(IntVec2 start, IntVec2 goal);
+
+  /// Run a jump point search. Results are left in the search nodes.
+  bool searchJumpPoint(IntVec2 start, IntVec2 goal);
+
+  /// Jump from a tile in a direction until reaching the goal, a tile with
+  /// a forced neighbor, or something in the way.
+  /// @return True if a jump point was found, in which case it is stored in
+  ///         `result`.
+  bool jump(IntVec2 from, IntVec2 direction, IntVec2 goal, IntVec2& result);
+
+  /// Walk the search nodes back from the goal to build the full path,
+  /// filling in the tiles jumped over along the way.
+  /// @param path   Filled with every tile from start to goal, inclusive.
+  void buildPath(IntVec2 start, IntVec2 goal, std::vector<IntVec2>& path) const;
+
+  /// Evict least recently used paths until the cache is within capacity.
+  void trim();
+
+  /// Get the index of a tile in the per-tile arrays.
+  int index(int x, int y) const;
+
+  /// Get the coordinates of a tile from its index.
+  IntVec2 coords(int index) const;
+
+private:
+  /// Key identifying a cached path.
+  struct Key
+  {
+    EntityId mover;
+    IntVec2 goal;
+    Algorithm algorithm;
+
+    bool operator==(Key const& other) const
+    {
+      return (mover == other.mover) &&
+        (goal == other.goal) &&
+        (algorithm == other.algorithm);
+    }
+  };
+
+  struct KeyHash
+  {
+    size_t operator()(Key const& key) const;
+  };
+
+  /// A cached path, and the passability version it was found under.
+  struct CachedPath
+  {
+    unsigned int passabilityVersion;
+
+    /// Every tile from the original start to the goal, inclusive.
+    std::vector<IntVec2> tiles;
+  };
+
+  using Entry = std::pair<Key, CachedPath>;
+  using EntryList = std::list<Entry>;
+
+  /// Search state for one tile. Nodes are only valid if their stamp matches
+  /// the current search, so nothing needs clearing between searches.
+  struct Node
+  {
+    uint32_t stamp = 0;
+    int cost = 0;
+    int parent = -1;
+    bool closed = false;
+  };
+
+  /// Map to find paths on.
+  Map const& m_map;
+
+  /// Traversability of each tile for the current mover: 0 if not checked
+  /// yet, 1 if traversable, 2 if not.
+  std::vector<uint8_t> m_traversable;
+
+  /// Mover and passability version the traversability memo belongs to.
+  EntityId m_traversableMover;
+  unsigned int m_traversableVersion = 0;
+  bool m_traversableValid = false;
+
+  /// Search state for each tile.
+  std::vector<Node> m_nodes;
+
+  /// Stamp of the current search.
+  uint32_t m_searchStamp = 0;
+
+  /// Open list, as a binary heap of (estimated total cost, tile index).
+  std::vector<std::pair<int, int>> m_open;
+
+  /// Maximum number of paths kept.
+  size_t m_capacity;
+
+  /// Cached paths, ordered from most to least recently used.
+  EntryList m_entries;
+
+  /// Index into the cached paths list.
+  std::unordered_map<Key, EntryList::iterator, KeyHash> m_index;
+
+  /// Usage counters.
+  Stats m_stats;
+};
@@ -0,0 +1,353 @@
+#include "stdafx.h"
+
+#include "map/MapRegionGraph.h"
+
+#include "map/Map.h"
+#include "map/MapFeature.h"
+#include "maptile/MapTile.h"
+
+namespace
+{
+  IntVec2 const Neighbors[] =
+  {
+    { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 }
+  };
+
+  /// Estimate of the cost of walking between two tiles, in the units used
+  /// by MapPathfinder.
+  int walkingCost(IntVec2 from, IntVec2 to)
+  {
+    int dx = std::abs(to.x - from.x);
+    int dy = std::abs(to.y - from.y);
+    return (10 * std::max(dx, dy)) + (4 * std::min(dx, dy));
+  }
+}
+
+int const MapRegionGraph::NoRegion = -1;
+
+MapRegionGraph::MapRegionGraph(Map const& map)
+  :
+  m_map{ map }
+{}
+
+MapRegionGraph::~MapRegionGraph()
+{}
+
+void MapRegionGraph::invalidate()
+{
+  m_dirty = true;
+}
+
+void MapRegionGraph::onTilePassabilityChanged(IntVec2 tile, bool passable)
+{
+  if (m_dirty || !m_map.isInBounds(tile)) return;
+
+  int& label = m_labels[index(tile)];
+
+  if (!passable)
+  {
+    // Taking a tile away might split a region in two; start over.
+    if (label != NoRegion) m_dirty = true;
+    return;
+  }
+
+  if (label != NoRegion) return;
+
+  // Join a neighboring region of the same kind if there is one, so digging
+  // a tunnel doesn't leave a trail of one-tile regions.
+  int feature = featureAt(tile);
+  for (auto& offset : Neighbors)
+  {
+    IntVec2 neighbor{ tile.x + offset.x, tile.y + offset.y };
+    if (!m_map.isInBounds(neighbor)) continue;
+
+    int neighborLabel = m_labels[index(neighbor)];
+    if (neighborLabel == NoRegion) continue;
+
+    auto& neighborRegion = m_regions[neighborLabel];
+    bool sameKind = (feature >= 0) ?
+      ((neighborRegion.kind == RegionKind::Feature) && (neighborRegion.feature == feature)) :
+      (neighborRegion.kind == RegionKind::Connector);
+    if (sameKind)
+    {
+      label = neighborLabel;
+      break;
+    }
+  }
+
+  if (label == NoRegion)
+  {
+    label = addRegion((feature >= 0) ? RegionKind::Feature : RegionKind::Connector, feature, tile);
+  }
+  ++m_regions[label].tileCount;
+
+  for (auto& offset : Neighbors)
+  {
+    IntVec2 neighbor{ tile.x + offset.x, tile.y + offset.y };
+    if (!m_map.isInBounds(neighbor)) continue;
+
+    int neighborLabel = m_labels[index(neighbor)];
+    if ((neighborLabel != NoRegion) && (neighborLabel != label))
+    {
+      addPortal(label, tile, neighborLabel, neighbor);
+    }
+  }
+}
+
+int MapRegionGraph::regionAt(IntVec2 tile)
+{
+  ensureBuilt();
+  return m_map.isInBounds(tile) ? m_labels[index(tile)] : NoRegion;
+}
+
+size_t MapRegionGraph::regionCount()
+{
+  ensureBuilt();
+  return m_regions.size();
+}
+
+MapRegionGraph::Region const& MapRegionGraph::region(int id)
+{
+  ensureBuilt();
+  return m_regions[id];
+}
+
+std::vector<MapRegionGraph::Portal> const& MapRegionGraph::portalsOf(int id)
+{
+  ensureBuilt();
+  return m_portals[id];
+}
+
+bool MapRegionGraph::areConnected(IntVec2 first, IntVec2 second)
+{
+  int firstRegion = regionAt(first);
+  int secondRegion = regionAt(second);
+  if ((firstRegion == NoRegion) || (secondRegion == NoRegion)) return false;
+
+  return findComponent(firstRegion) == findComponent(secondRegion);
+}
+
+bool MapRegionGraph::findWaypoints(IntVec2 from, IntVec2 to, std::vector<IntVec2>& waypoints)
+{
+  waypoints.clear();
+  if (!areConnected(from, to)) return false;
+
+  int startRegion = regionAt(from);
+  int goalRegion = regionAt(to);
+
+  // Dijkstra over the regions. Each region is entered once, at whichever
+  // portal gets there cheapest, and costs are measured from that tile.
+  size_t count = m_regions.size();
+  std::vector<int> cost(count, std::numeric_limits<int>::max());
+  std::vector<int> previous(count, NoRegion);
+  std::vector<IntVec2> entry(count);
+
+  using Entry = std::pair<int, int>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+
+  cost[startRegion] = 0;
+  entry[startRegion] = from;
+  open.push({ 0, startRegion });
+
+  while (!open.empty())
+  {
+    Entry current = open.top();
+    open.pop();
+
+    int region = current.second;
+    if (current.first != cost[region]) continue;
+    if (region == goalRegion) break;
+
+    for (auto& portal : m_portals[region])
+    {
+      int newCost = cost[region] + walkingCost(entry[region], portal.from) + walkingCost(portal.from, portal.to);
+      if (newCost < cost[portal.region])
+      {
+        cost[portal.region] = newCost;
+        previous[portal.region] = region;
+        entry[portal.region] = portal.to;
+        open.push({ newCost, portal.region });
+      }
+    }
+  }
+
+  for (int region = goalRegion; region != startRegion; region = previous[region])
+  {
+    waypoints.push_back(entry[region]);
+  }
+  std::reverse(waypoints.begin(), waypoints.end());
+  waypoints.push_back(to);
+
+  return true;
+}
+
+void MapRegionGraph::ensureBuilt()
+{
+  if (m_dirty) rebuild();
+}
+
+void MapRegionGraph::rebuild()
+{
+  IntVec2 const& size = m_map.getSize();
+  m_labels.assign(static_cast<size_t>(size.x) * size.y, NoRegion);
+  m_regions.clear();
+  m_portals.clear();
+  m_components.clear();
+
+  std::vector<uint8_t> passable(m_labels.size());
+  for (int y = 0; y < size.y; ++y)
+  {
+    for (int x = 0; x < size.x; ++x)
+    {
+      passable[index({ x, y })] = isPassable({ x, y }) ? 1 : 0;
+    }
+  }
+
+  // Label a 4-connected patch of unlabeled passable tiles, staying within
+  // a rectangle.
+  std::vector<IntVec2> open;
+  auto fill = [&](IntVec2 seed, int label, sf::IntRect const& bounds)
+  {
+    m_labels[index(seed)] = label;
+    open.push_back(seed);
+    while (!open.empty())
+    {
+      IntVec2 tile = open.back();
+      open.pop_back();
+      ++m_regions[label].tileCount;
+
+      for (auto& offset : Neighbors)
+      {
+        IntVec2 neighbor{ tile.x + offset.x, tile.y + offset.y };
+        if (!bounds.contains(neighbor.x, neighbor.y) || !m_map.isInBounds(neighbor)) continue;
+
+        size_t neighborIndex = index(neighbor);
+        if (passable[neighborIndex] && (m_labels[neighborIndex] == NoRegion))
+        {
+          m_labels[neighborIndex] = label;
+          open.push_back(neighbor);
+        }
+      }
+    }
+  };
+
+  // Features first. A feature whose tiles aren't all joined up inside it
+  // becomes more than one region, so every region is connected.
+  auto& features = m_map.getMapFeatures();
+  for (size_t feature = 0; feature < features.size(); ++feature)
+  {
+    sf::IntRect const& bounds = features[feature].getCoords();
+    for (int y = bounds.top; y < bounds.top + bounds.height; ++y)
+    {
+      for (int x = bounds.left; x < bounds.left + bounds.width; ++x)
+      {
+        if (!m_map.isInBounds({ x, y })) continue;
+
+        size_t tileIndex = index({ x, y });
+        if (passable[tileIndex] && (m_labels[tileIndex] == NoRegion))
+        {
+          fill({ x, y }, addRegion(RegionKind::Feature, static_cast<int>(feature), { x, y }), bounds);
+        }
+      }
+    }
+  }
+
+  // Then whatever is left over.
+  sf::IntRect const wholeMap{ 0, 0, size.x, size.y };
+  for (int y = 0; y < size.y; ++y)
+  {
+    for (int x = 0; x < size.x; ++x)
+    {
+      size_t tileIndex = index({ x, y });
+      if (passable[tileIndex] && (m_labels[tileIndex] == NoRegion))
+      {
+        fill({ x, y }, addRegion(RegionKind::Connector, -1, { x, y }), wholeMap);
+      }
+    }
+  }
+
+  // Find the portals, looking right and down from each tile.
+  for (int y = 0; y < size.y; ++y)
+  {
+    for (int x = 0; x < size.x; ++x)
+    {
+      int label = m_labels[index({ x, y })];
+      if (label == NoRegion) continue;
+
+      if (x + 1 < size.x)
+      {
+        int right = m_labels[index({ x + 1, y })];
+        if ((right != NoRegion) && (right != label)) addPortal(label, { x, y }, right, { x + 1, y });
+      }
+      if (y + 1 < size.y)
+      {
+        int below = m_labels[index({ x, y + 1 })];
+        if ((below != NoRegion) && (below != label)) addPortal(label, { x, y }, below, { x, y + 1 });
+      }
+    }
+  }
+
+  CLOG(TRACE, "Map") << "Built region graph for map " << m_map.getMapID() << ": "
+    << m_regions.size() << " regions";
+
+  m_dirty = false;
+}
+
+bool MapRegionGraph::isPassable(IntVec2 tile) const
+{
+  return m_map.getTile(tile).isPassable();
+}
+
+int MapRegionGraph::featureAt(IntVec2 tile) const
+{
+  auto& features = m_map.getMapFeatures();
+  for (size_t feature = 0; feature < features.size(); ++feature)
+  {
+    if (features[feature].getCoords().contains(tile.x, tile.y)) return static_cast<int>(feature);
+  }
+  return -1;
+}
+
+int MapRegionGraph::addRegion(RegionKind kind, int feature, IntVec2 anchor)
+{
+  int id = static_cast<int>(m_regions.size());
+  m_regions.push_back({ kind, feature, 0, anchor });
+  m_portals.emplace_back();
+  m_components.push_back(id);
+  return id;
+}
+
+void MapRegionGraph::addPortal(int first, IntVec2 firstTile, int second, IntVec2 secondTile)
+{
+  auto& firstPortals = m_portals[first];
+  bool known = std::any_of(firstPortals.begin(), firstPortals.end(),
+                           [second](Portal const& portal) { return portal.region == second; });
+  if (!known)
+  {
+    firstPortals.push_back({ second, firstTile, secondTile });
+    m_portals[second].push_back({ first, secondTile, firstTile });
+  }
+
+  int firstComponent = findComponent(first);
+  int secondComponent = findComponent(second);
+  if (firstComponent != secondComponent)
+  {
+    m_components[std::max(firstComponent, secondComponent)] = std::min(firstComponent, secondComponent);
+  }
+}
+
+int MapRegionGraph::findComponent(int id)
+{
+  while (m_components[id] != id)
+  {
+    // Path halving keeps the trees shallow.
+    m_components[id] = m_components[m_components[id]];
+    id = m_components[id];
+  }
+  return id;
+}
+
+size_t MapRegionGraph::index(IntVec2 tile) const
+{
+  return (static_cast<size_t>(tile.y) * m_map.getSize().x) + tile.x;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <vector>
+
+#include "types/Vec2.h"
+
+// Forward declarations
+class Map;
+
+/// Graph of the regions of a map and the portals between them.
+/// Each map feature (room, corridor, et cetera) becomes a region made up of
+/// the passable tiles inside it. Passable tiles outside every feature, such
+/// as doorways, corridor ends and anything dug out later, are grouped into
+/// small "connector" regions. Wherever two regions touch, there is a portal.
+///
+/// The graph is small compared to the map, so it can answer "can I get from
+/// here to there?" in constant time, and plan long routes as a handful of
+/// waypoints for MapPathfinder to fill in.
+///
+/// Moves are treated as 4-way here. A diagonal move that doesn't cut a
+/// corner always has a 4-way route alongside it, so this doesn't change what
+/// is connected to what.
+///
+/// Tiles becoming passable are folded into the graph as they happen. Tiles
+/// becoming impassable can split regions apart, so the graph is rebuilt
+/// from scratch the next time it is asked about.
+///
+/// The region label of each tile is held in a dense array, since labelling
+/// floods the whole map anyway. The graph, and so the array, is only
+/// created when something first asks about connectivity.
+class MapRegionGraph
+{
+public:
+  /// Region ID of a tile that isn't in any region.
+  static int const NoRegion;
+
+  /// Kinds of region.
+  enum class RegionKind
+  {
+    Feature,
+    Connector
+  };
+
+  /// One region of the map.
+  struct Region
+  {
+    RegionKind kind;
+
+    /// Index of the feature this region comes from, if it is a Feature.
+    int feature;
+
+    /// Number of tiles in the region.
+    int tileCount;
+
+    /// Some tile in the region.
+    IntVec2 anchor;
+  };
+
+  /// A place where two regions touch.
+  struct Portal
+  {
+    /// Region on the other side.
+    int region;
+
+    /// Tile on this side.
+    IntVec2 from;
+
+    /// Tile on the other side.
+    IntVec2 to;
+  };
+
+  MapRegionGraph(Map const& map);
+
+  ~MapRegionGraph();
+
+  /// Discard the graph, so it will be rebuilt the next time it is asked
+  /// about. Called when the map's features change.
+  void invalidate();
+
+  /// Update the graph for a tile that has become passable or impassable.
+  void onTilePassabilityChanged(IntVec2 tile, bool passable);
+
+  /// Get the region a tile is in.
+  /// @return The region ID, or NoRegion if the tile isn't passable.
+  int regionAt(IntVec2 tile);
+
+  /// Get the number of regions.
+  size_t regionCount();
+
+  /// Get a region by ID.
+  Region const& region(int id);
+
+  /// Get the portals out of a region, one per neighboring region.
+  std::vector<Portal> const& portalsOf(int id);
+
+  /// Get whether one tile can be reached from another.
+  bool areConnected(IntVec2 first, IntVec2 second);
+
+  /// Plan a route between two tiles at the region level.
+  /// @param from       Tile to start from.
+  /// @param to         Tile to get to.
+  /// @param waypoints  Filled with the portal tiles to pass through, in
+  ///                   order, followed by the destination.
+  /// @return True if the destination can be reached.
+  bool findWaypoints(IntVec2 from, IntVec2 to, std::vector<IntVec2>& waypoints);
+
+protected:
+  /// Rebuild the graph if it has been invalidated.
+  void ensureBuilt();
+
+  /// Rebuild the graph from the map's features and passability.
+  void rebuild();
+
+  /// Get whether a tile is passable.
+  bool isPassable(IntVec2 tile) const;
+
+  /// Get the index of the first feature containing a tile, or -1.
+  int featureAt(IntVec2 tile) const;
+
+  /// Add a new region and return its ID.
+  int addRegion(RegionKind kind, int feature, IntVec2 anchor);
+
+  /// Record that two regions touch at a pair of tiles, if they aren't known
+  /// to already, and join their connected components.
+  void addPortal(int first, IntVec2 firstTile, int second, IntVec2 secondTile);
+
+  /// Find the connected component a region belongs to.
+  int findComponent(int id);
+
+  /// Get the label index of a tile.
+  size_t index(IntVec2 tile) const;
+
+private:
+  /// Map the graph covers.
+  Map const& m_map;
+
+  /// Whether the graph needs rebuilding before it can be used.
+  bool m_dirty = true;
+
+  /// Region ID of each tile.
+  std::vector<int> m_labels;
+
+  /// Regions, by ID.
+  std::vector<Region> m_regions;
+
+  /// Portals out of each region, by region ID.
+  std::vector<std::vector<Portal>> m_portals;
+
+  /// Union-find parent of each region, for connectivity queries.
+  std::vector<int> m_components;
+};
@@ -29,41 +29,41 @@ MapRoom::MapRoom(Map& m, PropertyDictionary const& s, GeoVector vec)
   {
     sf::IntRect rect;
 
-    rect.width = the_RNG.pick_uniform(minWidth, maxWidth);
-    rect.height = the_RNG.pick_uniform(minHeight, maxHeight);
+    rect.width = getMap().rng().pick_uniform(minWidth, maxWidth);
+    rect.height = getMap().rng().pick_uniform(minHeight, maxHeight);
 
     if (direction == Direction::North)
     {
-      int offset = the_RNG.pick_uniform(0, rect.width - 1);
+      int offset = getMap().rng().pick_uniform(0, rect.width - 1);
 
       rect.top = starting_coords.y - rect.height;
       rect.left = starting_coords.x - offset;
     }
     else if (direction == Direction::South)
     {
-      int offset = the_RNG.pick_uniform(0, rect.width - 1);
+      int offset = getMap().rng().pick_uniform(0, rect.width - 1);
 
       rect.top = starting_coords.y + 1;
       rect.left = starting_coords.x - offset;
     }
     else if (direction == Direction::West)
     {
-      int offset = the_RNG.pick_uniform(0, rect.height - 1);
+      int offset = getMap().rng().pick_uniform(0, rect.height - 1);
 
       rect.top = starting_coords.y - offset;
       rect.left = starting_coords.x - rect.width;
     }
     else if (direction == Direction::East)
     {
-      int offset = the_RNG.pick_uniform(0, rect.height - 1);
+      int offset = getMap().rng().pick_uniform(0, rect.height - 1);
 
       rect.top = starting_coords.y - offset;
       rect.left = starting_coords.x + 1;
     }
     else if (direction == Direction::Self)
     {
-      rect.top = starting_coords.y - the_RNG.pick_uniform(0, rect.height - 1);
-      rect.left = starting_coords.x - the_RNG.pick_uniform(0, rect.width - 1);
+      rect.top = starting_coords.y - getMap().rng().pick_uniform(0, rect.height - 1);
+      rect.left = starting_coords.x - getMap().rng().pick_uniform(0, rect.width - 1);
     }
     else
     {
@@ -76,9 +76,8 @@ MapRoom::MapRoom(Map& m, PropertyDictionary const& s, GeoVector vec)
       bool okay = true;
 
       // Verify that box and surrounding area are solid walls.
-      okay = doesBoxPassCriterion({ rect.left - 1, rect.top - 1 },
-      { rect.left + rect.width, rect.top + rect.height },
-                                     [&](MapTile& tile) { return !tile.isPassable(); });
+      okay = isBoxSolid({ rect.left - 1, rect.top - 1 },
+                        { rect.left + rect.width, rect.top + rect.height });
 
       if (okay)
       {
@@ -108,7 +107,7 @@ MapRoom::MapRoom(Map& m, PropertyDictionary const& s, GeoVector vec)
 
         /// @todo Put either a door or an open area at the starting coords.
         ///       Right now we just make it an open area.
-        auto& startTile = getMap().getTile(starting_coords);
+        auto startTile = getMap().getTile(starting_coords);
         startTile.setTileType({ "Floor", floorMaterial }, { "OpenSpace" });
 
         return;
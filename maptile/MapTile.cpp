@@ -15,19 +15,17 @@
 #include "utilities/MathUtils.h"
 #include "utilities/RNGUtils.h"
 
-bool MapTile::initialized = false;
-
 MapTile::~MapTile()
 {}
 
 EntityId MapTile::getSpaceEntity() const
 {
-  return m_tileSpace;
+  return m_writableMap ? m_writableMap->tileData(m_coords).space : m_map->peekTileData(m_coords).space;
 }
 
 EntityId MapTile::getFloorEntity() const
 {
-  return m_tileFloor;
+  return m_writableMap ? m_writableMap->tileData(m_coords).floor : m_map->peekTileData(m_coords).floor;
 }
 
 EntityId MapTile::getDisplayEntity() const
@@ -38,70 +36,62 @@ EntityId MapTile::getDisplayEntity() const
 /// @todo Move this into SystemNarrator, doesn't belong here
 std::string MapTile::getDisplayName() const
 {
-  auto& spaceCategory = m_components.category.of(m_tileSpace);
-  auto& floorCategory = m_components.category.of(m_tileFloor);
+  // A read-only view of an untouched tile has no space entity yet, but the
+  // specs it will be created with are cached with the tile.
+  EntityId space = getSpaceEntity();
+  if (space == EntityId::Void)
+  {
+    return getTileSpaceSpecs().category;
+  }
 
   /// @todo FINISH ME
-  return spaceCategory;
+  return components().category.of(space);
 }
 
 void MapTile::setTileSpace(EntitySpecs specs)
 {
-  m_entities.morph(m_tileSpace, specs);
+  Map& map = writableMap();
+  map.m_gameState.entities().morph(getSpaceEntity(), specs);
+  map.tileData(m_coords).spaceSpecs = specsOf(getSpaceEntity()).id();
+  map.refreshTileFlags(m_coords);
+  map.invalidateOpacity();
 }
 
 void MapTile::setTileFloor(EntitySpecs specs)
 {
-  m_entities.morph(m_tileFloor, specs);
+  Map& map = writableMap();
+  map.m_gameState.entities().morph(getFloorEntity(), specs);
+  map.tileData(m_coords).floorSpecs = specsOf(getFloorEntity()).id();
 }
 
 void MapTile::setTileType(EntitySpecs floor, EntitySpecs space)
 {
-  setTileFloor(floor);
-  setTileSpace(space);
+  writableMap().fillTiles(m_coords, m_coords, floor, space);
 }
 
 EntitySpecs MapTile::getTileFloorSpecs() const
 {
-  auto& category = m_components.category.of(m_tileFloor);
-  auto material = m_components.material.existsFor(m_tileFloor) ?
-    m_components.material.of(m_tileFloor) : "";
-  return { category, material };
+  return EntitySpecs::fromId(getTileFloorSpecsId());
 }
 
 EntitySpecs MapTile::getTileSpaceSpecs() const
 {
-  auto& category = m_components.category.of(m_tileSpace);
-  auto material = m_components.material.existsFor(m_tileSpace) ?
-    m_components.material.of(m_tileSpace) : "";
-  return { category, material };
+  return EntitySpecs::fromId(getTileSpaceSpecsId());
 }
 
-bool MapTile::isPassable() const
+EntitySpecsId MapTile::getTileFloorSpecsId() const
 {
-  // If the tile space has no Physical component, it's passable.
-  if (!m_components.physical.existsFor(m_tileSpace))
-  {
-    return true;
-  }
-
-  auto& physical = m_components.physical.of(m_tileSpace);
-
-  // If the tile has a MatterState component and is non-solid, return true.
-  // A tile containing a liquid/gas/plasma/etc. is passable. It may kill you,
-  // but technically it's passable. ;)
-  if (m_components.matterState.existsFor(m_tileSpace))
-  {
-    auto& matterState = m_components.matterState.of(m_tileSpace);
+  return m_map->peekTileData(m_coords).floorSpecs;
+}
 
-    if (matterState.isFluid())
-    {
-      return true;
-    }
-  }
+EntitySpecsId MapTile::getTileSpaceSpecsId() const
+{
+  return m_map->peekTileData(m_coords).spaceSpecs;
+}
 
-  // Return whether the volume of the tile fills the entire tile.
-  return (physical.volume() < Components::ComponentPhysical::VOLUME_MAX_CC);
+bool MapTile::isPassable() const
+{
+  return (m_map->peekTileData(m_coords).flags & Map::TileFlags::Passable) != 0;
 }
 
 /// @todo: Implement this to cover different entity types.
@@ -118,18 +108,20 @@ IntVec2 const& MapTile::getCoords() const
 
 MapID MapTile::map() const
 {
-  return m_mapID;
+  return m_map->getMapID();
 }
 
 Color MapTile::getOpacity() const
 {
   // If the tile space has no opacity data, opacity is max (i.e. totally opaque).
-  if (!m_components.appearance.existsFor(m_tileSpace))
+  auto& components = this->components();
+  EntityId space = getSpaceEntity();
+  if (!components.appearance.existsFor(space))
   {
     return Color::White;
   }
 
-  auto& appearance = m_components.appearance.of(m_tileSpace);
+  auto& appearance = components.appearance.of(space);
   return appearance.opacity();
 }
 
@@ -137,14 +129,14 @@ bool MapTile::isTotallyOpaque() const
 {
   /// @todo Check the tile's inventory to see if there's anything huge enough
   ///       to block the view of stuff behind it.
-  return (getOpacity() == Color::White);
+  return (m_map->peekTileData(m_coords).flags & Map::TileFlags::Opaque) != 0;
 }
 
 bool MapTile::isTotallyTransparent() const
 {
   /// @todo Check the tile's inventory to see if there's anything huge enough
   ///       to block the view of stuff behind it.
-  return (getOpacity() == Color::Black);
+  return (m_map->peekTileData(m_coords).flags & Map::TileFlags::Transparent) != 0;
 }
 
 RealVec2 MapTile::getPixelCoords(IntVec2 tile)
@@ -158,33 +150,43 @@ RealVec2 MapTile::getPixelCoords(IntVec2 tile)
 
 // === PROTECTED METHODS ======================================================
 
-MapTile::MapTile(IntVec2 coords,
-                 MapID mapID,
-                 EntityFactory& entities,
-                 Components::ComponentManager& components,
-                 std::string floorCategory,
-                 std::string spaceCategory)
+MapTile::MapTile(Map& map, IntVec2 coords)
+  :
+  m_map{ &map },
+  m_writableMap{ &map },
+  m_coords{ coords }
+{}
+
+MapTile::MapTile(Map const& map, IntVec2 coords)
   :
-  Object({}),
-  m_coords{ coords },
-  m_mapID{ mapID },
-  m_entities{ entities },
-  m_components{ components }
+  m_map{ &map },
+  m_writableMap{ nullptr },
+  m_coords{ coords }
+{}
+
+Map& MapTile::writableMap() const
 {
-  if (!initialized)
-  {
-    // TODO: any static class initialization that must be performed
-    initialized = true;
-  }
+  Assert("MapTile", m_writableMap != nullptr, "Attempted to change tile " << m_coords << " through a read-only view");
+  return *m_writableMap;
+}
+
+Components::ComponentManager& MapTile::components() const
+{
+  return m_map->m_gameState.components();
+}
 
-  // Tile entities are created here.
-  m_tileSpace = entities.createTileEntity(this, floorCategory.empty() ? "Pit" : floorCategory);
-  m_tileFloor = entities.createTileEntity(this, spaceCategory.empty() ? "OpenSpace" : spaceCategory);
+EntitySpecs MapTile::specsOf(EntityId entity) const
+{
+  auto& components = this->components();
+  auto& category = components.category.of(entity);
+  auto material = components.material.existsFor(entity) ?
+    components.material.of(entity) : "";
+  return{ category, material };
 }
 
-MapTile const& MapTile::getAdjacentTile(Direction direction) const
+MapTile MapTile::getAdjacentTile(Direction direction) const
 {
   IntVec2 coords = getCoords();
   IntVec2 adjacent_coords = coords + (IntVec2)direction;
-  return MAPS.get(m_mapID).getTile(adjacent_coords);
+  return m_writableMap ? m_writableMap->getTile(adjacent_coords) : m_map->getTile(adjacent_coords);
 }
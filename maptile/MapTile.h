@@ -7,7 +7,6 @@
 #include "types/EntitySpecs.h"
 #include "types/LightInfluence.h"
 #include "map/MapFactory.h"
-#include "Object.h"
 
 // Forward declarations
 namespace Components
@@ -15,17 +14,23 @@ namespace Components
   class ComponentManager;
 }
 class EntityFactory;
-
-/// Class representing one tile of the map.
+class Map;
+
+/// Lightweight view of one tile of a map.
+/// Tile data lives in chunks owned by the Map; a MapTile is just the map and
+/// coordinates of a tile, so it is cheap to create and copy. Queries that
+/// only need cached tile data don't cause the tile's chunk to be created.
+///
+/// A view got from a const Map is read-only. It never creates the tile's
+/// chunk: its entity getters return Void for tiles that haven't been
+/// touched yet, and changing the tile through it is an error.
 /// @todo Add notifyObservers calls where needed
 class MapTile
-  :
-  public Object
 {
   friend class Map;
 
 public:
-  virtual ~MapTile();
+  ~MapTile();
 
   /// Get the tile's space entity.
   EntityId getSpaceEntity() const;
@@ -72,6 +77,12 @@ public:
   /// @return Category/material of the tile's space entity.
   EntitySpecs getTileSpaceSpecs() const;
 
+  /// Gets the current tile floor specs as an interned ID.
+  EntitySpecsId getTileFloorSpecsId() const;
+
+  /// Gets the current tile space specs as an interned ID.
+  EntitySpecsId getTileSpaceSpecsId() const;
+
   /// Returns whether a tile is empty space, e.g. no wall in the way.
   bool isPassable() const;
 
@@ -96,38 +107,33 @@ public:
   /// Get the coordinates associated with a tile.
   static RealVec2 getPixelCoords(IntVec2 tile);
 
-  /// Get a reference to an adjacent tile.
-  MapTile const& getAdjacentTile(Direction direction) const;
+  /// Get an adjacent tile.
+  MapTile getAdjacentTile(Direction direction) const;
 
 protected:
-  /// Constructor, callable only by Map class.
-  MapTile(IntVec2 coords,
-          MapID mapID,
-          EntityFactory& entities,
-          Components::ComponentManager& components,
-          std::string floorCategory = "",
-          std::string spaceCategory = "");
-
-private:
-  static bool initialized;
+  /// Constructors, callable only by Map class.
+  MapTile(Map& map, IntVec2 coords);
+  MapTile(Map const& map, IntVec2 coords);
 
-  /// This MapTile's coordinates on the map.
-  IntVec2 m_coords;
+  /// Get the map, for changing the tile.
+  /// Asserts if this is a read-only view.
+  Map& writableMap() const;
 
-  /// The ID of the Map this MapTile belongs to.
-  MapID m_mapID;
+  /// Get the components of the game the map belongs to.
+  Components::ComponentManager& components() const;
 
-  /// Reference to the EntityFactory.
-  EntityFactory& m_entities;
+  /// Get the specs of one of the tile's entities from its components.
+  EntitySpecs specsOf(EntityId entity) const;
 
-  /// Reference to the ComponentManager.
-  Components::ComponentManager& m_components;
+private:
+  /// The Map this MapTile belongs to.
+  Map const* m_map;
 
-  /// Entity representing the tile's floor.
-  EntityId m_tileFloor;
+  /// The same Map, if the view can change it; null if it is read-only.
+  Map* m_writableMap;
 
-  /// Entity representing the tile's contents.
-  EntityId m_tileSpace;
+  /// This MapTile's coordinates on the map.
+  IntVec2 m_coords;
 };
 
 #endif // MAPTILE_H
@@ -1,6 +1,18 @@
 -- Definition of special functions for the Marcher object type.
 
-function Marcher_process(id)
-    print("DEBUG: Marcher_process() called for object " .. id .. ".")
-    return true, LuaType.Boolean
-end
\ No newline at end of file
+-- Marchers walk this many steps right, then the same number back left.
+local MARCH_LENGTH = 4
+
+-- Each marcher marches in a coroutine of its own; see Entity.lua. Its place
+-- in the march is just where the coroutine is, so there is nothing to clean
+-- up when it is destroyed. (After loading a game, it starts over.)
+function Marcher_process_coroutine(id)
+    while true do
+        for _ = 1, MARCH_LENGTH do
+            coroutine.yield({ action = "MOVE", direction = { 1, 0, 0 } })
+        end
+        for _ = 1, MARCH_LENGTH do
+            coroutine.yield({ action = "MOVE", direction = { -1, 0, 0 } })
+        end
+    end
+end
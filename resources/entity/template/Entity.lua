@@ -30,6 +30,24 @@ function Entity_process()
     return true, LuaType.Boolean
 end
 
+-- An entity type can define TYPE_process_batch(ids) instead of TYPE_process,
+-- to run the AI of all idle entities of that type in one call. It returns an
+-- array with an entry per ID: nil if there is nothing to do, or an action to
+-- queue, e.g. { action = "MOVE", direction = { 1, 0, 0 } }.
+-- (Not defined here, as it would take precedence over TYPE_process.)
+--
+-- Or it can define TYPE_process_coroutine(id), which takes precedence over
+-- both. It is run as a coroutine for each entity, and yields actions in the
+-- same form; it is resumed from where it left off the next time the entity
+-- is idle, so plans and state can be kept in locals. Once it returns, it
+-- starts over from the top. For example:
+--
+--   function Guard_process_coroutine(id)
+--       for _, step in ipairs(patrol_route) do
+--           coroutine.yield({ action = "MOVE", direction = step })
+--       end
+--   end
+
 function Entity_get_tile_offset_DISABLED(id, frame)
     -- If entity's hit points are <= 0, show the "dead" tile.
     local hp = get_hp(id);
@@ -0,0 +1,90 @@
+-- Views of hot components over their native storage, through the LuaJIT FFI.
+-- Run once the component manager is set up; see lua/LuaFFI.h.
+--
+-- Globals used:
+--		component_view_layouts - FFI declarations of the views, by name
+--
+-- Globals defined:
+--		ComponentView - table of functions, one per view, each taking an
+--		                entity ID and returning a view of that entity's
+--		                component, or nil if it doesn't have one
+
+local ffi = require("ffi")
+local C = ffi.C
+
+local layouts = component_view_layouts
+component_view_layouts = nil
+
+-- FFI declarations are global to the Lua state and can't be repeated, so
+-- only make them the first time through.
+if not pcall(ffi.typeof, "metahack_health") then
+    ffi.cdef[[
+        void* metahack_component_of(uint32_t kind, uint64_t entity);
+        const uint32_t* metahack_component_epoch(uint32_t kind);
+    ]]
+
+    for _, layout in pairs(layouts) do
+        ffi.cdef(layout.declaration)
+    end
+end
+
+ComponentView = {}
+
+for name, layout in pairs(layouts) do
+    local kind = layout.kind
+    local pointer = ffi.typeof(layout.ctype .. "*")
+    local epoch = C.metahack_component_epoch(kind)
+
+    -- Look the component up again if any component of this kind has been
+    -- removed since the view last did.
+    local function deref(view)
+        if view._epoch ~= epoch[0] then
+            view._data = ffi.cast(pointer, C.metahack_component_of(kind, view._entity))
+            view._epoch = epoch[0]
+        end
+        if view._data == nil then
+            error("entity " .. tonumber(view._entity) .. " no longer has a " .. name .. " component", 3)
+        end
+        return view._data
+    end
+
+    -- Methods of the view, for things the fields alone can't answer.
+    local methods = {}
+
+    if name == "position" then
+        -- Coordinates on the map, following the chain of parents up to the
+        -- entity lying on a tile. Returns nil if something in the chain has
+        -- no position.
+        function methods.coords(view)
+            local data = deref(view)
+            while data.parent ~= 0 do
+                data = ffi.cast(pointer, C.metahack_component_of(kind, data.parent))
+                if data == nil then
+                    return nil
+                end
+            end
+            return data._x, data._y
+        end
+    end
+
+    local view_type = ffi.metatype(ffi.typeof("struct { uint64_t _entity; uint32_t _epoch; $ _data; }", pointer), {
+        __index = function(view, key)
+            local method = methods[key]
+            if method ~= nil then
+                return method
+            end
+            return deref(view)[key]
+        end,
+        __newindex = function(view, key, value)
+            deref(view)[key] = value
+        end
+    })
+
+    ComponentView[name] = function(id)
+        local data = ffi.cast(pointer, C.metahack_component_of(kind, id))
+        if data == nil then
+            return nil
+        end
+        return view_type(id, epoch[0], data)
+    end
+end
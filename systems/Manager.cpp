@@ -3,6 +3,7 @@
 #include "systems/Manager.h"
 
 #include "components/ComponentManager.h"
+#include "systems/SystemArchivist.h"
 #include "systems/SystemChoreographer.h"
 #include "systems/SystemDirector.h"
 #include "systems/SystemEditor.h"
@@ -44,6 +45,10 @@ namespace Systems
     m_narrator.reset(NEW Narrator(components));
 
     // Initialize the remaining systems.
+    m_archivist.reset(NEW Archivist(m_gameState,
+                                    components.position,
+                                    components.senseSight));
+
     m_choreographer.reset(NEW Choreographer(components.globals));
 
     m_director.reset(NEW Director(m_gameState, *this));
@@ -83,6 +88,7 @@ namespace Systems
     m_geometry->subscribeTo(m_janitor.get(), Janitor::EventEntityMarkedForDeletion::id);
 
     m_director->subscribeTo(m_geometry.get(), Geometry::EventEntityChangedMaps::id);
+    m_director->subscribeTo(m_janitor.get(), Janitor::EventEntityMarkedForDeletion::id);
 
     m_lighting->subscribeTo(m_geometry.get(), Geometry::EventEntityChangedMaps::id);
     m_lighting->subscribeTo(m_geometry.get(), Geometry::EventEntityMoved::id);
@@ -119,6 +125,7 @@ namespace Systems
 
     m_grimReaper->doCycleUpdate();
     m_janitor->doCycleUpdate();
+    m_archivist->doCycleUpdate();
     m_timekeeper->doCycleUpdate();
   }
 
@@ -10,6 +10,7 @@ namespace Systems
 {
 
   // Forward declarations
+  class Archivist;
   class Choreographer;
   class Director;
   class Editor;
@@ -38,6 +39,7 @@ namespace Systems
     void runOneCycle();
 
     // Get references to systems.
+    Archivist& archivist() { return *m_archivist; }
     Choreographer& choreographer() { return *m_choreographer; }
     Director& director() { return *m_director; }
     Editor& editor() { return *m_editor; }
@@ -57,6 +59,7 @@ namespace Systems
 
   private:
     // System instances.
+    std::unique_ptr<Archivist> m_archivist;
     std::unique_ptr<Choreographer> m_choreographer;
     std::unique_ptr<Director> m_director;
     std::unique_ptr<Editor> m_editor;
@@ -0,0 +1,63 @@
+#include "stdafx.h"
+
+#include "systems/SystemArchivist.h"
+
+#include "components/ComponentPosition.h"
+#include "components/ComponentSenseSight.h"
+#include "config/Settings.h"
+#include "game/GameState.h"
+#include "map/Map.h"
+#include "map/MapFactory.h"
+
+namespace Systems
+{
+
+  Archivist::Archivist(GameState& gameState,
+                       Components::ComponentMapConcrete<Components::ComponentPosition> const& position,
+                       Components::ComponentMapConcrete<Components::ComponentSenseSight> const& senseSight) :
+    CRTP<Archivist>({}),
+    m_gameState{ gameState },
+    m_position{ position },
+    m_senseSight{ senseSight },
+    m_budgetBytes{ Config::settings().get("map-tile-memory-budget-kb").get<size_t>() * 1024 },
+    m_keepRadius{ Config::settings().get("map-tile-keep-radius").get<int>() },
+    m_chunksPagedOut{ 0 }
+  {}
+
+  Archivist::~Archivist()
+  {
+    CLOG(DEBUG, "Archivist") << m_chunksPagedOut << " map chunks paged out this session";
+  }
+
+  void Archivist::doCycleUpdate()
+  {
+    if (m_budgetBytes == 0) return;
+
+    // Anything that can see is an actor worth keeping the map around.
+    std::unordered_map<MapID, std::vector<IntVec2>> activeTiles;
+    for (auto& pair : m_senseSight.data())
+    {
+      if (!m_position.existsFor(pair.first)) continue;
+      auto& position = m_position.of(pair.first);
+      if (position.isInsideAnotherEntity() || !m_gameState.maps().exists(position.map())) continue;
+      activeTiles[position.map()].push_back(position.coords());
+    }
+
+    m_gameState.maps().forEach([&](Map& map)
+    {
+      auto iter = activeTiles.find(map.getMapID());
+      static std::vector<IntVec2> const noTiles;
+      auto& tiles = (iter != activeTiles.end()) ? iter->second : noTiles;
+      m_chunksPagedOut += map.pageOutColdTileChunks(tiles, m_keepRadius, m_budgetBytes);
+    });
+  }
+
+  void Archivist::setMap_V(MapID newMap)
+  {}
+
+  bool Archivist::onEvent(Event const & event)
+  {
+    return false;
+  }
+
+} // end namespace Systems
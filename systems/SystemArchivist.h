@@ -0,0 +1,57 @@
+#pragma once
+
+#include "components/ComponentMap.h"
+#include "entity/EntityId.h"
+#include "systems/CRTP.h"
+
+// Forward declarations
+namespace Components
+{
+  class ComponentPosition;
+  class ComponentSenseSight;
+}
+class GameState;
+
+namespace Systems
+{
+
+  /// System that keeps the memory used by maps in check, by paging out map
+  /// chunks that are far from any actor and haven't been seen lately.
+  /// Off by default; set "map-tile-memory-budget-kb" to turn it on.
+  class Archivist : public CRTP<Archivist>
+  {
+  public:
+    Archivist(GameState& gameState,
+              Components::ComponentMapConcrete<Components::ComponentPosition> const& position,
+              Components::ComponentMapConcrete<Components::ComponentSenseSight> const& senseSight);
+
+    virtual ~Archivist();
+
+    /// Page out whatever needs paging out.
+    virtual void doCycleUpdate() override;
+
+  protected:
+    virtual void setMap_V(MapID newMap) override;
+
+    virtual bool onEvent(Event const& event) override;
+
+  private:
+    GameState& m_gameState;
+
+    // Components used by this system.
+    Components::ComponentMapConcrete<Components::ComponentPosition> const& m_position;
+    Components::ComponentMapConcrete<Components::ComponentSenseSight> const& m_senseSight;
+
+    /// Memory budget for each map's resident tile data, in bytes, or 0 to
+    /// not page anything out. Paged-out chunks are read back synchronously,
+    /// so paging is off unless asked for.
+    size_t m_budgetBytes;
+
+    /// Radius around each actor that is always kept resident, in tiles.
+    int m_keepRadius;
+
+    /// Total number of chunks paged out.
+    size_t m_chunksPagedOut;
+  };
+
+} // end namespace Systems
@@ -8,10 +8,17 @@
 #include "components/ComponentPosition.h"
 #include "game/GameState.h"
 #include "lua/LuaObject.h"
+#include "map/DijkstraMap.h"
 #include "map/Map.h"
-#include "maptile/MapTile.h"
 #include "systems/Manager.h"
 #include "systems/SystemGeometry.h"
+#include "systems/SystemJanitor.h"
+
+namespace
+{
+  /// Suffix of the Lua functions that run entities' AI.
+  Atom const Process{ "process" };
+}
 
 namespace Systems
 {
@@ -28,6 +35,7 @@ namespace Systems
 
   void Director::doCycleUpdate()
   {
+    updatePlayerDijkstraMap();
     processMap(map());
   }
 
@@ -56,20 +64,40 @@ namespace Systems
     queueEntityAction(id, std::move(action));
   }
 
+  void Director::updatePlayerDijkstraMap()
+  {
+    auto& position = m_gameState.components().position;
+    EntityId player = m_gameState.components().globals.player();
+    if (!position.existsFor(player)) return;
+
+    auto& playerPosition = position.of(player);
+    if (playerPosition.map() != map()) return;
+
+    // The field is only recalculated if the player has actually moved.
+    m_gameState.maps().get(map()).dijkstraMap("player").setGoals({ playerPosition.coords() });
+  }
+
   void Director::processMap(MapID mapID)
   {
-    auto& gameMap = m_gameState.maps().get(mapID);
-    auto mapSize = gameMap.getSize();
+    auto mapSize = m_gameState.maps().get(mapID).getSize();
 
-    for (int y = 0; y < mapSize.y; ++y)
+    for (auto& category : m_idleCategories)
     {
-      for (int x = 0; x < mapSize.x; ++x)
-      {
-        EntityId contents = gameMap.getTile({ x, y }).getSpaceEntity();
-        processEntityAndChildren(contents);
-      }
+      m_idleActors[category].clear();
+    }
+    m_idleCategories.clear();
+
+    // Take the entities on the map from the spatial index rather than from
+    // the tiles, so tile chunks nothing has touched are never created (or
+    // paged back in) just to find out they are empty.
+    auto entities = m_systems.geometry().entitiesInRect(mapID, { 0, 0 }, { mapSize.x - 1, mapSize.y - 1 });
+    for (auto entity : entities)
+    {
+      processEntityAndChildren(entity);
     }
 
+    processIdleActors();
+
     //notifyObservers(Event::Updated);
   }
 
@@ -157,15 +185,74 @@ namespace Systems
       // Otherwise if there are no pending actions...
     else
     {
-      // If entity is not the player, call the Lua process function on this 
-      // Entity, which runs the AI and may queue new actions.
+      // If entity is not the player, set it aside so the Lua process
+      // function, which runs the AI and may queue new actions, can be called
+      // on it along with the rest of its category.
       if (m_gameState.components().globals.player() != entityID)
       {
-        (void)m_gameState.lua().callEntityFunction("process", entityID, {}, true);
+        Atom category = m_gameState.components().category[entityID];
+        auto& actors = m_idleActors[category];
+        if (actors.empty()) m_idleCategories.push_back(category);
+        actors.push_back(entityID);
       }
     }
   }
 
+  void Director::processIdleActors()
+  {
+    auto& lua = m_gameState.lua();
+    LuaMemory::Scope scope(lua.memory(), LuaMemory::Phase::AI);
+
+    for (auto& category : m_idleCategories)
+    {
+      auto& actors = m_idleActors[category];
+
+      // Coroutine AI takes precedence over batched AI.
+      std::vector<json> actions;
+      if (!lua.resumeEntityCoroutines(Process, category, actors, actions))
+      {
+        actions = lua.callEntityBatchFunction(Process, category, actors);
+      }
+
+      for (size_t index = 0; index < actors.size(); ++index)
+      {
+        if (!actions[index].is_null()) queueBatchAction(actors[index], actions[index]);
+      }
+    }
+  }
+
+  void Director::queueBatchAction(EntityId id, json const& action)
+  {
+    // The entity may have been destroyed by the AI of another.
+    if (!m_gameState.components().activity.existsFor(id)) return;
+
+    std::string type = action["action"].get<std::string>();
+    if (!Actions::Action::exists(type))
+    {
+      CLOG(ERROR, "Lua") << "Lua script requested queue of non-existent Action \"" << type << "\"";
+      return;
+    }
+
+    std::unique_ptr<Actions::Action> newAction = Actions::Action::create(type, id);
+
+    if (action.count("target") != 0)
+    {
+      newAction->setTarget(action["target"].get<EntityId>());
+    }
+    else if (action.count("direction") != 0)
+    {
+      json const& direction = action["direction"];
+      newAction->setTarget(Direction(direction[0].get<int>(), direction[1].get<int>(), direction[2].get<int>()));
+    }
+
+    if (action.count("objects") != 0)
+    {
+      newAction->setObjects(action["objects"].get<std::vector<EntityId>>());
+    }
+
+    queueEntityAction(id, std::move(newAction));
+  }
+
   void Director::setMap_V(MapID newMap)
   {}
 
@@ -178,6 +265,11 @@ namespace Systems
       MapID newMap = m_gameState.components().position.of(castEvent.entity).map();
       setMap(newMap);
     }
+    else if (id == Janitor::EventEntityMarkedForDeletion::id)
+    {
+      auto& castEvent = static_cast<Janitor::EventEntityMarkedForDeletion const&>(event);
+      m_gameState.lua().releaseEntityCoroutine(castEvent.m_entity);
+    }
 
     return false;
   }
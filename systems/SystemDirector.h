@@ -48,12 +48,25 @@ namespace Systems
     void queueEntityAction(EntityId id, Actions::Action* pAction);
 
   protected:
+    /// Point the "player" Dijkstra map of the current map at the player, so
+    /// that entities chasing or fleeing the player can share it.
+    void updatePlayerDijkstraMap();
+
     void processMap(MapID mapID);
 
     void processEntityAndChildren(EntityId entityID);
 
     void processEntity(EntityId entityID);
 
+    /// Run the AI of the idle actors gathered while processing the map, with
+    /// one Lua call per category rather than one per actor.
+    void processIdleActors();
+
+    /// Queue an action returned by a batched AI call.
+    /// @param id     The ID of the entity performing the action.
+    /// @param action The action, as returned by Lua::callEntityBatchFunction.
+    void queueBatchAction(EntityId id, json const& action);
+
     virtual void setMap_V(MapID newMap) override;
 
     virtual bool onEvent(Event const& event) override;
@@ -62,6 +75,12 @@ namespace Systems
     // Components used by this system.
     GameState& m_gameState;
     Manager& m_systems;
+
+    /// Idle non-player actors found while processing the map, by category.
+    std::unordered_map<Atom, std::vector<EntityId>> m_idleActors;
+
+    /// Categories in m_idleActors, in the order they were first seen.
+    std::vector<Atom> m_idleCategories;
   };
 
 } // end namespace Systems
@@ -67,6 +67,7 @@ namespace Systems
 
         // Set the location to the new location.
         m_position[entity].set(newLocation);
+        updateSpatialIndex(entity);
 
         MapID newMapID = position.map();
         if (oldMapID != newMapID)
@@ -237,6 +238,102 @@ namespace Systems
     return Math::adjacent(firstPosition.coords(), secondPosition.coords());
   }
 
+  std::vector<EntityId> Geometry::entitiesInRect(MapID map, IntVec2 upperLeft, IntVec2 lowerRight, EntityFilter filter)
+  {
+    std::vector<EntityId> result;
+    auto grid = spatialIndexFor(map);
+    if (grid == nullptr) return result;
+
+    grid->forEachInRect(upperLeft, lowerRight, [&](EntityId entity, IntVec2)
+    {
+      if (!filter || filter(entity)) result.push_back(entity);
+    });
+
+    return result;
+  }
+
+  std::vector<EntityId> Geometry::entitiesInRadius(MapID map, IntVec2 center, int radius, EntityFilter filter)
+  {
+    std::vector<EntityId> result;
+    auto grid = spatialIndexFor(map);
+    if (grid == nullptr) return result;
+
+    grid->forEachInRadius(center, radius, [&](EntityId entity, IntVec2)
+    {
+      if (!filter || filter(entity)) result.push_back(entity);
+    });
+
+    return result;
+  }
+
+  void Geometry::updateSpatialIndex(EntityId entity)
+  {
+    if (!m_spatialIndexBuilt) return;
+
+    auto& position = m_position.of(entity);
+    auto parent = position.parent();
+
+    // Only entities directly on a tile (inside the tile's space entity) are
+    // indexed. Anything further in moves along with its container without
+    // any events being sent, so it can't be kept up to date here.
+    if ((parent == EntityId::Void) ||
+        !m_position.existsFor(parent) ||
+        (m_position.of(parent).parent() != EntityId::Void))
+    {
+      removeFromSpatialIndex(entity);
+      return;
+    }
+
+    MapID map = position.map();
+    auto iter = m_spatialIndexMap.find(entity);
+    if ((iter != m_spatialIndexMap.end()) && (iter->second != map))
+    {
+      removeFromSpatialIndex(entity);
+    }
+
+    m_spatialIndex[map].insert(entity, position.coords());
+    m_spatialIndexMap[entity] = map;
+  }
+
+  void Geometry::removeFromSpatialIndex(EntityId entity)
+  {
+    auto iter = m_spatialIndexMap.find(entity);
+    if (iter == m_spatialIndexMap.end()) return;
+
+    auto gridIter = m_spatialIndex.find(iter->second);
+    if (gridIter != m_spatialIndex.end())
+    {
+      gridIter->second.remove(entity);
+      if (gridIter->second.size() == 0) m_spatialIndex.erase(gridIter);
+    }
+
+    m_spatialIndexMap.erase(iter);
+  }
+
+  void Geometry::buildSpatialIndexIfNeeded()
+  {
+    if (m_spatialIndexBuilt) return;
+
+    CLOG(TRACE, "Geometry") << "Building spatial index";
+
+    m_spatialIndex.clear();
+    m_spatialIndexMap.clear();
+    m_spatialIndexBuilt = true;
+
+    for (auto& positionPair : m_position.data())
+    {
+      updateSpatialIndex(positionPair.first);
+    }
+  }
+
+  SpatialGrid const* Geometry::spatialIndexFor(MapID map)
+  {
+    buildSpatialIndexIfNeeded();
+
+    auto iter = m_spatialIndex.find(map);
+    return (iter != m_spatialIndex.end()) ? &(iter->second) : nullptr;
+  }
+
   void Geometry::setMap_V(MapID newMap)
   {}
 
@@ -261,6 +358,8 @@ namespace Systems
       {
         m_inventory[old_location].remove(entity);
       }
+
+      removeFromSpatialIndex(entity);
     }
 
     return false;
@@ -4,6 +4,7 @@
 #include "components/ComponentPosition.h"
 #include "entity/EntityId.h"
 #include "systems/CRTP.h"
+#include "types/SpatialGrid.h"
 
 // Forward declarations
 namespace Components
@@ -61,6 +62,10 @@ namespace Systems
       }
     };
 
+    /// Predicate used to narrow down the results of a spatial query.
+    /// An empty filter accepts every entity.
+    using EntityFilter = std::function<bool(EntityId)>;
+
     Geometry(Systems::Janitor& janitor,
              Systems::Narrator& narrator,
              Components::ComponentGlobals const& globals,
@@ -98,18 +103,50 @@ namespace Systems
     /// Return whether these two entities are adjacent to each other.
     bool areAdjacent(EntityId first, EntityId second) const;
 
+    /// Get the entities directly on the tiles of a rectangle, inclusive.
+    /// Entities inside other entities (e.g. in a backpack) are not included.
+    std::vector<EntityId> entitiesInRect(MapID map, IntVec2 upperLeft, IntVec2 lowerRight,
+                                         EntityFilter filter = EntityFilter());
+
+    /// Get the entities directly on the tiles within a radius of a point.
+    std::vector<EntityId> entitiesInRadius(MapID map, IntVec2 center, int radius,
+                                           EntityFilter filter = EntityFilter());
+
+    /// Bring an entity's entry in the spatial index up to date, for an
+    /// entity whose position was set without moving it (e.g. a clone).
+    void updateSpatialIndex(EntityId entity);
+
   protected:
     virtual void setMap_V(MapID newMap) override;
 
     virtual bool onEvent(Event const& event) override;
 
   private:
+    /// Take an entity out of the spatial index.
+    void removeFromSpatialIndex(EntityId entity);
+
+    /// Fill the spatial index from the position components, if that hasn't
+    /// been done yet (e.g. after a game is loaded).
+    void buildSpatialIndexIfNeeded();
+
+    /// Get the spatial index for a map, or nullptr if nothing is on it.
+    SpatialGrid const* spatialIndexFor(MapID map);
+
     // Components used by this system.
     Systems::Janitor& m_janitor;
     Systems::Narrator& m_narrator;
     Components::ComponentGlobals const& m_globals;
     Components::ComponentMapConcrete<Components::ComponentInventory>& m_inventory;
     Components::ComponentMapConcrete<Components::ComponentPosition>& m_position;
+
+    /// Spatial index of the entities directly on map tiles, one per map.
+    std::unordered_map<MapID, SpatialGrid> m_spatialIndex;
+
+    /// Map each indexed entity is filed under.
+    std::unordered_map<EntityId, MapID> m_spatialIndexMap;
+
+    /// Whether the spatial index has been filled from the position components.
+    bool m_spatialIndexBuilt = false;
   };
 
 } // end namespace Systems
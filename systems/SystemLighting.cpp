@@ -13,6 +13,12 @@
 #include "systems/SystemGeometry.h"
 #include "types/LightInfluence.h"
 
+namespace
+{
+  /// Suffix of the Lua function called when an entity is lit.
+  Atom const OnLitBy{ "on_lit_by" };
+}
+
 namespace Systems
 {
 
@@ -67,14 +73,13 @@ namespace Systems
     // Step 2. Update light level calculations for affected tiles.
     if (m_recalculateAllTiles == true)
     {
-      auto mapSize = m_gameState.maps().get(currentMap).getSize();
-      for (int y = 0; y < mapSize.y; ++y)
+      // Only tiles in chunks that a light has reached can be lit; everything
+      // else just gets the ambient light.
+      m_tileCalculatedLightColors->clear();
+      m_tileLightSet->forEachAllocated([&](IntVec2 coords, std::set<EntityId>&)
       {
-        for (int x = 0; x < mapSize.x; ++x)
-        {
-          calculateTileLightLevels({ x, y });
-        }
-      }
+        calculateTileLightLevels(coords);
+      });
       m_recalculateAllTiles = false;
     }
     else
@@ -111,7 +116,7 @@ namespace Systems
 
   Color Lighting::getWallLightLevel(IntVec2 coords, Direction direction) const
   {
-    auto& calculatedLightColors = m_tileCalculatedLightColors->get(coords);
+    auto& calculatedLightColors = m_tileCalculatedLightColors->getClamped(coords);
     if (calculatedLightColors.count(direction.get_map_index()) == 0)
     {
       return m_ambientLightColor;
@@ -140,10 +145,14 @@ namespace Systems
         bool locationHasHealth = m_health.existsFor(location);
 
 
-        bool result = m_gameState.lua().callEntityFunction("on_lit_by", location, light, true);
-        if (result)
+        auto& lua = m_gameState.lua();
+        if (lua.hasEntityFunction(location, OnLitBy))
         {
-          //notifyObservers(Event::Updated);
+          bool result = lua.call<bool>(OnLitBy, location, true, light);
+          if (result)
+          {
+            //notifyObservers(Event::Updated);
+          }
         }
 
         //if (!isOpaque() || is wielding(light) || is wearing(light))
@@ -163,8 +172,8 @@ namespace Systems
 
   void Lighting::calculateTileLightLevels(IntVec2 coords)
   {
-    auto& lights = m_tileLightSet->get(coords);
-    auto& lightLevels = m_tileCalculatedLightColors->get(coords);
+    auto& lights = m_tileLightSet->atClamped(coords);
+    auto& lightLevels = m_tileCalculatedLightColors->atClamped(coords);
 
     lightLevels.clear();
     for (auto& light : lights)
@@ -177,8 +186,8 @@ namespace Systems
 
   void Lighting::addLightToTileLightLevels(IntVec2 tileCoords, EntityId source)
   {
-    auto& lights = m_tileLightSet->get(tileCoords);
-    auto& lightLevels = m_tileCalculatedLightColors->get(tileCoords);
+    auto& lights = m_tileLightSet->atClamped(tileCoords);
+    auto& lightLevels = m_tileCalculatedLightColors->atClamped(tileCoords);
 
     // Add this light if it isn't already in the tile's light set.
     if (lights.count(source) == 0)
@@ -379,14 +388,14 @@ namespace Systems
 
   void Lighting::addLightToTile(IntVec2 coords, EntityId source)
   {
-    m_tileLightSet->get(coords).insert(source);
+    m_tileLightSet->atClamped(coords).insert(source);
     m_lightTileSet[source].insert(coords);
     m_tilesToRecalculate.insert(coords);
   }
 
   void Lighting::removeLightFromTile(IntVec2 coords, EntityId source)
   {
-    m_tileLightSet->get(coords).erase(source);
+    m_tileLightSet->atClamped(coords).erase(source);
     m_lightTileSet[source].erase(coords);
     m_tilesToRecalculate.insert(coords);
   }
@@ -545,7 +554,7 @@ namespace Systems
 
       // Step through all lights shining on those coordinates, and flag the
       // sources responsible for recalculation.
-      for (auto& influence : m_tileLightSet->get(oldCoords))
+      for (auto& influence : m_tileLightSet->getClamped(oldCoords))
       {
         m_lightsToRecalculate.insert(influence);
       }
@@ -562,7 +571,7 @@ namespace Systems
       IntVec2 newCoords = m_position.of(castEvent.entity).coords();
 
       // Same as above.
-      for (auto& influence : m_tileLightSet->get(newCoords))
+      for (auto& influence : m_tileLightSet->getClamped(newCoords))
       {
         m_lightsToRecalculate.insert(influence);
       }
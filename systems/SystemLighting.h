@@ -5,7 +5,7 @@
 #include "systems/CRTP.h"
 #include "types/Color.h"
 #include "types/Direction.h"
-#include "types/Grid2D.h"
+#include "types/ChunkedGrid2D.h"
 #include "types/LightInfluence.h"
 
 // Forward declarations
@@ -108,11 +108,11 @@ namespace Systems
     std::unordered_set<IntVec2> m_tilesToRecalculate;
 
     /// Calculated light colors for map tile floors and walls.
-    using TileCalculatedLightColors = Grid2D<std::map<unsigned int, Color>>;
+    using TileCalculatedLightColors = ChunkedGrid2D<std::map<unsigned int, Color>>;
     std::unique_ptr<TileCalculatedLightColors> m_tileCalculatedLightColors;
 
     /// Map of coordinates to sets of lights that shine on them.
-    using TileLightData = Grid2D<std::set<EntityId>>;
+    using TileLightData = ChunkedGrid2D<std::set<EntityId>>;
     std::unique_ptr<TileLightData> m_tileLightSet;
 
     /// Map of lights to sets of coordinates that they are influencing.
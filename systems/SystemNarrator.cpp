@@ -800,7 +800,7 @@ namespace Systems
     std::stringstream ss;
     ss << part;
 
-    std::string fancyPartName = "NOUN_" + m_components.category.of(id) + "_" + ss.str();
+    std::string fancyPartName = "NOUN_" + m_components.category.of(id).str() + "_" + ss.str();
     std::string partName = "NOUN_" + ss.str();
 
     boost::to_upper(fancyPartName);
@@ -816,7 +816,7 @@ namespace Systems
     std::stringstream ss;
     ss << part;
 
-    std::string fancyPartName = "NOUN_" + m_components.category.of(id) + "_" + ss.str() + "_PLURAL";
+    std::string fancyPartName = "NOUN_" + m_components.category.of(id).str() + "_" + ss.str() + "_PLURAL";
     std::string partName = "NOUN_" + ss.str() + "_PLURAL";
 
     boost::to_upper(fancyPartName);
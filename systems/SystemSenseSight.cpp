@@ -3,9 +3,11 @@
 #include "systems/SystemSenseSight.h"
 
 #include "components/ComponentInventory.h"
+#include "components/ComponentManager.h"
 #include "components/ComponentPosition.h"
 #include "components/ComponentSenseSight.h"
 #include "components/ComponentSpacialMemory.h"
+#include "config/Settings.h"
 #include "game/GameState.h"
 #include "map/Map.h"
 #include "maptile/MapTile.h"
@@ -28,11 +30,18 @@ namespace Systems
     m_inventory{ inventory },
     m_position{ position },
     m_senseSight{ senseSight },
-    m_spacialMemory{ spacialMemory }
+    m_spacialMemory{ spacialMemory },
+    m_fovCache{ Config::settings().get("fov-cache-size").get<size_t>() },
+    m_lineOfSightTick{ 0 }
   {}
 
   SenseSight::~SenseSight()
-  {}
+  {
+    auto& stats = m_fovCache.stats();
+    CLOG(DEBUG, "SenseSight") << "FOV cache: " << stats.hits << " hits, " <<
+      stats.misses << " misses, " << stats.evictions << " evictions (hit rate " <<
+      stats.hitRate() << ")";
+  }
 
   void SenseSight::doCycleUpdate()
   {
@@ -52,14 +61,11 @@ namespace Systems
     // Are we on a map (i.e. not inside another entity)?  Bail out if we aren't.
     /// @todo Might want to deal with mapping the "inside of an entity" at some point.
     EntityId location = m_position.of(id).parent();
-    if (location == EntityId::Void)
+    if (location == EntityId::Void || m_position.of(id).isInsideAnotherEntity())
     {
       return;
     }
 
-    // Clear the "tiles seen" bitset.
-    m_senseSight[id].resetSeen();
-
     /// @todo Handle field-of-view here.
     ///       Field of view for an DynamicEntity can be:
     ///          * NARROW (90 degrees straight ahead)
@@ -67,15 +73,157 @@ namespace Systems
     ///          * FRONTBACK (90 degrees ahead/90 degrees back)
     ///          * FULL (all 360 degrees)
     Components::ComponentPosition const& position = m_position.of(id);
+    auto& senseSight = m_senseSight[id];
+    auto& map = m_gameState.maps().get(position.map());
+    IntVec2 mapSize = map.getSize();
+
+    // Observers standing on the same tile of an unchanged map see the same
+    // thing, so try the cache before doing any work.
+    FOVCache::Key key{ position.map(), position.coords(), senseSight.range(), map.getOpacityVersion() };
+    auto tilesSeen = m_fovCache.get(key);
+
+    if (!tilesSeen)
+    {
+      // Only the part of the map within sight range can be seen, so that's
+      // all the result needs to cover.
+      IntVec2 const& origin = position.coords();
+      int range = senseSight.range();
+      IntVec2 corner{ std::max(origin.x - range, 0), std::max(origin.y - range, 0) };
+      IntVec2 end{ std::min(origin.x + range + 1, mapSize.x), std::min(origin.y + range + 1, mapSize.y) };
+      auto newTilesSeen = std::make_shared<TilesSeen>(corner, end - corner);
+
+      for (int n = 1; n <= 8; ++n)
+      {
+        calculateRecursiveVisibility(*newTilesSeen, map, position.coords(), senseSight.range(), n);
+      }
+
+      tilesSeen = newTilesSeen;
+      m_fovCache.put(key, tilesSeen);
+    }
+
+    senseSight.setTilesSeen(tilesSeen);
+    updateVisibleEntities(id, map, *tilesSeen);
+
+    if (m_spacialMemory.existsFor(id))
+    {
+      updateMemory(id, map, *tilesSeen);
+    }
+  }
+
+  void SenseSight::updateMemory(EntityId id, Map const& map, TilesSeen const& tilesSeen)
+  {
+    MapID mapID = map.getMapID();
+    IntVec2 mapSize = map.getSize();
+    auto& memory = m_spacialMemory[id].ofMap(mapID);
+    auto clock = SYSTEMS.timekeeper().clock();
+
+    if (memory.size() != mapSize)
+    {
+      memory.resize(mapSize);
+    }
+
+    // Tiles cache their interned specs, so remembering a tile that hasn't
+    // changed only costs a comparison and a timestamp store. The few tiles
+    // with anything on them also remember what it was.
+    auto& components = m_gameState.components();
+    std::vector<EntitySpecsId> items;
+    tilesSeen.forEachSeen([&](IntVec2 coords)
+    {
+      auto tile = map.getTile(coords);
+      memory.remember(coords, tile.getTileFloorSpecsId(), tile.getTileSpaceSpecsId(), clock);
+
+      items.clear();
+      EntityId space = tile.getSpaceEntity();
+      if (m_inventory.existsFor(space))
+      {
+        auto& contents = m_inventory.of(space);
+        for (auto citer = contents.cbegin(); citer != contents.cend(); ++citer)
+        {
+          EntityId item = citer->second;
+          if (item == id) continue;
+
+          Atom material = components.material.existsFor(item) ? components.material.of(item) : Atom();
+          items.push_back(EntitySpecs(components.category.of(item), material).id());
+        }
+      }
+      memory.rememberItems(coords, items);
+    });
+  }
+
+  void SenseSight::updateVisibleEntities(EntityId id, Map const& map, TilesSeen const& tilesSeen)
+  {
+    using VisibleEntity = Components::ComponentSenseSight::VisibleEntity;
+    using VisibleEntities = Components::ComponentSenseSight::VisibleEntities;
+
+    auto& senseSight = m_senseSight[id];
+    VisibleEntities visible;
 
-    for (int n = 1; n <= 8; ++n)
+    // Only the top-level contents of each seen tile are visible; things
+    // inside containers aren't, and an observer doesn't "see" itself.
+    tilesSeen.forEachSeen([&](IntVec2 coords)
     {
-      calculateRecursiveVisibility(id, position, n);
+      EntityId space = map.getTile(coords).getSpaceEntity();
+      if (!m_inventory.existsFor(space)) return;
+
+      auto& contents = m_inventory.of(space);
+      for (auto citer = contents.cbegin(); citer != contents.cend(); ++citer)
+      {
+        if (citer->second != id)
+        {
+          visible.push_back({ citer->second, coords });
+        }
+      }
+    });
+
+    std::sort(visible.begin(), visible.end(),
+              [](VisibleEntity const& a, VisibleEntity const& b) { return a.id < b.id; });
+
+    // Both lists are sorted, so the difference falls out of a single merge.
+    std::vector<VisibleEntity> entered;
+    std::vector<EntityId> left;
+    auto& previous = senseSight.visibleEntities();
+    auto oldIter = previous.cbegin();
+    auto newIter = visible.cbegin();
+
+    while (oldIter != previous.cend() || newIter != visible.cend())
+    {
+      if (newIter == visible.cend() || (oldIter != previous.cend() && oldIter->id < newIter->id))
+      {
+        left.push_back(oldIter->id);
+        ++oldIter;
+      }
+      else if (oldIter == previous.cend() || newIter->id < oldIter->id)
+      {
+        entered.push_back(*newIter);
+        ++newIter;
+      }
+      else
+      {
+        ++oldIter;
+        ++newIter;
+      }
+    }
+
+    senseSight.setVisibleEntities(std::move(visible));
+
+    // Broadcast only once the new list is in place, so handlers see it.
+    for (auto& entity : entered)
+    {
+      EventEntityCameIntoView event(id, entity.id, entity.coords);
+      broadcast(event);
+    }
+
+    for (auto entity : left)
+    {
+      EventEntityLeftView event(id, entity);
+      broadcast(event);
     }
   }
 
-  void SenseSight::calculateRecursiveVisibility(EntityId id,
-                                                Components::ComponentPosition const& thisPosition,
+  void SenseSight::calculateRecursiveVisibility(TilesSeen& tilesSeen,
+                                                Map const& map,
+                                                IntVec2 origin,
+                                                int radius,
                                                 int octant,
                                                 int depth,
                                                 float slope_A,
@@ -83,18 +231,8 @@ namespace Systems
   {
     Assert("SenseSight", octant >= 1 && octant <= 8, "Octant" << octant << "passed in is not between 1 and 8 inclusively");
     IntVec2 newCoords;
-
-    // Are we on a map?  Bail out if we aren't.
-    if (!m_position.existsFor(id) || m_position.of(id).isInsideAnotherEntity())
-    {
-      return;
-    }
-
-    IntVec2 thisCoords = thisPosition.coords();
-    MapID thisMap = thisPosition.map();
-
-    static const int mv = 128;
-    static constexpr int mw = (mv * mv);
+    IntVec2 thisCoords = origin;
+    int radiusSquared = radius * radius;
 
     std::function< bool(RealVec2, RealVec2, float) > loop_condition;
     Direction dir;
@@ -180,17 +318,15 @@ namespace Systems
       break;
     }
 
-    auto& map = m_gameState.maps().get(thisMap);
-
     while (map.isInBounds(newCoords) && loop_condition(Math::toRealVec2(newCoords), Math::toRealVec2(thisCoords), slope_B))
     {
-      if (Math::distSquared(newCoords, thisCoords) <= mw)
+      if (Math::distSquared(newCoords, thisCoords) <= radiusSquared)
       {
         if (map.tileIsOpaque(newCoords))
         {
           if (!map.tileIsOpaque(newCoords + (IntVec2)dir))
           {
-            calculateRecursiveVisibility(id, thisPosition,
+            calculateRecursiveVisibility(tilesSeen, map, origin, radius,
                                          octant, depth + 1,
                                          slope_A, recurse_slope(Math::toRealVec2(newCoords), Math::toRealVec2(thisCoords)));
           }
@@ -203,25 +339,15 @@ namespace Systems
           }
         }
 
-        m_senseSight[id].setSeen(newCoords);
-
-        if (m_spacialMemory.existsFor(id))
-        {
-          auto& newTile = map.getTile(newCoords);
-          std::vector<EntitySpecs> memories;           
-          memories.push_back(newTile.getTileFloorSpecs());
-          memories.push_back(newTile.getTileSpaceSpecs());
-          MapMemoryChunk new_memory{ memories, SYSTEMS.timekeeper().clock() };
-          m_spacialMemory[id].ofMap(thisMap)[newCoords] = new_memory;
-        }
+        tilesSeen.set(newCoords);
       }
       newCoords -= (IntVec2)dir;
     }
     newCoords += (IntVec2)dir;
 
-    if ((depth < mv) && (!map.getTile(newCoords).isTotallyOpaque()))
+    if ((depth < radius) && (!map.tileIsOpaque(newCoords)))
     {
-      calculateRecursiveVisibility(id, thisPosition,
+      calculateRecursiveVisibility(tilesSeen, map, origin, radius,
                                    octant, depth + 1,
                                    slope_A, slope_B);
     }
@@ -251,6 +377,120 @@ namespace Systems
     return m_senseSight[subject].canSee(coords);
   }
 
+  bool SenseSight::lineOfSight(MapID mapID, IntVec2 first, IntVec2 second)
+  {
+    if (!m_gameState.maps().exists(mapID)) return false;
+    if (first == second) return true;
+
+    auto& map = m_gameState.maps().get(mapID);
+    if (!map.isInBounds(first) || !map.isInBounds(second)) return false;
+
+    // Results are only good for the current tick.
+    auto clock = SYSTEMS.timekeeper().clock();
+    if (clock != m_lineOfSightTick)
+    {
+      m_lineOfSightResults.clear();
+      m_lineOfSightTick = clock;
+    }
+
+    // The test is symmetric, so order the end points to share results.
+    if ((second.y < first.y) || ((second.y == first.y) && (second.x < first.x)))
+    {
+      std::swap(first, second);
+    }
+
+    LineOfSightKey key{ mapID, map.getOpacityVersion(), first, second };
+    auto iter = m_lineOfSightResults.find(key);
+    if (iter != m_lineOfSightResults.end())
+    {
+      return iter->second;
+    }
+
+    // Bresenham lines aren't symmetric on their own, so the sight line is
+    // clear if the line is clear in either direction.
+    bool result = traceLine(map, first, second) || traceLine(map, second, first);
+    m_lineOfSightResults[key] = result;
+    return result;
+  }
+
+  bool SenseSight::subjectCanSeeEntity(EntityId subject, EntityId target)
+  {
+    if (!m_senseSight.existsFor(subject)) return false;
+    if (!m_position.existsFor(subject) || !m_position.existsFor(target)) return false;
+
+    auto& subjectPosition = m_position.of(subject);
+    auto& targetPosition = m_position.of(target);
+
+    // Entities can't see out of, or into, other entities.
+    if (subjectPosition.isInsideAnotherEntity() || targetPosition.isInsideAnotherEntity()) return false;
+
+    MapID mapID = subjectPosition.map();
+    if (mapID.empty() || (mapID != targetPosition.map())) return false;
+
+    IntVec2 subjectCoords = subjectPosition.coords();
+    IntVec2 targetCoords = targetPosition.coords();
+    int range = m_senseSight.of(subject).range();
+    if (Math::distSquared(subjectCoords, targetCoords) > range * range) return false;
+
+    return lineOfSight(mapID, subjectCoords, targetCoords);
+  }
+
+  std::vector<EntityId> SenseSight::subjectsThatCanSee(std::vector<EntityId> const& subjects, EntityId target)
+  {
+    std::vector<EntityId> result;
+
+    for (auto subject : subjects)
+    {
+      if (subjectCanSeeEntity(subject, target))
+      {
+        result.push_back(subject);
+      }
+    }
+
+    return result;
+  }
+
+  bool SenseSight::traceLine(Map const& map, IntVec2 from, IntVec2 to) const
+  {
+    IntVec2 delta{ std::abs(to.x - from.x), -std::abs(to.y - from.y) };
+    IntVec2 step{ (from.x < to.x) ? 1 : -1, (from.y < to.y) ? 1 : -1 };
+    int error = delta.x + delta.y;
+    IntVec2 current = from;
+
+    while (true)
+    {
+      int error2 = 2 * error;
+      if (error2 >= delta.y)
+      {
+        error += delta.y;
+        current.x += step.x;
+      }
+      if (error2 <= delta.x)
+      {
+        error += delta.x;
+        current.y += step.y;
+      }
+
+      if (current == to) return true;
+      if (map.tileIsOpaque(current)) return false;
+    }
+  }
+
+  size_t SenseSight::LineOfSightKeyHash::operator()(LineOfSightKey const& key) const
+  {
+    size_t seed = 0;
+    boost::hash_combine(seed, std::hash<MapID>()(key.map));
+    boost::hash_combine(seed, key.opacityVersion);
+    boost::hash_combine(seed, std::hash<IntVec2>()(key.first));
+    boost::hash_combine(seed, std::hash<IntVec2>()(key.second));
+    return seed;
+  }
+
+  FOVCache const& SenseSight::fovCache() const
+  {
+    return m_fovCache;
+  }
+
   void SenseSight::setMap_V(MapID newMap)
   {
   }
@@ -270,7 +510,7 @@ namespace Systems
       MapID newMap = m_position.of(castEvent.entity).map();
       setMap(newMap);
       IntVec2 newMapSize = m_gameState.maps().get(newMap).getSize();
-      m_senseSight[castEvent.entity].resizeSeen(newMapSize);
+      m_senseSight[castEvent.entity].resetSeen();
 
       if (m_spacialMemory.existsFor(castEvent.entity))
       {
@@ -3,6 +3,7 @@
 #include "components/ComponentMap.h"
 #include "entity/EntityId.h"
 #include "systems/CRTP.h"
+#include "types/FOVCache.h"
 
 // Forward declarations
 namespace Components
@@ -13,6 +14,7 @@ namespace Components
   class ComponentSpacialMemory;
 }
 class GameState;
+class Map;
 
 namespace Systems
 {
@@ -21,6 +23,43 @@ namespace Systems
   class SenseSight : public CRTP<SenseSight>
   {
   public:
+    /// Event indicating an entity came into an observer's view.
+    struct EventEntityCameIntoView : public ConcreteEvent<EventEntityCameIntoView>
+    {
+      EventEntityCameIntoView(EntityId observer_, EntityId entity_, IntVec2 coords_) :
+        observer{ observer_ }, entity{ entity_ }, coords{ coords_ }
+      {
+      }
+
+      EntityId const observer;
+      EntityId const entity;
+      IntVec2 const coords;
+
+      void printToStream(std::ostream& os) const
+      {
+        Event::printToStream(os);
+        os << "| observer = " << observer << " | entity = " << entity << " | coords = " << coords;
+      }
+    };
+
+    /// Event indicating an entity left an observer's view.
+    struct EventEntityLeftView : public ConcreteEvent<EventEntityLeftView>
+    {
+      EventEntityLeftView(EntityId observer_, EntityId entity_) :
+        observer{ observer_ }, entity{ entity_ }
+      {
+      }
+
+      EntityId const observer;
+      EntityId const entity;
+
+      void printToStream(std::ostream& os) const
+      {
+        Event::printToStream(os);
+        os << "| observer = " << observer << " | entity = " << entity;
+      }
+    };
+
     SenseSight(GameState const& gameState,
                Components::ComponentMapConcrete<Components::ComponentInventory> const& inventory,
                Components::ComponentMapConcrete<Components::ComponentPosition> const& position,
@@ -32,14 +71,48 @@ namespace Systems
     /// Recalculate whatever needs recalculating.
     virtual void doCycleUpdate() override;
 
-    /// Returns true if first entity can see second.
+    /// Returns true if the subject entity can see a tile.
+    /// This reads the subject's last computed field of view rather than
+    /// tracing a sight line, so it also accounts for sight radius; use
+    /// lineOfSight() for a plain tile-to-tile test.
     bool subjectCanSeeCoords(EntityId subject, IntVec2 coords) const;
 
+    /// Returns true if there is an unobstructed line of sight between two
+    /// tiles on a map. The test is symmetric: if A can see B, B can see A.
+    /// Returns false if the map doesn't exist. Results are remembered until the game clock advances.
+    bool lineOfSight(MapID mapID, IntVec2 first, IntVec2 second);
+
+    /// Returns true if the subject entity can see the target entity.
+    /// Unlike subjectCanSeeCoords(), this does not require the subject's
+    /// field of view to be current.
+    bool subjectCanSeeEntity(EntityId subject, EntityId target);
+
+    /// Get the subjects in a collection that can see a target entity.
+    /// Useful for checking every monster on a level against the player.
+    std::vector<EntityId> subjectsThatCanSee(std::vector<EntityId> const& subjects, EntityId target);
+
+    /// Get the cache of field-of-view results.
+    FOVCache const& fovCache() const;
+
   protected:
     void findSeenTiles(EntityId id);
 
-    void calculateRecursiveVisibility(EntityId id,
-                                      Components::ComponentPosition const& thisPosition,
+    /// Update an entity's memory of the tiles in a set of seen tiles, and of
+    /// the things on them.
+    void updateMemory(EntityId id, Map const& map, TilesSeen const& tilesSeen);
+
+    /// Rebuild an entity's list of visible entities from a set of seen tiles,
+    /// broadcasting events for entities that entered or left its view.
+    void updateVisibleEntities(EntityId id, Map const& map, TilesSeen const& tilesSeen);
+
+    /// Walk a line between two tiles, returning false as soon as an opaque
+    /// tile is found. The end points themselves are not checked.
+    bool traceLine(Map const& map, IntVec2 from, IntVec2 to) const;
+
+    void calculateRecursiveVisibility(TilesSeen& tilesSeen,
+                                      Map const& map,
+                                      IntVec2 origin,
+                                      int radius,
                                       int octant,
                                       int depth = 1,
                                       float slope_A = 1,
@@ -60,6 +133,37 @@ namespace Systems
 
     /// Set of entities to update on the next cycle.
     std::set<EntityId> m_needsUpdate;
+
+    /// Field-of-view results shared by all observers.
+    FOVCache m_fovCache;
+
+    /// Key for a memoized line-of-sight result.
+    struct LineOfSightKey
+    {
+      MapID map;
+      unsigned int opacityVersion;
+      IntVec2 first;
+      IntVec2 second;
+
+      bool operator==(LineOfSightKey const& other) const
+      {
+        return (map == other.map) &&
+          (opacityVersion == other.opacityVersion) &&
+          (first == other.first) &&
+          (second == other.second);
+      }
+    };
+
+    struct LineOfSightKeyHash
+    {
+      size_t operator()(LineOfSightKey const& key) const;
+    };
+
+    /// Line-of-sight results for the current game tick.
+    std::unordered_map<LineOfSightKey, bool, LineOfSightKeyHash> m_lineOfSightResults;
+
+    /// Game tick the line-of-sight results were calculated on.
+    ElapsedTicks m_lineOfSightTick;
   };
 
 } // end namespace Systems
@@ -282,7 +282,7 @@ void TileSheet::markTilesUsed(UintVec2 upperLeft, UintVec2 size)
   }
 }
 
-bool TileSheet::hasTilesFor(std::string category)
+bool TileSheet::hasTilesFor(Atom category)
 {
   if (needToLoadFilesFor(category))
   {
@@ -292,12 +292,12 @@ bool TileSheet::hasTilesFor(std::string category)
   return (m_tileCoords.count(category) != 0);
 }
 
-bool TileSheet::needToLoadFilesFor(std::string category)
+bool TileSheet::needToLoadFilesFor(Atom category)
 {
   return (m_triedToLoad.count(category) == 0);
 }
 
-UintVec2 const& TileSheet::getTileSheetCoords(std::string category)
+UintVec2 const& TileSheet::getTileSheetCoords(Atom category)
 {
   if (needToLoadFilesFor(category))
   {
@@ -310,7 +310,7 @@ UintVec2 const& TileSheet::getTileSheetCoords(std::string category)
   return m_tileCoords.at(category);
 }
 
-void TileSheet::loadViewResourcesFor(std::string category)
+void TileSheet::loadViewResourcesFor(Atom category)
 {
   StringPair stringPair = StringTransforms::splitName(category);
 
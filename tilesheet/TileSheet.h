@@ -74,10 +74,10 @@ public:
                             RealVec2 lrCoord,
                             RealVec2 llCoord);
 
-  bool hasTilesFor(std::string category);
-  bool needToLoadFilesFor(std::string category);
-  UintVec2 const& getTileSheetCoords(std::string category);
-  void loadViewResourcesFor(std::string category);
+  bool hasTilesFor(Atom category);
+  bool needToLoadFilesFor(Atom category);
+  UintVec2 const& getTileSheetCoords(Atom category);
+  void loadViewResourcesFor(Atom category);
 
 protected:
   /// Return bitset index based on coordinates.
@@ -105,8 +105,8 @@ private:
   boost::dynamic_bitset<size_t> m_used; // size_t gets rid of 64-bit compile warning
 
   /// A map associating entity category names with tilesheet coordinates.
-  std::unordered_map<std::string, UintVec2> m_tileCoords;
+  std::unordered_map<Atom, UintVec2> m_tileCoords;
 
   /// A set indicating which categories we've already tried to load.
-  std::unordered_set<std::string> m_triedToLoad;
+  std::unordered_set<Atom> m_triedToLoad;
 };
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+
+/// Minimal assertions for the self-checking tools.
+/// A failed check is reported and counted rather than aborting, so a single
+/// run lists every failure; `Check::result()` turns the count into the
+/// program's exit status.
+namespace Check
+{
+  /// Number of checks that have failed so far.
+  inline int& failures()
+  {
+    static int count = 0;
+    return count;
+  }
+
+  /// Report the outcome of the checks.
+  /// @return EXIT_SUCCESS if every check passed, EXIT_FAILURE otherwise.
+  inline int result(char const* name)
+  {
+    if (failures() == 0)
+    {
+      std::cerr << name << ": all checks passed" << std::endl;
+      return EXIT_SUCCESS;
+    }
+
+    std::cerr << name << ": " << failures() << " checks failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+}
+
+/// Check that a condition holds, reporting it with its location if not.
+/// (Not `CHECK`, which easylogging++ already defines as a fatal assertion.)
+#define EXPECT(...) \
+  do \
+  { \
+    if (!(__VA_ARGS__)) \
+    { \
+      ++Check::failures(); \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #__VA_ARGS__ << std::endl; \
+    } \
+  } while (0)
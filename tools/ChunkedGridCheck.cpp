@@ -0,0 +1,179 @@
+/// Self-check of ChunkedGrid2D.
+///
+/// Exercises lazy chunk allocation, grids whose size isn't a whole number
+/// of chunks, chunk initializers, eviction, release and copying, and checks
+/// the grid against a plain dense array through a run of random writes.
+/// Exits with failure if any check fails.
+///
+/// Usage: ChunkedGridCheck
+
+#include "stdafx.h"
+
+#include <random>
+
+#include "tools/Check.h"
+#include "types/ChunkedGrid2D.h"
+
+INITIALIZE_EASYLOGGINGPP
+
+namespace
+{
+  /// Small chunks, so a small grid has plenty of them.
+  using Grid = ChunkedGrid2D<int, 4>;
+
+  void checkLazyAllocation()
+  {
+    Grid grid{ IntVec2(10, 7), -1 };
+    EXPECT(grid.chunkCount() == IntVec2(3, 2));
+    EXPECT(grid.allocatedChunkCount() == 0);
+
+    // Reads don't allocate.
+    EXPECT(grid.get({ 9, 6 }) == -1);
+    EXPECT(grid.getClamped({ 50, -3 }) == -1);
+    EXPECT(grid.allocatedChunkCount() == 0);
+
+    // A write allocates just the chunk it lands in.
+    grid[{ 5, 2 }] = 42;
+    EXPECT(grid.allocatedChunkCount() == 1);
+    EXPECT(grid.isChunkAllocated({ 1, 0 }));
+    EXPECT(!grid.isChunkAllocated({ 0, 0 }));
+    EXPECT(grid.get({ 5, 2 }) == 42);
+    EXPECT(grid.get({ 4, 2 }) == -1);
+
+    // Changing the default only affects unallocated chunks.
+    grid.setDefaultValue(7);
+    EXPECT(grid.get({ 0, 0 }) == 7);
+    EXPECT(grid.get({ 4, 2 }) == -1);
+
+    bool threw = false;
+    try
+    {
+      grid.at({ 10, 0 });
+    }
+    catch (std::out_of_range&)
+    {
+      threw = true;
+    }
+    EXPECT(threw);
+    EXPECT(grid.allocatedChunkCount() == 1);
+  }
+
+  void checkPartialChunks()
+  {
+    // The last column and row of chunks are only partly inside the grid.
+    Grid grid{ IntVec2(10, 7) };
+    grid[{ 9, 6 }] = 1;
+    grid[{ 0, 0 }] = 1;
+
+    int visited = 0;
+    bool outside = false;
+    grid.forEachAllocated([&](IntVec2 coords, int&)
+    {
+      ++visited;
+      if (!grid.contains(coords)) outside = true;
+    });
+
+    // Chunk (0, 0) is whole; chunk (2, 1) is 2 x 3 cells.
+    EXPECT(visited == 16 + 6);
+    EXPECT(!outside);
+  }
+
+  void checkInitializerAndEviction()
+  {
+    Grid grid{ IntVec2(8, 8) };
+    std::vector<IntVec2> initialized;
+    grid.setChunkInitializer([&](IntVec2 chunkCoords, Grid::Chunk& chunk)
+    {
+      initialized.push_back(chunkCoords);
+      chunk.fill(chunkCoords.x + (chunkCoords.y * 10));
+    });
+
+    EXPECT(grid[{ 5, 6 }] == 11);
+    EXPECT(initialized.size() == 1);
+    EXPECT(initialized.back() == IntVec2(1, 1));
+
+    // An evicted chunk comes back through the initializer, even on a read.
+    grid[{ 5, 6 }] = 99;
+    grid.evictChunk({ 1, 1 });
+    EXPECT(grid.isChunkEvicted({ 1, 1 }));
+    EXPECT(grid.allocatedChunkCount() == 0);
+    EXPECT(grid.get({ 5, 6 }) == 11);
+    EXPECT(initialized.size() == 2);
+    EXPECT(!grid.isChunkEvicted({ 1, 1 }));
+
+    // A released chunk goes back to the default value, and stays there.
+    grid.releaseChunk({ 1, 1 });
+    EXPECT(!grid.isChunkEvicted({ 1, 1 }));
+    EXPECT(grid.get({ 5, 6 }) == 0);
+    EXPECT(initialized.size() == 2);
+  }
+
+  void checkCopy()
+  {
+    Grid original{ IntVec2(8, 8) };
+    original[{ 1, 1 }] = 5;
+
+    Grid copy{ original };
+    copy[{ 1, 1 }] = 6;
+    copy[{ 6, 6 }] = 7;
+
+    EXPECT(original.get({ 1, 1 }) == 5);
+    EXPECT(original.allocatedChunkCount() == 1);
+    EXPECT(copy.get({ 1, 1 }) == 6);
+    EXPECT(copy.allocatedChunkCount() == 2);
+    EXPECT(copy.storageBytes() > original.storageBytes());
+  }
+
+  void checkAgainstDenseArray()
+  {
+    IntVec2 const size{ 37, 23 };
+    Grid grid{ size, 3 };
+    std::vector<int> dense(static_cast<size_t>(size.x) * size.y, 3);
+    std::mt19937 random(1);
+
+    for (int step = 0; step < 20000; ++step)
+    {
+      IntVec2 coords{ static_cast<int>(random() % size.x), static_cast<int>(random() % size.y) };
+      int value = static_cast<int>(random() % 1000);
+      grid[coords] = value;
+      dense[(coords.y * size.x) + coords.x] = value;
+
+      // Now and then, throw a chunk away on both sides.
+      if ((step % 1000) == 999)
+      {
+        IntVec2 chunkCoords = Grid::chunkCoordsOf(coords);
+        grid.releaseChunk(chunkCoords);
+        for (int y = chunkCoords.y * Grid::chunkSide; y < std::min((chunkCoords.y + 1) * Grid::chunkSide, size.y); ++y)
+        {
+          for (int x = chunkCoords.x * Grid::chunkSide; x < std::min((chunkCoords.x + 1) * Grid::chunkSide, size.x); ++x)
+          {
+            dense[(y * size.x) + x] = 3;
+          }
+        }
+      }
+    }
+
+    int mismatches = 0;
+    for (int y = 0; y < size.y; ++y)
+    {
+      for (int x = 0; x < size.x; ++x)
+      {
+        if (grid.get({ x, y }) != dense[(y * size.x) + x]) ++mismatches;
+      }
+    }
+    EXPECT(mismatches == 0);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  START_EASYLOGGINGPP(argc, argv);
+
+  checkLazyAllocation();
+  checkPartialChunks();
+  checkInitializerAndEviction();
+  checkCopy();
+  checkAgainstDenseArray();
+
+  return Check::result("ChunkedGridCheck");
+}
@@ -0,0 +1,149 @@
+/// Self-check of FenwickGrid2D.
+///
+/// Checks rectangle sums against a plain dense array, after building the
+/// grid in one go and through a run of random single-cell changes, on grid
+/// sizes that aren't powers of two, with rectangles that hang off the grid.
+/// Exits with failure if any check fails.
+///
+/// Usage: FenwickGridCheck
+
+#include "stdafx.h"
+
+#include <random>
+
+#include "tools/Check.h"
+#include "types/FenwickGrid2D.h"
+
+INITIALIZE_EASYLOGGINGPP
+
+namespace
+{
+  /// A plain array of values, summed the slow way.
+  class DenseGrid
+  {
+  public:
+    DenseGrid(IntVec2 size)
+      :
+      m_size{ size },
+      m_values(static_cast<size_t>(size.x) * size.y, 0)
+    {}
+
+    int& operator[](IntVec2 coords)
+    {
+      return m_values[(coords.y * m_size.x) + coords.x];
+    }
+
+    int sum(IntVec2 upperLeft, IntVec2 lowerRight) const
+    {
+      int total = 0;
+      for (int y = std::max(upperLeft.y, 0); y <= std::min(lowerRight.y, m_size.y - 1); ++y)
+      {
+        for (int x = std::max(upperLeft.x, 0); x <= std::min(lowerRight.x, m_size.x - 1); ++x)
+        {
+          total += m_values[(y * m_size.x) + x];
+        }
+      }
+      return total;
+    }
+
+  private:
+    IntVec2 m_size;
+    std::vector<int> m_values;
+  };
+
+  IntVec2 randomCoords(std::mt19937& random, IntVec2 min, IntVec2 max)
+  {
+    return{ std::uniform_int_distribution<int>(min.x, max.x)(random),
+            std::uniform_int_distribution<int>(min.y, max.y)(random) };
+  }
+
+  /// Compare sums over a number of random rectangles, some partly or
+  /// entirely off the grid.
+  /// @return The number of rectangles whose sums differ.
+  int compareSums(FenwickGrid2D<int> const& grid, DenseGrid const& dense, std::mt19937& random, int count)
+  {
+    IntVec2 size = grid.size();
+    int mismatches = 0;
+    for (int index = 0; index < count; ++index)
+    {
+      IntVec2 a = randomCoords(random, { -3, -3 }, { size.x + 2, size.y + 2 });
+      IntVec2 b = randomCoords(random, { -3, -3 }, { size.x + 2, size.y + 2 });
+      IntVec2 upperLeft{ std::min(a.x, b.x), std::min(a.y, b.y) };
+      IntVec2 lowerRight{ std::max(a.x, b.x), std::max(a.y, b.y) };
+      if (grid.sum(upperLeft, lowerRight) != dense.sum(upperLeft, lowerRight)) ++mismatches;
+    }
+    return mismatches;
+  }
+
+  void checkSize(IntVec2 size, std::mt19937& random)
+  {
+    DenseGrid dense{ size };
+    for (int y = 0; y < size.y; ++y)
+    {
+      for (int x = 0; x < size.x; ++x)
+      {
+        dense[{ x, y }] = std::uniform_int_distribution<int>(-5, 20)(random);
+      }
+    }
+
+    // Building in one go matches adding the cells one at a time.
+    FenwickGrid2D<int> built{ size };
+    built.build([&](IntVec2 coords) { return dense[coords]; });
+
+    FenwickGrid2D<int> added{ size };
+    for (int y = 0; y < size.y; ++y)
+    {
+      for (int x = 0; x < size.x; ++x)
+      {
+        added.add({ x, y }, dense[{ x, y }]);
+      }
+    }
+
+    EXPECT(built.sum({ 0, 0 }, size - IntVec2(1, 1)) == dense.sum({ 0, 0 }, size));
+    EXPECT(compareSums(built, dense, random, 500) == 0);
+    EXPECT(compareSums(added, dense, random, 500) == 0);
+
+    // Single-cell changes keep the sums right.
+    for (int step = 0; step < 2000; ++step)
+    {
+      IntVec2 coords = randomCoords(random, { 0, 0 }, size - IntVec2(1, 1));
+      int delta = std::uniform_int_distribution<int>(-10, 10)(random);
+      built.add(coords, delta);
+      dense[coords] += delta;
+    }
+    EXPECT(compareSums(built, dense, random, 500) == 0);
+
+    for (int y = 0; y < size.y; ++y)
+    {
+      for (int x = 0; x < size.x; ++x)
+      {
+        if (built.sum({ x, y }, { x, y }) != dense[{ x, y }])
+        {
+          EXPECT(built.sum({ x, y }, { x, y }) == dense[{ x, y }]);
+          return;
+        }
+      }
+    }
+
+    built.clear();
+    EXPECT(built.sum({ -1, -1 }, size) == 0);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  START_EASYLOGGINGPP(argc, argv);
+
+  std::mt19937 random(1);
+
+  checkSize({ 1, 1 }, random);
+  checkSize({ 1, 17 }, random);
+  checkSize({ 16, 16 }, random);
+  checkSize({ 37, 23 }, random);
+  checkSize({ 100, 3 }, random);
+
+  FenwickGrid2D<int> empty;
+  EXPECT(empty.sum({ 0, 0 }, { 5, 5 }) == 0);
+
+  return Check::result("FenwickGridCheck");
+}
@@ -0,0 +1,167 @@
+/// Self-check of the batched and coroutine entity AI paths.
+///
+/// Runs the shipped Marcher AI as coroutines and checks its march, then
+/// swaps in test scripts to check yielding nothing, returning, raising an
+/// error, releasing a coroutine (as happens when its entity is deleted),
+/// and falling back to the batch function when there is no coroutine.
+/// No map is needed: the scripts only see entity IDs. Exits with failure if
+/// any check fails.
+///
+/// Usage: LuaAICheck
+
+#include "stdafx.h"
+
+#include "config/Bible.h"
+#include "game/App.h"
+#include "game/GameState.h"
+#include "lua/LuaObject.h"
+#include "tools/Check.h"
+
+INITIALIZE_EASYLOGGINGPP
+
+namespace
+{
+  Atom const Process{ "process" };
+  Atom const Marcher{ "Marcher" };
+
+  /// Get the x step of a MOVE action, or 0 for anything else.
+  int stepX(json const& action)
+  {
+    if (action.is_null() || action["action"] != "MOVE") return 0;
+    return action["direction"][0].get<int>();
+  }
+
+  /// Resume the coroutines of some marchers, and get the x step of each.
+  std::vector<int> march(Lua& lua, std::vector<EntityId> const& marchers)
+  {
+    std::vector<json> actions;
+    EXPECT(lua.resumeEntityCoroutines(Process, Marcher, marchers, actions));
+    std::vector<int> steps;
+    for (auto& action : actions) steps.push_back(stepX(action));
+    return steps;
+  }
+
+  /// Replace the Marcher's AI functions with test versions.
+  void define(Lua& lua, char const* script)
+  {
+    EXPECT(luaL_dostring(lua.state(), script) == 0);
+    lua.clear_function_cache();
+  }
+
+  void checkMarch(Lua& lua)
+  {
+    EntityId a{ 1000001 };
+    EntityId b{ 1000002 };
+
+    // Four steps right, four left, and round again.
+    std::vector<int> expected{ 1, 1, 1, 1, -1, -1, -1, -1, 1, 1 };
+    for (int step : expected)
+    {
+      EXPECT(march(lua, { a, b }) == std::vector<int>({ step, step }));
+    }
+
+    // A released coroutine starts over; the others carry on.
+    lua.releaseEntityCoroutine(a);
+    EXPECT(march(lua, { a, b }) == std::vector<int>({ 1, 1 }));
+    EXPECT(march(lua, { a, b }) == std::vector<int>({ 1, 1 }));
+    EXPECT(march(lua, { a, b }) == std::vector<int>({ 1, -1 }));
+
+    lua.releaseEntityCoroutine(a);
+    lua.releaseEntityCoroutine(b);
+  }
+
+  void checkYieldReturnAndError(Lua& lua)
+  {
+    EntityId good{ 1000003 };
+    EntityId bad{ 1000004 };
+
+    define(lua,
+      "function Marcher_process_coroutine(id)\n"
+      "    coroutine.yield(nil)\n"
+      "    coroutine.yield({ action = 'WAIT' })\n"
+      "    if id == 1000004 then error('failing on purpose') end\n"
+      "    return { action = 'MOVE', direction = { 1, 0, 0 } }\n"
+      "end\n");
+
+    std::vector<json> actions;
+    auto resume = [&]
+    {
+      EXPECT(lua.resumeEntityCoroutines(Process, Marcher, { good, bad }, actions));
+      EXPECT(actions.size() == 2);
+    };
+
+    // Yielding nil does nothing for a turn.
+    resume();
+    EXPECT(actions[0].is_null() && actions[1].is_null());
+
+    resume();
+    EXPECT(actions[0]["action"] == "WAIT");
+    EXPECT(actions[1]["action"] == "WAIT");
+
+    // Returning gives the last action; an error gives none.
+    resume();
+    EXPECT(stepX(actions[0]) == 1);
+    EXPECT(actions[1].is_null());
+
+    // Either way, the next turn starts over from the top.
+    resume();
+    EXPECT(actions[0].is_null() && actions[1].is_null());
+    resume();
+    EXPECT(actions[0]["action"] == "WAIT");
+    EXPECT(actions[1]["action"] == "WAIT");
+
+    lua.releaseEntityCoroutine(good);
+    lua.releaseEntityCoroutine(bad);
+  }
+
+  void checkBatch(Lua& lua)
+  {
+    define(lua,
+      "Marcher_process_coroutine = nil\n"
+      "function Marcher_process_batch(ids)\n"
+      "    local actions = {}\n"
+      "    for index, id in ipairs(ids) do\n"
+      "        if index % 2 == 1 then actions[index] = { action = 'WAIT', target = id } end\n"
+      "    end\n"
+      "    return actions\n"
+      "end\n");
+
+    std::vector<EntityId> ids{ 1000005, 1000006, 1000007 };
+    std::vector<json> actions;
+    EXPECT(!lua.resumeEntityCoroutines(Process, Marcher, ids, actions));
+
+    actions = lua.callEntityBatchFunction(Process, Marcher, ids);
+    EXPECT(actions.size() == 3);
+    if (actions.size() != 3) return;
+    EXPECT(actions[0]["action"] == "WAIT");
+    EXPECT(actions[0]["target"].get<EntityId>() == ids[0]);
+    EXPECT(actions[1].is_null());
+    EXPECT(actions[2]["target"].get<EntityId>() == ids[2]);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  START_EASYLOGGINGPP(argc, argv);
+
+  App::setUpLoggers();
+  el::Loggers::reconfigureAllLoggers(el::ConfigurationType::ToStandardOutput, "false");
+
+  {
+    GameState game({});
+    auto& lua = game.lua();
+
+    // Loading the category's data runs its script.
+    Config::bible().categoryData(Marcher);
+    int top = lua_gettop(lua.state());
+
+    checkMarch(lua);
+    checkYieldReturnAndError(lua);
+    checkBatch(lua);
+
+    // Nothing should be left behind on the stack.
+    EXPECT(lua_gettop(lua.state()) == top);
+  }
+
+  return Check::result("LuaAICheck");
+}
@@ -0,0 +1,221 @@
+/// Headless Lua call benchmark.
+///
+/// Generates a map from a fixed seed, without opening a window, and calls
+/// the per-frame and per-light Lua callbacks on every entity on it, first
+/// through the JSON path (Lua::callEntityFunction) and then through the
+/// typed path (Lua::call), checking that both give the same results.
+/// Results, along with Lua's memory statistics, are written to a JSON file.
+///
+/// Usage: LuaCallBench [--size WxH] [--frames N] [--seed S] [--output FILE]
+
+#include "stdafx.h"
+
+#include <fstream>
+
+#include "components/ComponentManager.h"
+#include "config/Settings.h"
+#include "game/App.h"
+#include "game/GameState.h"
+#include "lua/LuaObject.h"
+#include "map/Map.h"
+#include "map/MapFactory.h"
+#include "maptile/MapTile.h"
+#include "utilities/RNGUtils.h"
+
+INITIALIZE_EASYLOGGINGPP
+
+namespace
+{
+  struct Options
+  {
+    IntVec2 size{ 64, 64 };
+    int frames = 20;
+    uint64_t seed = 1;
+    std::string output = "lua-call-bench.json";
+  };
+
+  void printUsage()
+  {
+    std::cerr << "Usage: LuaCallBench [--size WxH] [--frames N] [--seed S] [--output FILE]" << std::endl;
+  }
+
+  bool parseOptions(int argc, char* argv[], Options& options)
+  {
+    for (int index = 1; index < argc; ++index)
+    {
+      std::string arg = argv[index];
+      if (index + 1 >= argc) return false;
+      std::string value = argv[++index];
+
+      if (arg == "--size")
+      {
+        IntVec2& size = options.size;
+        if (std::sscanf(value.c_str(), "%dx%d", &size.x, &size.y) != 2 || size.x < 3 || size.y < 3)
+        {
+          return false;
+        }
+      }
+      else if (arg == "--frames")
+      {
+        options.frames = std::max(std::stoi(value), 1);
+      }
+      else if (arg == "--seed")
+      {
+        options.seed = std::stoull(value);
+      }
+      else if (arg == "--output")
+      {
+        options.output = value;
+      }
+      else
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /// Collect the entities a map view would draw: each tile's display entity
+  /// and the contents of its space.
+  std::vector<EntityId> collectEntities(GameState& game, Map& map)
+  {
+    auto& inventory = game.components().inventory;
+    IntVec2 const& size = map.getSize();
+    std::vector<EntityId> entities;
+
+    for (int y = 0; y < size.y; ++y)
+    {
+      for (int x = 0; x < size.x; ++x)
+      {
+        auto tile = map.getTile({ x, y });
+        entities.push_back(tile.getDisplayEntity());
+
+        EntityId space = tile.getSpaceEntity();
+        if (inventory.existsFor(space))
+        {
+          for (auto& pair : inventory.of(space))
+          {
+            entities.push_back(pair.second);
+          }
+        }
+      }
+    }
+
+    return entities;
+  }
+
+  /// Time a set of calls, one per entity per frame.
+  template <typename Call>
+  json timeCalls(std::vector<EntityId> const& entities, int frames, Call call)
+  {
+    auto startTime = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame)
+    {
+      for (auto entity : entities)
+      {
+        call(entity, frame);
+      }
+    }
+    auto total = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+
+    size_t calls = entities.size() * frames;
+    json result;
+    result["calls"] = calls;
+    result["total_ms"] = total.count() / 1000.0;
+    result["mean_ns"] = (total.count() * 1000.0) / calls;
+    return result;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  START_EASYLOGGINGPP(argc, argv);
+
+  Options options;
+  if (!parseOptions(argc, argv, options))
+  {
+    printUsage();
+    return EXIT_FAILURE;
+  }
+
+  App::setUpLoggers();
+  el::Loggers::reconfigureAllLoggers(el::ConfigurationType::ToStandardOutput, "false");
+
+  json report;
+  report["size"] = { options.size.x, options.size.y };
+  report["frames"] = options.frames;
+  report["seed"] = options.seed;
+
+  {
+    GameState game({});
+
+    RNG::setGlobalSeed(options.seed);
+    MapID id = game.maps().create(options.size.x, options.size.y);
+    Map& map = game.maps().get(id);
+    auto& lua = game.lua();
+
+    auto entities = collectEntities(game, map);
+    report["entities"] = entities.size();
+
+    // Lights are looked up by ID only, so any entity will do.
+    EntityId light = entities.front();
+
+    Atom const getTileOffset{ "get_tile_offset" };
+    Atom const onLitBy{ "on_lit_by" };
+
+    // get_tile_offset: one integer argument, a two-slot result.
+    std::vector<UintVec2> jsonOffsets;
+    std::vector<UintVec2> typedOffsets;
+    json offsets;
+    offsets["json"] = timeCalls(entities, options.frames, [&](EntityId entity, int frame)
+    {
+      UintVec2 offset = lua.callEntityFunction(getTileOffset, entity, frame, UintVec2(0, 0));
+      if (frame == 0) jsonOffsets.push_back(offset);
+    });
+    offsets["typed"] = timeCalls(entities, options.frames, [&](EntityId entity, int frame)
+    {
+      UintVec2 offset = lua.call<UintVec2>(getTileOffset, entity, UintVec2(0, 0), frame);
+      if (frame == 0) typedOffsets.push_back(offset);
+    });
+
+    // Both paths should pick exactly the same tiles.
+    int mismatches = 0;
+    for (size_t index = 0; index < jsonOffsets.size(); ++index)
+    {
+      if (jsonOffsets[index] != typedOffsets[index]) ++mismatches;
+    }
+    offsets["mismatches"] = mismatches;
+    report["get_tile_offset"] = offsets;
+
+    // on_lit_by: one entity argument, a boolean result.
+    json lit;
+    lit["json"] = timeCalls(entities, options.frames, [&](EntityId entity, int)
+    {
+      (void)lua.callEntityFunction(onLitBy, entity, light, true).get<bool>();
+    });
+    lit["typed"] = timeCalls(entities, options.frames, [&](EntityId entity, int)
+    {
+      (void)lua.call<bool>(onLitBy, entity, true, light);
+    });
+    report["on_lit_by"] = lit;
+    report["lua_memory"] = lua.memory();
+
+    for (auto& name : { "get_tile_offset", "on_lit_by" })
+    {
+      std::cerr << name << ": " <<
+        report[name]["json"]["mean_ns"].get<double>() << " ns per call through JSON, " <<
+        report[name]["typed"]["mean_ns"].get<double>() << " ns typed" << std::endl;
+    }
+  }
+
+  std::ofstream file(options.output);
+  if (!file)
+  {
+    std::cerr << "Could not write " << options.output << std::endl;
+    return EXIT_FAILURE;
+  }
+  file << report.dump(2) << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,228 @@
+/// Self-check of the Lua allocator's small-block pool.
+///
+/// The game never uses the pool on 64-bit LuaJIT (see LuaMemory.h), so this
+/// calls `LuaMemory::allocate` directly with the pool turned on. It checks
+/// resizing within a size class, between classes, and into and out of the
+/// pool, that freed blocks are reused, and that the byte counts balance;
+/// then runs a random mix of allocations, checking every block's contents
+/// survive. Finally, if this platform lets it, runs a Lua state on the
+/// pool. Exits with failure if any check fails.
+///
+/// Usage: LuaMemoryCheck
+
+#include "stdafx.h"
+
+#include <cstring>
+#include <random>
+
+#include "lua/LuaMemory.h"
+#include "tools/Check.h"
+
+INITIALIZE_EASYLOGGINGPP
+
+namespace
+{
+  void* resize(LuaMemory& memory, void* block, size_t oldSize, size_t newSize)
+  {
+    return LuaMemory::allocate(&memory, block, oldSize, newSize);
+  }
+
+  /// Fill a block with a pattern that depends on a tag.
+  void fill(void* block, size_t size, unsigned char tag)
+  {
+    auto bytes = static_cast<unsigned char*>(block);
+    for (size_t index = 0; index < size; ++index)
+    {
+      bytes[index] = static_cast<unsigned char>(tag + index);
+    }
+  }
+
+  /// Check the first bytes of a block still hold the pattern for a tag.
+  bool holds(void const* block, size_t size, unsigned char tag)
+  {
+    auto bytes = static_cast<unsigned char const*>(block);
+    for (size_t index = 0; index < size; ++index)
+    {
+      if (bytes[index] != static_cast<unsigned char>(tag + index)) return false;
+    }
+    return true;
+  }
+
+  void checkResizing()
+  {
+    LuaMemory memory{ true };
+    EXPECT(memory.pooled());
+
+    // Within a size class, the block stays where it is.
+    void* block = resize(memory, nullptr, 0, 20);
+    fill(block, 20, 1);
+    void* same = resize(memory, block, 20, 30);
+    EXPECT(same == block);
+    EXPECT(holds(same, 20, 1));
+    EXPECT(memory.bytesInUse() == 30);
+
+    // Up and down between classes.
+    fill(same, 30, 2);
+    void* bigger = resize(memory, same, 30, 100);
+    EXPECT(bigger != nullptr);
+    EXPECT(holds(bigger, 30, 2));
+    fill(bigger, 100, 3);
+    void* smaller = resize(memory, bigger, 100, 40);
+    EXPECT(holds(smaller, 40, 3));
+
+    // Out of the pool and back in.
+    void* large = resize(memory, smaller, 40, 1000);
+    EXPECT(large != nullptr);
+    EXPECT(holds(large, 40, 3));
+    fill(large, 1000, 4);
+    void* larger = resize(memory, large, 1000, 5000);
+    EXPECT(holds(larger, 1000, 4));
+    void* pooled = resize(memory, larger, 5000, 256);
+    EXPECT(holds(pooled, 256, 4));
+    EXPECT(memory.bytesInUse() == 256);
+
+    EXPECT(resize(memory, pooled, 256, 0) == nullptr);
+    EXPECT(memory.bytesInUse() == 0);
+    EXPECT(memory.peakBytesInUse() == 5000);
+
+    // Freeing nothing is harmless.
+    EXPECT(resize(memory, nullptr, 64, 0) == nullptr);
+    EXPECT(memory.bytesInUse() == 0);
+  }
+
+  void checkReuse()
+  {
+    LuaMemory memory{ true };
+
+    void* first = resize(memory, nullptr, 0, 60);
+    void* second = resize(memory, nullptr, 0, 60);
+    EXPECT(first != second);
+    EXPECT(reinterpret_cast<uintptr_t>(first) % 16 == reinterpret_cast<uintptr_t>(second) % 16);
+
+    // The free list hands back the block freed most recently.
+    resize(memory, first, 60, 0);
+    EXPECT(resize(memory, nullptr, 0, 50) == first);
+
+    // Moving to another class frees the old block for reuse.
+    void* moved = resize(memory, second, 60, 150);
+    EXPECT(moved != second);
+    EXPECT(resize(memory, nullptr, 0, 64) == second);
+  }
+
+  void checkPhases()
+  {
+    LuaMemory memory{ true };
+    void* block;
+    {
+      LuaMemory::Scope scope{ memory, LuaMemory::Phase::AI };
+      block = resize(memory, nullptr, 0, 48);
+      LuaMemory::Scope inner{ memory, LuaMemory::Phase::Callbacks };
+      block = resize(memory, block, 48, 400);
+    }
+    resize(memory, block, 400, 0);
+
+    auto& ai = memory.stats(LuaMemory::Phase::AI);
+    EXPECT(ai.allocations == 2);
+    EXPECT(ai.bytesAllocated == 400);
+    EXPECT(memory.stats(LuaMemory::Phase::Callbacks).allocations == 0);
+
+    auto& other = memory.stats(LuaMemory::Phase::Other);
+    EXPECT(other.frees == 1);
+    EXPECT(other.bytesFreed == 400);
+  }
+
+  void checkRandomMix()
+  {
+    struct Block
+    {
+      void* memory;
+      size_t size;
+      unsigned char tag;
+    };
+
+    LuaMemory memory{ true };
+    std::vector<Block> blocks(500, Block{ nullptr, 0, 0 });
+    std::mt19937 random(1);
+    int damaged = 0;
+    uint64_t expectedBytes = 0;
+
+    for (int step = 0; step < 200000; ++step)
+    {
+      auto& block = blocks[random() % blocks.size()];
+
+      // Mostly small sizes, around the class boundaries, with a few large.
+      size_t newSize = (random() % 10 == 0) ? random() % 2000 : random() % 300;
+      if (block.memory != nullptr && !holds(block.memory, block.size, block.tag)) ++damaged;
+
+      void* result = resize(memory, block.memory, block.size, newSize);
+      if (newSize == 0)
+      {
+        EXPECT(result == nullptr);
+      }
+      else if (result == nullptr)
+      {
+        EXPECT(result != nullptr);
+        return;
+      }
+      else if (!holds(result, std::min(block.size, newSize), block.tag))
+      {
+        ++damaged;
+      }
+
+      expectedBytes = expectedBytes - block.size + newSize;
+      block.memory = result;
+      block.size = newSize;
+      block.tag = static_cast<unsigned char>(step);
+      fill(block.memory, block.size, block.tag);
+    }
+
+    EXPECT(damaged == 0);
+    EXPECT(memory.bytesInUse() == expectedBytes);
+
+    for (auto& block : blocks)
+    {
+      resize(memory, block.memory, block.size, 0);
+    }
+    EXPECT(memory.bytesInUse() == 0);
+  }
+
+  void checkLuaState()
+  {
+    LuaMemory memory{ true };
+    lua_State* L = lua_newstate(LuaMemory::allocate, &memory);
+    if (L == nullptr)
+    {
+      std::cerr << "LuaMemoryCheck: this Lua won't run on a custom allocator; skipping the state check" << std::endl;
+      return;
+    }
+
+    luaL_openlibs(L);
+    char const* script =
+      "local t = {} "
+      "for i = 1, 20000 do t[i] = { i, tostring(i) .. 'x' } end "
+      "for i = 1, 20000, 2 do t[i] = nil end "
+      "collectgarbage() "
+      "local total = 0 "
+      "for i = 2, 20000, 2 do total = total + t[i][1] end "
+      "return total";
+    EXPECT(luaL_dostring(L, script) == 0);
+    EXPECT(lua_tointeger(L, -1) == 100010000);
+    EXPECT(memory.bytesInUse() > 0);
+
+    lua_close(L);
+    EXPECT(memory.bytesInUse() == 0);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  START_EASYLOGGINGPP(argc, argv);
+
+  checkResizing();
+  checkReuse();
+  checkPhases();
+  checkRandomMix();
+  checkLuaState();
+
+  return Check::result("LuaMemoryCheck");
+}
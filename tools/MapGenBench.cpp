@@ -0,0 +1,284 @@
+/// Headless map generation benchmark.
+///
+/// Generates a number of maps of each requested size from fixed seeds,
+/// without opening a window, and writes timings, memory use, entity counts
+/// and connectivity statistics to a JSON file.
+///
+/// Usage: MapGenBench [--sizes WxH[,WxH...]] [--count N] [--warmup N]
+///                    [--seed S] [--output FILE]
+
+#include "stdafx.h"
+
+#include <deque>
+#include <fstream>
+
+#include <boost/algorithm/string.hpp>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include "components/ComponentManager.h"
+#include "config/Paths.h"
+#include "config/Settings.h"
+#include "game/App.h"
+#include "game/GameState.h"
+#include "map/Map.h"
+#include "map/MapFactory.h"
+#include "maptile/MapTile.h"
+#include "utilities/RNGUtils.h"
+
+INITIALIZE_EASYLOGGINGPP
+
+namespace
+{
+  struct Options
+  {
+    std::vector<IntVec2> sizes{ IntVec2(64, 64) };
+    int count = 5;
+    int warmup = 1;
+    uint64_t seed = 1;
+    std::string output = "mapgen-bench.json";
+  };
+
+  void printUsage()
+  {
+    std::cerr << "Usage: MapGenBench [--sizes WxH[,WxH...]] [--count N] [--warmup N]" << std::endl;
+    std::cerr << "                   [--seed S] [--output FILE]" << std::endl;
+  }
+
+  bool parseSizes(std::string const& text, std::vector<IntVec2>& sizes)
+  {
+    std::vector<std::string> items;
+    boost::split(items, text, boost::is_any_of(","));
+    sizes.clear();
+
+    for (auto& item : items)
+    {
+      IntVec2 size;
+      if (std::sscanf(item.c_str(), "%dx%d", &size.x, &size.y) != 2 || size.x < 3 || size.y < 3)
+      {
+        return false;
+      }
+      sizes.push_back(size);
+    }
+
+    return !sizes.empty();
+  }
+
+  bool parseOptions(int argc, char* argv[], Options& options)
+  {
+    for (int index = 1; index < argc; ++index)
+    {
+      std::string arg = argv[index];
+      if (index + 1 >= argc) return false;
+      std::string value = argv[++index];
+
+      if (arg == "--sizes")
+      {
+        if (!parseSizes(value, options.sizes)) return false;
+      }
+      else if (arg == "--count")
+      {
+        options.count = std::max(std::stoi(value), 1);
+      }
+      else if (arg == "--warmup")
+      {
+        options.warmup = std::max(std::stoi(value), 0);
+      }
+      else if (arg == "--seed")
+      {
+        options.seed = std::stoull(value);
+      }
+      else if (arg == "--output")
+      {
+        options.output = value;
+      }
+      else
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /// Get the resident set size of this process, in bytes, if it is known.
+  size_t processResidentBytes()
+  {
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    size_t totalPages = 0;
+    size_t residentPages = 0;
+    if (statm >> totalPages >> residentPages)
+    {
+      return residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+#endif
+    return 0;
+  }
+
+  double toMilliseconds(std::chrono::microseconds time)
+  {
+    return time.count() / 1000.0;
+  }
+
+  /// Find the passable regions of a map (4-connected).
+  json connectivityOf(Map& map)
+  {
+    IntVec2 const& size = map.getSize();
+    std::vector<uint8_t> seen(static_cast<size_t>(size.x) * size.y, 0);
+    std::deque<IntVec2> open;
+    int passableTiles = map.countPassableTiles({ 0, 0 }, { size.x - 1, size.y - 1 });
+    int regions = 0;
+    int largestRegion = 0;
+
+    for (int y = 0; y < size.y; ++y)
+    {
+      for (int x = 0; x < size.x; ++x)
+      {
+        size_t index = (static_cast<size_t>(y) * size.x) + x;
+        if (seen[index] || !map.getTile({ x, y }).isPassable()) continue;
+
+        int regionSize = 0;
+        seen[index] = 1;
+        open.push_back({ x, y });
+        while (!open.empty())
+        {
+          IntVec2 coords = open.front();
+          open.pop_front();
+          ++regionSize;
+
+          IntVec2 const neighbors[] = {
+            { coords.x + 1, coords.y }, { coords.x - 1, coords.y },
+            { coords.x, coords.y + 1 }, { coords.x, coords.y - 1 } };
+          for (auto& neighbor : neighbors)
+          {
+            if (!map.isInBounds(neighbor)) continue;
+            size_t neighborIndex = (static_cast<size_t>(neighbor.y) * size.x) + neighbor.x;
+            if (seen[neighborIndex] || !map.getTile(neighbor).isPassable()) continue;
+            seen[neighborIndex] = 1;
+            open.push_back(neighbor);
+          }
+        }
+
+        ++regions;
+        largestRegion = std::max(largestRegion, regionSize);
+      }
+    }
+
+    json result;
+    result["passable_tiles"] = passableTiles;
+    result["passable_fraction"] = static_cast<double>(passableTiles) / (size.x * size.y);
+    result["regions"] = regions;
+    result["largest_region"] = largestRegion;
+    result["largest_region_fraction"] = (passableTiles > 0) ?
+      static_cast<double>(largestRegion) / passableTiles : 0.0;
+    return result;
+  }
+
+  /// Generate one map and gather its statistics.
+  json generateOne(GameState& game, IntVec2 size, uint64_t seed, MapID& previousMap)
+  {
+    auto& maps = game.maps();
+    size_t entitiesBefore = game.components().category.data().size();
+
+    RNG::setGlobalSeed(seed);
+    auto startTime = std::chrono::steady_clock::now();
+    MapID id = maps.create(size.x, size.y);
+    auto total = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+
+    Map& map = maps.get(id);
+    auto& stats = map.getGenerationStats();
+
+    json result;
+    result["size"] = { size.x, size.y };
+    result["seed"] = seed;
+    result["timing_ms"]["total"] = toMilliseconds(total);
+    result["timing_ms"]["clear_and_start_room"] = toMilliseconds(stats.setup);
+    result["timing_ms"]["feature_placement"] = toMilliseconds(stats.features);
+    result["timing_ms"]["lua_map_script"] = toMilliseconds(stats.script);
+    result["timing_ms"]["tile_entity_creation"] = toMilliseconds(stats.tileEntities);
+    result["features"] = map.getMapFeatures().size();
+    result["entities"]["created"] = game.components().category.data().size() - entitiesBefore;
+    result["entities"]["tile"] = stats.tileEntityCount;
+    result["memory"]["tile_chunks"] = map.getCreatedTileChunkCount();
+    result["memory"]["tile_bytes"] = map.getResidentTileBytes();
+    result["memory"]["process_resident_bytes"] = processResidentBytes();
+    result["connectivity"] = connectivityOf(map);
+
+    // Keep only the newest map around; destroying a map destroys its tile
+    // entities too, so memory figures stay comparable from run to run.
+    if (!previousMap.empty())
+    {
+      maps.destroy(previousMap);
+    }
+    previousMap = id;
+
+    return result;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  START_EASYLOGGINGPP(argc, argv);
+
+  Options options;
+  if (!parseOptions(argc, argv, options))
+  {
+    printUsage();
+    return EXIT_FAILURE;
+  }
+
+  App::setUpLoggers();
+  el::Loggers::reconfigureAllLoggers(el::ConfigurationType::ToStandardOutput, "false");
+
+  json report;
+  report["seed"] = options.seed;
+  report["count"] = options.count;
+  report["warmup"] = options.warmup;
+
+  {
+    GameState game({});
+    MapID previousMap;
+
+    for (auto& size : options.sizes)
+    {
+      // Warm-up runs load the entity definitions and scripts, and settle the
+      // allocator, so they are left out of the results.
+      for (int run = 0; run < options.warmup; ++run)
+      {
+        generateOne(game, size, options.seed + run, previousMap);
+      }
+
+      json runs = json::array();
+      double totalMs = 0.0;
+
+      for (int run = 0; run < options.count; ++run)
+      {
+        json result = generateOne(game, size, options.seed + run, previousMap);
+        totalMs += result["timing_ms"]["total"].get<double>();
+        runs.push_back(result);
+      }
+
+      json sizeReport;
+      sizeReport["size"] = { size.x, size.y };
+      sizeReport["runs"] = runs;
+      sizeReport["mean_total_ms"] = totalMs / options.count;
+      sizeReport["maps_per_second"] = (totalMs > 0.0) ? (options.count * 1000.0 / totalMs) : 0.0;
+      report["sizes"].push_back(sizeReport);
+
+      std::cerr << size.x << "x" << size.y << ": " << (totalMs / options.count) << " ms per map" << std::endl;
+    }
+  }
+
+  std::ofstream file(options.output);
+  if (!file)
+  {
+    std::cerr << "Could not write " << options.output << std::endl;
+    return EXIT_FAILURE;
+  }
+  file << report.dump(2) << std::endl;
+
+  return EXIT_SUCCESS;
+}
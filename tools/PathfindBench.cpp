@@ -0,0 +1,285 @@
+/// Headless pathfinding benchmark.
+///
+/// Generates a map from a fixed seed, without opening a window, picks a
+/// number of random pairs of passable tiles, and times path queries between
+/// them with each search algorithm, both uncached and cached. Results are
+/// written to a JSON file.
+///
+/// Also checks that every path is a chain of single steps ending at its
+/// goal, and that jump point search finds paths costing exactly as much as
+/// A*'s; exits with failure if not.
+///
+/// Usage: PathfindBench [--size WxH] [--queries N] [--seed S] [--output FILE]
+
+#include "stdafx.h"
+
+#include <fstream>
+
+#include "config/Settings.h"
+#include "game/App.h"
+#include "game/GameState.h"
+#include "map/Map.h"
+#include "map/MapFactory.h"
+#include "map/MapPathfinder.h"
+#include "maptile/MapTile.h"
+#include "utilities/RNGUtils.h"
+
+INITIALIZE_EASYLOGGINGPP
+
+namespace
+{
+  struct Options
+  {
+    IntVec2 size{ 128, 128 };
+    int queries = 1000;
+    uint64_t seed = 1;
+    std::string output = "pathfind-bench.json";
+  };
+
+  void printUsage()
+  {
+    std::cerr << "Usage: PathfindBench [--size WxH] [--queries N] [--seed S] [--output FILE]" << std::endl;
+  }
+
+  bool parseOptions(int argc, char* argv[], Options& options)
+  {
+    for (int index = 1; index < argc; ++index)
+    {
+      std::string arg = argv[index];
+      if (index + 1 >= argc) return false;
+      std::string value = argv[++index];
+
+      if (arg == "--size")
+      {
+        IntVec2& size = options.size;
+        if (std::sscanf(value.c_str(), "%dx%d", &size.x, &size.y) != 2 || size.x < 3 || size.y < 3)
+        {
+          return false;
+        }
+      }
+      else if (arg == "--queries")
+      {
+        options.queries = std::max(std::stoi(value), 1);
+      }
+      else if (arg == "--seed")
+      {
+        options.seed = std::stoull(value);
+      }
+      else if (arg == "--output")
+      {
+        options.output = value;
+      }
+      else
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  using Query = std::pair<IntVec2, IntVec2>;
+
+  /// Pick pairs of passable tiles to find paths between.
+  std::vector<Query> pickQueries(Map& map, int count, RNG& rng)
+  {
+    IntVec2 const& size = map.getSize();
+    auto pickPassable = [&]
+    {
+      IntVec2 coords;
+      do
+      {
+        coords = { rng.pick_uniform(0, size.x - 1), rng.pick_uniform(0, size.y - 1) };
+      } while (!map.getTile(coords).isPassable());
+      return coords;
+    };
+
+    std::vector<Query> queries;
+    for (int index = 0; index < count; ++index)
+    {
+      IntVec2 start = pickPassable();
+      IntVec2 goal = pickPassable();
+      queries.push_back({ start, goal });
+    }
+    return queries;
+  }
+
+  /// Cost of a straight and a diagonal step, as MapPathfinder counts them.
+  int const StraightCost = 10;
+  int const DiagonalCost = 14;
+
+  /// Get the cost of a path.
+  /// @return The cost, or -1 if the path isn't a chain of single steps
+  ///         from the start that ends at the goal.
+  int pathCost(Query const& query, std::vector<IntVec2> const& path)
+  {
+    int cost = 0;
+    IntVec2 here = query.first;
+    for (auto& next : path)
+    {
+      int dx = std::abs(next.x - here.x);
+      int dy = std::abs(next.y - here.y);
+      if (std::max(dx, dy) != 1) return -1;
+
+      cost += ((dx != 0) && (dy != 0)) ? DiagonalCost : StraightCost;
+      here = next;
+    }
+    return (here == query.second) ? cost : -1;
+  }
+
+  /// Time a set of queries with one algorithm.
+  /// @param cached   If false, the path cache is cleared before each query.
+  /// @param costs    Filled with the cost of each path found (see
+  ///                 `pathCost`), or -2 if none was.
+  json runQueries(MapPathfinder& pathfinder,
+                  std::vector<Query> const& queries,
+                  MapPathfinder::Algorithm algorithm,
+                  bool cached,
+                  std::vector<int>& costs)
+  {
+    std::vector<IntVec2> path;
+    costs.clear();
+    pathfinder.resetStats();
+    int found = 0;
+    size_t totalLength = 0;
+
+    auto startTime = std::chrono::steady_clock::now();
+    for (auto& query : queries)
+    {
+      if (!cached) pathfinder.clearCache();
+      if (pathfinder.findPath(EntityId::Void, query.first, query.second, algorithm, path))
+      {
+        ++found;
+        totalLength += path.size();
+        costs.push_back(pathCost(query, path));
+      }
+      else
+      {
+        costs.push_back(-2);
+      }
+    }
+    auto total = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+
+    auto& stats = pathfinder.stats();
+    json result;
+    result["total_ms"] = total.count() / 1000.0;
+    result["mean_us"] = static_cast<double>(total.count()) / queries.size();
+    result["found"] = found;
+    result["mean_path_length"] = (found > 0) ? static_cast<double>(totalLength) / found : 0.0;
+    result["nodes_expanded"] = stats.nodesExpanded;
+    result["cache_hit_rate"] = stats.hitRate();
+    result["invalid_paths"] = std::count(costs.begin(), costs.end(), -1);
+    return result;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  START_EASYLOGGINGPP(argc, argv);
+
+  Options options;
+  if (!parseOptions(argc, argv, options))
+  {
+    printUsage();
+    return EXIT_FAILURE;
+  }
+
+  App::setUpLoggers();
+  el::Loggers::reconfigureAllLoggers(el::ConfigurationType::ToStandardOutput, "false");
+
+  json report;
+  report["size"] = { options.size.x, options.size.y };
+  report["queries"] = options.queries;
+  report["seed"] = options.seed;
+  bool consistent = true;
+
+  {
+    GameState game({});
+
+    RNG::setGlobalSeed(options.seed);
+    MapID id = game.maps().create(options.size.x, options.size.y);
+    Map& map = game.maps().get(id);
+    auto& pathfinder = map.pathfinder();
+    pathfinder.setCacheCapacity(static_cast<size_t>(options.queries));
+
+    RNG rng = RNG::named("pathfind-bench");
+    auto queries = pickQueries(map, options.queries, rng);
+
+    std::vector<std::pair<std::string, MapPathfinder::Algorithm>> const algorithms
+    {
+      { "astar", MapPathfinder::Algorithm::AStar },
+      { "jps", MapPathfinder::Algorithm::JumpPoint }
+    };
+
+    std::vector<int> referenceCosts;
+    for (auto& algorithm : algorithms)
+    {
+      std::vector<int> costs;
+      json result;
+      result["uncached"] = runQueries(pathfinder, queries, algorithm.second, false, costs);
+
+      // Fill the cache, then run the same queries again from one step along
+      // each path, as a mover following its path would on its next turn.
+      std::vector<int> cachedCosts;
+      pathfinder.clearCache();
+      runQueries(pathfinder, queries, algorithm.second, true, cachedCosts);
+      std::vector<Query> nextSteps;
+      std::vector<IntVec2> path;
+      for (auto& query : queries)
+      {
+        pathfinder.findPath(EntityId::Void, query.first, query.second, algorithm.second, path);
+        nextSteps.push_back({ path.empty() ? query.first : path.front(), query.second });
+      }
+      result["cached"] = runQueries(pathfinder, nextSteps, algorithm.second, true, cachedCosts);
+
+      // Cached paths are the ones already found, so they must be valid too.
+      if ((result["uncached"]["invalid_paths"].get<int>() != 0) ||
+          (result["cached"]["invalid_paths"].get<int>() != 0))
+      {
+        consistent = false;
+      }
+
+      // Both searches should reach exactly the same goals, at the same cost.
+      if (referenceCosts.empty())
+      {
+        referenceCosts = costs;
+      }
+      else
+      {
+        int reachabilityMismatches = 0;
+        int costMismatches = 0;
+        for (size_t index = 0; index < costs.size(); ++index)
+        {
+          if ((costs[index] == -2) != (referenceCosts[index] == -2)) ++reachabilityMismatches;
+          else if (costs[index] != referenceCosts[index]) ++costMismatches;
+        }
+        result["reachability_mismatches"] = reachabilityMismatches;
+        result["cost_mismatches"] = costMismatches;
+        if ((reachabilityMismatches != 0) || (costMismatches != 0)) consistent = false;
+      }
+
+      report["algorithms"][algorithm.first] = result;
+
+      std::cerr << algorithm.first << ": "
+        << result["uncached"]["mean_us"].get<double>() << " us per query uncached, "
+        << result["cached"]["mean_us"].get<double>() << " us cached" << std::endl;
+    }
+  }
+
+  std::ofstream file(options.output);
+  if (!file)
+  {
+    std::cerr << "Could not write " << options.output << std::endl;
+    return EXIT_FAILURE;
+  }
+  report["consistent"] = consistent;
+  file << report.dump(2) << std::endl;
+
+  if (!consistent)
+  {
+    std::cerr << "Paths found were invalid, or differ between algorithms; see " << options.output << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
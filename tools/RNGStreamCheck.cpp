@@ -0,0 +1,129 @@
+/// Self-check of the random number streams.
+///
+/// Checks the PCG32 engine against the reference implementation's output,
+/// that named and split streams depend only on their identity (not on what
+/// has been drawn elsewhere), that different identities give different
+/// sequences, and that uniform picks stay in range and are evenly spread.
+/// Exits with failure if any check fails.
+///
+/// Usage: RNGStreamCheck
+
+#include "stdafx.h"
+
+#include "tools/Check.h"
+#include "utilities/RNGUtils.h"
+
+INITIALIZE_EASYLOGGINGPP
+
+namespace
+{
+  /// Number of values compared when checking two streams against each other.
+  int const SequenceLength = 64;
+
+  std::vector<int> draw(RNG rng)
+  {
+    std::vector<int> values;
+    for (int index = 0; index < SequenceLength; ++index)
+    {
+      values.push_back(rng.pick_uniform(0, 1 << 30));
+    }
+    return values;
+  }
+
+  void checkEngine()
+  {
+    // First outputs of the reference pcg32 demo, seeded with (42, 54).
+    uint32_t const expected[] = { 0xa15c02b7, 0x7b47f409, 0xba1d3330, 0x83d2f293, 0xbfa4784b, 0xcbed606e };
+    RNG::Engine engine{ 42, 54 };
+    for (auto value : expected)
+    {
+      EXPECT(engine() == value);
+    }
+  }
+
+  void checkNamedStreams()
+  {
+    RNG::setGlobalSeed(12345);
+    auto map0 = draw(RNG::named("map/0"));
+
+    // Drawing from the root stream, or from other streams, changes nothing.
+    for (int index = 0; index < 100; ++index)
+    {
+      the_RNG.pick_uniform(0, 100);
+    }
+    draw(RNG::named("map/1"));
+    EXPECT(draw(RNG::named("map/0")) == map0);
+
+    // Different names, and different global seeds, give different streams.
+    EXPECT(draw(RNG::named("map/1")) != map0);
+    EXPECT(draw(RNG::named("map/00")) != map0);
+
+    RNG::setGlobalSeed(12346);
+    EXPECT(draw(RNG::named("map/0")) != map0);
+
+    RNG::setGlobalSeed(12345);
+    EXPECT(draw(RNG::named("map/0")) == map0);
+    EXPECT(RNG::globalSeed() == 12345);
+  }
+
+  void checkSplitStreams()
+  {
+    RNG parent{ 7, 3 };
+    auto child = draw(parent.split(1));
+
+    // Children don't depend on how far their parent has got.
+    parent.pick_uniform(0, 100);
+    EXPECT(draw(parent.split(1)) == child);
+
+    EXPECT(draw(parent.split(2)) != child);
+    EXPECT(draw(RNG{ 7, 4 }.split(1)) != child);
+    EXPECT(draw(RNG{ 8, 3 }.split(1)) != child);
+    EXPECT(draw(parent.split("a")) == draw(parent.split("a")));
+    EXPECT(draw(parent.split("a")) != draw(parent.split("b")));
+
+    // A child isn't just its parent over again.
+    EXPECT(draw(parent.split(0)) != draw(RNG{ 7, 3 }));
+  }
+
+  void checkUniform()
+  {
+    int const buckets = 10;
+    int const picks = 100000;
+    std::vector<int> counts(buckets, 0);
+    bool inRange = true;
+
+    RNG rng = RNG::named("check/uniform");
+    for (int index = 0; index < picks; ++index)
+    {
+      int value = rng.pick_uniform(0, buckets - 1);
+      if ((value < 0) || (value >= buckets))
+      {
+        inRange = false;
+        continue;
+      }
+      ++counts[value];
+    }
+    EXPECT(inRange);
+
+    // Chi-squared with 9 degrees of freedom; 27.9 is the 0.1% critical value.
+    double expected = static_cast<double>(picks) / buckets;
+    double chiSquared = 0;
+    for (int count : counts)
+    {
+      chiSquared += ((count - expected) * (count - expected)) / expected;
+    }
+    EXPECT(chiSquared < 27.9);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  START_EASYLOGGINGPP(argc, argv);
+
+  checkEngine();
+  checkNamedStreams();
+  checkSplitStreams();
+  checkUniform();
+
+  return Check::result("RNGStreamCheck");
+}
@@ -0,0 +1,162 @@
+/// Self-check of SpatialGrid.
+///
+/// Runs random inserts, moves and removals, some at negative coordinates
+/// and some within a single bucket, and checks rectangle and radius queries
+/// against a brute-force search of every entity. Exits with failure if any
+/// check fails.
+///
+/// Usage: SpatialGridCheck
+
+#include "stdafx.h"
+
+#include <map>
+#include <random>
+
+#include "tools/Check.h"
+#include "types/SpatialGrid.h"
+
+INITIALIZE_EASYLOGGINGPP
+
+namespace
+{
+  /// Entities found by a query, with their coordinates.
+  using Found = std::map<EntityId, IntVec2>;
+
+  /// Add an entity found by a query; a second visit to the same entity
+  /// spoils the result, so it won't match what was expected.
+  void collect(Found& found, EntityId entity, IntVec2 coords)
+  {
+    if (!found.emplace(entity, coords).second) found[entity] = IntVec2(INT_MIN, INT_MIN);
+  }
+
+  int random(std::mt19937& generator, int min, int max)
+  {
+    return std::uniform_int_distribution<int>(min, max)(generator);
+  }
+
+  void checkBasics()
+  {
+    SpatialGrid grid{ 4 };
+    EntityId a{ 1 };
+    EntityId b{ 2 };
+
+    grid.insert(a, { 1, 1 });
+    grid.insert(b, { -1, -1 });
+    EXPECT(grid.size() == 2);
+    EXPECT(grid.contains(a));
+
+    // Moving within a bucket and into another one.
+    grid.insert(a, { 2, 3 });
+    grid.insert(b, { 9, -6 });
+    grid.insert(b, { 9, -6 });
+    EXPECT(grid.size() == 2);
+
+    Found found;
+    grid.forEachInRect({ -10, -10 }, { 10, 10 }, [&](EntityId entity, IntVec2 coords)
+    {
+      collect(found, entity, coords);
+    });
+    EXPECT(found == Found({ { a, IntVec2(2, 3) }, { b, IntVec2(9, -6) } }));
+
+    // Upside-down rectangles are empty.
+    int count = 0;
+    grid.forEachInRect({ 10, 10 }, { -10, -10 }, [&](EntityId, IntVec2) { ++count; });
+    EXPECT(count == 0);
+
+    grid.remove(a);
+    grid.remove(a);
+    EXPECT(!grid.contains(a));
+    EXPECT(grid.size() == 1);
+
+    grid.clear();
+    EXPECT(grid.size() == 0);
+    grid.forEachInRadius({ 9, -6 }, 3, [&](EntityId, IntVec2) { ++count; });
+    EXPECT(count == 0);
+  }
+
+  void checkAgainstBruteForce(int bucketSide)
+  {
+    std::mt19937 generator(bucketSide);
+    SpatialGrid grid{ bucketSide };
+    Found locations;
+
+    int rectMismatches = 0;
+    int radiusMismatches = 0;
+
+    for (int step = 0; step < 5000; ++step)
+    {
+      EntityId entity{ static_cast<uint64_t>(random(generator, 1, 200)) };
+      int action = random(generator, 0, 9);
+      if (action == 0)
+      {
+        grid.remove(entity);
+        locations.erase(entity);
+      }
+      else if ((action <= 3) && (locations.count(entity) != 0))
+      {
+        // A short step, which usually stays in the same bucket.
+        IntVec2 coords = locations[entity] + IntVec2(random(generator, -1, 1), random(generator, -1, 1));
+        grid.insert(entity, coords);
+        locations[entity] = coords;
+      }
+      else
+      {
+        IntVec2 coords{ random(generator, -40, 40), random(generator, -40, 40) };
+        grid.insert(entity, coords);
+        locations[entity] = coords;
+      }
+
+      if ((step % 50) != 0) continue;
+
+      IntVec2 upperLeft{ random(generator, -45, 45), random(generator, -45, 45) };
+      IntVec2 lowerRight = upperLeft + IntVec2(random(generator, 0, 30), random(generator, 0, 30));
+      Found expected;
+      Found found;
+      for (auto& pair : locations)
+      {
+        IntVec2 coords = pair.second;
+        if ((coords.x >= upperLeft.x) && (coords.x <= lowerRight.x) &&
+            (coords.y >= upperLeft.y) && (coords.y <= lowerRight.y))
+        {
+          expected.emplace(pair);
+        }
+      }
+      grid.forEachInRect(upperLeft, lowerRight, [&](EntityId id, IntVec2 coords)
+      {
+        collect(found, id, coords);
+      });
+      if (found != expected) ++rectMismatches;
+
+      IntVec2 center{ random(generator, -45, 45), random(generator, -45, 45) };
+      int radius = random(generator, 0, 15);
+      expected.clear();
+      found.clear();
+      for (auto& pair : locations)
+      {
+        IntVec2 offset = pair.second - center;
+        if ((offset.x * offset.x) + (offset.y * offset.y) <= radius * radius) expected.emplace(pair);
+      }
+      grid.forEachInRadius(center, radius, [&](EntityId id, IntVec2 coords)
+      {
+        collect(found, id, coords);
+      });
+      if (found != expected) ++radiusMismatches;
+    }
+
+    EXPECT(grid.size() == locations.size());
+    EXPECT(rectMismatches == 0);
+    EXPECT(radiusMismatches == 0);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  START_EASYLOGGINGPP(argc, argv);
+
+  checkBasics();
+  checkAgainstBruteForce(1);
+  checkAgainstBruteForce(3);
+  checkAgainstBruteForce(8);
+
+  return Check::result("SpatialGridCheck");
+}
@@ -0,0 +1,162 @@
+#include "stdafx.h"
+
+#include "types/Atom.h"
+
+#include <array>
+#include <mutex>
+
+namespace
+{
+  /// Process-wide table of interned strings.
+  /// Strings are stored in fixed-size blocks that never move, so an Atom can
+  /// be turned back into a string without taking the lock; only interning a
+  /// string has to be serialized.
+  class SymbolTable
+  {
+  public:
+    static constexpr Atom::Value blockBits = 12;
+    static constexpr Atom::Value blockSize = 1 << blockBits;
+    static constexpr Atom::Value maxBlocks = 1 << 12;
+
+    SymbolTable()
+      :
+      m_count{ 0 }
+    {
+      // Value 0 is always the empty string.
+      intern("");
+    }
+
+    Atom::Value intern(std::string const& str)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      auto iter = m_values.find(str);
+      if (iter != m_values.end())
+      {
+        return iter->second;
+      }
+
+      Atom::Value value = m_count;
+      Atom::Value block = value >> blockBits;
+      Assert("Atom", block < maxBlocks, "Symbol table is full");
+
+      if (!m_blocks[block])
+      {
+        m_blocks[block].reset(NEW std::string[blockSize]);
+      }
+
+      m_blocks[block][value & (blockSize - 1)] = str;
+      m_values[str] = value;
+      ++m_count;
+      return value;
+    }
+
+    std::string const& lookup(Atom::Value value) const
+    {
+      return m_blocks[value >> blockBits][value & (blockSize - 1)];
+    }
+
+  private:
+    std::mutex m_mutex;
+    std::unordered_map<std::string, Atom::Value> m_values;
+    std::array<std::unique_ptr<std::string[]>, maxBlocks> m_blocks;
+    Atom::Value m_count;
+  };
+
+  SymbolTable& symbols()
+  {
+    static SymbolTable table;
+    return table;
+  }
+}
+
+Atom::Atom()
+  :
+  m_value{ 0 }
+{}
+
+Atom::Atom(std::string const& str)
+  :
+  m_value{ str.empty() ? 0 : symbols().intern(str) }
+{}
+
+Atom::Atom(char const* str)
+  :
+  m_value{ (str == nullptr || *str == '\0') ? 0 : symbols().intern(str) }
+{}
+
+void to_json(json& j, Atom const& atom)
+{
+  j = atom.str();
+}
+
+void from_json(json const& j, Atom& atom)
+{
+  atom = j.is_string() ? Atom(j.get<std::string>()) : Atom();
+}
+
+std::string const& Atom::str() const
+{
+  return symbols().lookup(m_value);
+}
+
+char const* Atom::c_str() const
+{
+  return str().c_str();
+}
+
+bool Atom::empty() const
+{
+  return m_value == 0;
+}
+
+Atom::Value Atom::value() const
+{
+  return m_value;
+}
+
+Atom::operator std::string const&() const
+{
+  return str();
+}
+
+bool Atom::operator==(Atom const& other) const
+{
+  return m_value == other.m_value;
+}
+
+bool Atom::operator!=(Atom const& other) const
+{
+  return m_value != other.m_value;
+}
+
+bool Atom::operator<(Atom const& other) const
+{
+  return m_value < other.m_value;
+}
+
+bool Atom::operator==(std::string const& other) const
+{
+  return str() == other;
+}
+
+bool Atom::operator!=(std::string const& other) const
+{
+  return str() != other;
+}
+
+bool Atom::operator==(char const* other) const
+{
+  return str() == other;
+}
+
+bool Atom::operator!=(char const* other) const
+{
+  return str() != other;
+}
+
+std::ostream& operator<<(std::ostream& stream, Atom const& atom)
+{
+  stream << atom.str();
+  return stream;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+
+#include "json.hpp"
+using json = ::nlohmann::json;
+
+/// Definition of an Atom, an interned string.
+/// Each Atom is a 32-bit handle into a process-wide symbol table, so that
+/// copying, comparing and hashing one is an integer operation. Atoms are used
+/// for identifiers that are compared and hashed constantly (entity categories,
+/// materials, map IDs) and are converted back to strings at the JSON and Lua
+/// boundaries.
+///
+/// Atoms are never freed, so they should only be made from identifiers, not
+/// from arbitrary text.
+class Atom
+{
+  friend struct std::hash<Atom>;
+
+public:
+  /// Underlying integer type of an Atom.
+  using Value = uint32_t;
+
+  /// Construct the empty Atom.
+  Atom();
+
+  /// Construct an Atom from a string, interning it if necessary.
+  Atom(std::string const& str);
+
+  /// Construct an Atom from a string, interning it if necessary.
+  Atom(char const* str);
+
+  friend void to_json(json& j, Atom const& atom);
+  friend void from_json(json const& j, Atom& atom);
+
+  /// Get the string this Atom refers to.
+  std::string const& str() const;
+
+  /// Get the string this Atom refers to.
+  char const* c_str() const;
+
+  /// Get whether this is the empty Atom.
+  bool empty() const;
+
+  /// Get the underlying integer value of this Atom.
+  /// Values are only valid for the lifetime of the process.
+  Value value() const;
+
+  operator std::string const&() const;
+
+  bool operator==(Atom const& other) const;
+  bool operator!=(Atom const& other) const;
+  bool operator<(Atom const& other) const;
+
+  bool operator==(std::string const& other) const;
+  bool operator!=(std::string const& other) const;
+  bool operator==(char const* other) const;
+  bool operator!=(char const* other) const;
+
+  friend std::ostream& operator<<(std::ostream& stream, Atom const& atom);
+
+private:
+  Value m_value;
+};
+
+inline bool operator==(std::string const& first, Atom const& second)
+{
+  return second == first;
+}
+
+inline bool operator!=(std::string const& first, Atom const& second)
+{
+  return second != first;
+}
+
+inline bool operator==(char const* first, Atom const& second)
+{
+  return second == first;
+}
+
+inline bool operator!=(char const* first, Atom const& second)
+{
+  return second != first;
+}
+
+namespace std
+{
+  /// Hash functor for Atom
+  template<>
+  struct hash<Atom>
+  {
+    std::size_t operator()(Atom const& key) const
+    {
+      return std::hash<Atom::Value>()(key.m_value);
+    }
+  };
+}
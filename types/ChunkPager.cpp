@@ -0,0 +1,178 @@
+#include "stdafx.h"
+
+#include "types/ChunkPager.h"
+
+#include <boost/filesystem.hpp>
+#include <cstring>
+#include <fstream>
+
+namespace fs = boost::filesystem;
+namespace bi = boost::interprocess;
+
+namespace
+{
+  /// Marks a slot as holding a chunk ("MHCK").
+  uint32_t const SlotMagic = 0x4b43484d;
+
+  /// Version of the slot format.
+  uint32_t const SlotVersion = 1;
+
+  /// Index of the chunk being written, when no chunk is.
+  size_t const NoChunk = static_cast<size_t>(-1);
+}
+
+ChunkPager::ChunkPager(std::string name, size_t chunkCount, size_t chunkBytes)
+  :
+  m_chunkCount{ chunkCount },
+  m_chunkBytes{ chunkBytes },
+  m_stored(chunkCount, false),
+  m_writing{ NoChunk }
+{
+  // Keep slots 16-byte aligned so chunk data can be copied efficiently.
+  m_slotBytes = ((sizeof(SlotHeader) + chunkBytes + 15) / 16) * 16;
+
+  fs::path path = fs::temp_directory_path() / fs::unique_path(name + "-%%%%-%%%%-%%%%.chunks");
+  m_path = path.string();
+}
+
+ChunkPager::~ChunkPager()
+{
+  if (m_writer.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stopping = true;
+    }
+    m_wake.notify_all();
+    m_writer.join();
+  }
+
+  if (m_file)
+  {
+    m_region.reset();
+    m_file.reset();
+    bi::file_mapping::remove(m_path.c_str());
+  }
+}
+
+void ChunkPager::store(size_t index, void const* data)
+{
+  Assert("ChunkPager", index < m_chunkCount, "chunk index " << index << " out of range");
+  if (!m_file) open();
+
+  char const* bytes = static_cast<char const*>(data);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // A chunk that is already queued just has its data replaced.
+    auto& buffer = m_pending[index];
+    if (buffer.empty()) m_queue.push_back(index);
+    buffer.assign(bytes, bytes + m_chunkBytes);
+    m_stored[index] = true;
+  }
+  m_wake.notify_one();
+}
+
+bool ChunkPager::load(size_t index, void* data)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (index >= m_chunkCount || !m_stored[index]) return false;
+
+  auto iter = m_pending.find(index);
+  if (iter != m_pending.end())
+  {
+    std::memcpy(data, iter->second.data(), m_chunkBytes);
+    return true;
+  }
+
+  // If the chunk is being written right now, wait for it to land.
+  m_written.wait(lock, [&] { return m_writing != index; });
+
+  char const* slot = static_cast<char const*>(m_region->get_address()) + slotOffset(index);
+  SlotHeader header;
+  std::memcpy(&header, slot, sizeof(header));
+
+  if (header.magic != SlotMagic || header.version != SlotVersion ||
+      header.index != index || header.bytes != m_chunkBytes)
+  {
+    CLOG(ERROR, "ChunkPager") << "Chunk " << index << " in " << m_path << " is corrupt";
+    return false;
+  }
+
+  std::memcpy(data, slot + sizeof(header), m_chunkBytes);
+  return true;
+}
+
+bool ChunkPager::contains(size_t index) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return (index < m_chunkCount) && m_stored[index];
+}
+
+size_t ChunkPager::pendingWrites() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_queue.size();
+}
+
+size_t ChunkPager::chunkBytes() const
+{
+  return m_chunkBytes;
+}
+
+void ChunkPager::open()
+{
+  size_t fileBytes = m_slotBytes * m_chunkCount;
+
+  // Create a sparse file of the right size; slots that are never written
+  // never take up any disk space.
+  {
+    std::filebuf file;
+    file.open(m_path, std::ios::out | std::ios::binary | std::ios::trunc);
+    Assert("ChunkPager", file.is_open(), "could not create chunk file " << m_path);
+    file.pubseekoff(static_cast<std::streamoff>(fileBytes) - 1, std::ios::beg);
+    file.sputc(0);
+  }
+
+  m_file.reset(new bi::file_mapping(m_path.c_str(), bi::read_write));
+  m_region.reset(new bi::mapped_region(*m_file, bi::read_write, 0, fileBytes));
+  m_writer = std::thread(&ChunkPager::writeQueuedChunks, this);
+
+  CLOG(DEBUG, "ChunkPager") << "Paging " << m_chunkCount << " chunks of " << m_chunkBytes <<
+    " bytes to " << m_path;
+}
+
+void ChunkPager::writeQueuedChunks()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  while (true)
+  {
+    m_wake.wait(lock, [&] { return m_stopping || !m_queue.empty(); });
+    if (m_queue.empty()) return;
+
+    size_t index = m_queue.front();
+    m_queue.pop_front();
+    std::vector<char> data = std::move(m_pending[index]);
+    m_pending.erase(index);
+    m_writing = index;
+    lock.unlock();
+
+    // Copying into the mapping is what may touch the disk, so do it
+    // without holding the lock.
+    char* slot = static_cast<char*>(m_region->get_address()) + slotOffset(index);
+    SlotHeader header{ SlotMagic, SlotVersion, static_cast<uint32_t>(index), static_cast<uint32_t>(m_chunkBytes) };
+    std::memcpy(slot, &header, sizeof(header));
+    std::memcpy(slot + sizeof(header), data.data(), m_chunkBytes);
+    m_region->flush(slotOffset(index), m_slotBytes, true);
+
+    lock.lock();
+    m_writing = NoChunk;
+    m_written.notify_all();
+  }
+}
+
+size_t ChunkPager::slotOffset(size_t index) const
+{
+  return index * m_slotBytes;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+/// Pages fixed-size chunks of plain data out to a scratch file, and back.
+/// Each chunk has its own slot in the file, holding a small header followed
+/// by the chunk's bytes. The file is memory-mapped, so reading a chunk back
+/// is a copy out of the mapping; writes are queued and done on a background
+/// thread, so storing a chunk never waits on the disk.
+/// The scratch file is created the first time a chunk is stored, and deleted
+/// when the pager is destroyed.
+class ChunkPager
+{
+public:
+  /// Constructor.
+  /// @param name         Name used for the scratch file; should be unique
+  ///                     among the pagers in use.
+  /// @param chunkCount   Number of chunk slots.
+  /// @param chunkBytes   Size of one chunk, in bytes.
+  ChunkPager(std::string name, size_t chunkCount, size_t chunkBytes);
+
+  ChunkPager(ChunkPager const&) = delete;
+  ChunkPager& operator=(ChunkPager const&) = delete;
+
+  virtual ~ChunkPager();
+
+  /// Store a chunk. The data is copied before this returns, so the caller
+  /// is free to release it straight away.
+  void store(size_t index, void const* data);
+
+  /// Load a chunk that was stored earlier.
+  /// @return True if the chunk was loaded, false if it was never stored.
+  bool load(size_t index, void* data);
+
+  /// Get whether a chunk has been stored.
+  bool contains(size_t index) const;
+
+  /// Get the number of chunks waiting to be written out.
+  size_t pendingWrites() const;
+
+  /// Get the size of one chunk, in bytes.
+  size_t chunkBytes() const;
+
+protected:
+  /// Header at the start of each slot in the scratch file.
+  struct SlotHeader
+  {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t index;
+    uint32_t bytes;
+  };
+
+  /// Create and map the scratch file, and start the writer thread.
+  void open();
+
+  /// Body of the writer thread.
+  void writeQueuedChunks();
+
+  /// Get the offset of a slot in the scratch file.
+  size_t slotOffset(size_t index) const;
+
+private:
+  /// Path of the scratch file.
+  std::string m_path;
+
+  /// Number of chunk slots.
+  size_t m_chunkCount;
+
+  /// Size of one chunk, in bytes.
+  size_t m_chunkBytes;
+
+  /// Size of one slot (header plus chunk), in bytes.
+  size_t m_slotBytes;
+
+  /// Scratch file and its mapping; empty until the first store.
+  std::unique_ptr<boost::interprocess::file_mapping> m_file;
+  std::unique_ptr<boost::interprocess::mapped_region> m_region;
+
+  /// Whether each slot holds a chunk.
+  std::vector<bool> m_stored;
+
+  /// Chunks waiting to be written, in the order they were stored.
+  std::deque<size_t> m_queue;
+
+  /// Data of chunks waiting to be written, by index. Loads check here
+  /// first, so a chunk can be read back before it has reached the file.
+  std::unordered_map<size_t, std::vector<char>> m_pending;
+
+  /// Guards everything shared with the writer thread.
+  mutable std::mutex m_mutex;
+
+  /// Wakes the writer thread when there is work, or it should stop.
+  std::condition_variable m_wake;
+
+  /// Index of the chunk the writer thread is copying into the file, if any.
+  size_t m_writing;
+
+  /// Signalled whenever the writer thread finishes a chunk.
+  std::condition_variable m_written;
+
+  /// Whether the writer thread should stop.
+  bool m_stopping = false;
+
+  /// The writer thread.
+  std::thread m_writer;
+};
@@ -0,0 +1,363 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "types/Vec2.h"
+#include "utilities/MathUtils.h"
+
+/// Two-dimensional grid of values, stored as square chunks that are only
+/// allocated once something is written to them.
+/// Reading from a chunk that has never been written returns the grid's
+/// default value, so memory use scales with the area actually touched rather
+/// than the nominal size of the grid. Callers address cells by coordinates;
+/// chunk boundaries are invisible unless asked for.
+/// Chunks can also be evicted, e.g. to page them out to disk; an evicted
+/// chunk is brought back through the chunk initializer the next time any of
+/// its cells is accessed, reads included.
+template <class T, int ChunkSide = 32>
+class ChunkedGrid2D
+{
+public:
+  /// Length of one side of a chunk, in cells.
+  static constexpr int chunkSide = ChunkSide;
+
+  /// Number of cells in a chunk.
+  static constexpr int chunkArea = ChunkSide * ChunkSide;
+
+  /// One chunk of cells, stored in coordinate order (y, x).
+  using Chunk = std::array<T, chunkArea>;
+
+  /// Function called on a newly allocated chunk, after it has been filled
+  /// with the default value. Takes the chunk's coordinates (in chunks) and
+  /// the chunk itself.
+  using ChunkInitializer = std::function<void(IntVec2, Chunk&)>;
+
+  /// Constructor for an empty grid.
+  ChunkedGrid2D() :
+    m_size{ 0, 0 },
+    m_chunkCount{ 0, 0 },
+    m_defaultValue{}
+  {}
+
+  /// Constructor.
+  /// @param size          The size of the grid, in cells.
+  /// @param defaultValue  The value of cells in unallocated chunks.
+  ChunkedGrid2D(IntVec2 size, T const& defaultValue = T()) :
+    m_size{ size },
+    m_chunkCount{ (size.x + ChunkSide - 1) / ChunkSide, (size.y + ChunkSide - 1) / ChunkSide },
+    m_defaultValue{ defaultValue }
+  {
+    m_chunks.resize(static_cast<size_t>(m_chunkCount.x) * static_cast<size_t>(m_chunkCount.y));
+    m_evicted.resize(m_chunks.size(), false);
+  }
+
+  /// Copy constructor. Allocated chunks are copied; the chunk initializer
+  /// is not, as it is usually bound to the owner of the original grid.
+  ChunkedGrid2D(ChunkedGrid2D const& other) :
+    m_size{ other.m_size },
+    m_chunkCount{ other.m_chunkCount },
+    m_defaultValue{ other.m_defaultValue },
+    m_evicted(other.m_evicted),
+    m_allocatedChunks{ other.m_allocatedChunks }
+  {
+    m_chunks.reserve(other.m_chunks.size());
+    for (auto& chunk : other.m_chunks)
+    {
+      m_chunks.emplace_back(chunk ? new Chunk(*chunk) : nullptr);
+    }
+  }
+
+  ChunkedGrid2D(ChunkedGrid2D&& other) = default;
+
+  /// Copy assignment. This grid keeps its own chunk initializer.
+  ChunkedGrid2D& operator=(ChunkedGrid2D const& other)
+  {
+    ChunkedGrid2D copy{ other };
+    copy.m_initializer = std::move(m_initializer);
+    return (*this = std::move(copy));
+  }
+
+  ChunkedGrid2D& operator=(ChunkedGrid2D&& other) = default;
+
+  /// Set the function called to initialize newly allocated chunks.
+  void setChunkInitializer(ChunkInitializer initializer)
+  {
+    m_initializer = initializer;
+  }
+
+  /// Get the size of the grid, in cells.
+  IntVec2 const& size() const
+  {
+    return m_size;
+  }
+
+  /// Get the size of the grid, in chunks.
+  IntVec2 const& chunkCount() const
+  {
+    return m_chunkCount;
+  }
+
+  /// Get whether coordinates are inside the grid.
+  bool contains(IntVec2 coords) const
+  {
+    return (coords.x >= 0) && (coords.y >= 0) && (coords.x < m_size.x) && (coords.y < m_size.y);
+  }
+
+  /// Get the value of unallocated cells.
+  T const& defaultValue() const
+  {
+    return m_defaultValue;
+  }
+
+  /// Set the value of unallocated cells. Allocated chunks are unaffected.
+  void setDefaultValue(T const& value)
+  {
+    m_defaultValue = value;
+  }
+
+  /// Get a value without allocating anything, or bounds checking.
+  /// The one exception is a cell in an evicted chunk, which is reloaded.
+  T const& get(IntVec2 coords) const
+  {
+    size_t index = chunkIndex(coords);
+    Chunk const* chunk = m_chunks[index].get();
+    if (!chunk && m_evicted[index])
+    {
+      chunk = &(const_cast<ChunkedGrid2D*>(this)->chunkAt(index));
+    }
+    return chunk ? (*chunk)[localIndex(coords)] : m_defaultValue;
+  }
+
+  /// Get a value without allocating anything, clamping the coordinates to
+  /// the nearest edge of the grid if they're outside it.
+  T const& getClamped(IntVec2 coords) const
+  {
+    return get(clamp(coords));
+  }
+
+  /// Get a writable reference to a value, without bounds checking.
+  /// Allocates the value's chunk if necessary.
+  T& operator[](IntVec2 coords)
+  {
+    return chunkAt(chunkIndex(coords))[localIndex(coords)];
+  }
+
+  /// Get a writable reference to a value, allocating its chunk if necessary.
+  /// @throws std::out_of_range if the coordinates are outside the grid.
+  T& at(IntVec2 coords)
+  {
+    if (!contains(coords)) throw std::out_of_range("ChunkedGrid2D coordinates out of range");
+    return (*this)[coords];
+  }
+
+  /// Get a writable reference to a value, clamping the coordinates to the
+  /// nearest edge of the grid and allocating its chunk if necessary.
+  T& atClamped(IntVec2 coords)
+  {
+    return (*this)[clamp(coords)];
+  }
+
+  /// Get whether a chunk has been allocated.
+  /// @param chunkCoords  Coordinates of the chunk, in chunks.
+  bool isChunkAllocated(IntVec2 chunkCoords) const
+  {
+    return m_chunks[(chunkCoords.y * m_chunkCount.x) + chunkCoords.x] != nullptr;
+  }
+
+  /// Get whether a chunk has been evicted, and not brought back yet.
+  /// @param chunkCoords  Coordinates of the chunk, in chunks.
+  bool isChunkEvicted(IntVec2 chunkCoords) const
+  {
+    return m_evicted[(chunkCoords.y * m_chunkCount.x) + chunkCoords.x];
+  }
+
+  /// Get the linear index of a chunk, for keying per-chunk data kept
+  /// alongside the grid.
+  /// @param chunkCoords  Coordinates of the chunk, in chunks.
+  size_t chunkIndexOf(IntVec2 chunkCoords) const
+  {
+    return (static_cast<size_t>(chunkCoords.y) * m_chunkCount.x) + chunkCoords.x;
+  }
+
+  /// Get the coordinates, in chunks, of the chunk containing a cell.
+  static IntVec2 chunkCoordsOf(IntVec2 coords)
+  {
+    return{ coords.x / ChunkSide, coords.y / ChunkSide };
+  }
+
+  /// Get the number of chunks allocated.
+  size_t allocatedChunkCount() const
+  {
+    return m_allocatedChunks;
+  }
+
+  /// Release a chunk, returning its cells to the default value.
+  void releaseChunk(IntVec2 chunkCoords)
+  {
+    size_t index = chunkIndexOf(chunkCoords);
+    freeChunk(index);
+    m_evicted[index] = false;
+  }
+
+  /// Evict a chunk. Its memory is freed, and the chunk initializer is called
+  /// to bring it back the next time it is accessed. It's up to the caller to
+  /// save the chunk somewhere beforehand.
+  void evictChunk(IntVec2 chunkCoords)
+  {
+    size_t index = chunkIndexOf(chunkCoords);
+    if (m_chunks[index])
+    {
+      freeChunk(index);
+      m_evicted[index] = true;
+    }
+  }
+
+  /// Release every chunk.
+  void clear()
+  {
+    for (auto& chunk : m_chunks) chunk.reset();
+    std::fill(m_evicted.begin(), m_evicted.end(), false);
+    m_allocatedChunks = 0;
+  }
+
+  /// Call a functor for every allocated chunk.
+  /// @param functor  Functor taking (IntVec2 chunkCoords, Chunk&).
+  template <class Functor>
+  void forEachAllocatedChunk(Functor functor)
+  {
+    for (int cy = 0; cy < m_chunkCount.y; ++cy)
+    {
+      for (int cx = 0; cx < m_chunkCount.x; ++cx)
+      {
+        auto& chunk = m_chunks[(cy * m_chunkCount.x) + cx];
+        if (chunk) functor(IntVec2{ cx, cy }, *chunk);
+      }
+    }
+  }
+
+  /// Call a functor for every cell inside the grid in an allocated chunk.
+  /// @param functor  Functor taking (IntVec2 coords, T&).
+  template <class Functor>
+  void forEachAllocated(Functor functor)
+  {
+    forEachAllocatedChunk([&](IntVec2 chunkCoords, Chunk& chunk)
+    {
+      forEachCellOf(chunkCoords, chunk, functor);
+    });
+  }
+
+  /// Call a functor for every cell inside the grid in an allocated chunk.
+  /// @param functor  Functor taking (IntVec2 coords, T const&).
+  template <class Functor>
+  void forEachAllocated(Functor functor) const
+  {
+    for (int cy = 0; cy < m_chunkCount.y; ++cy)
+    {
+      for (int cx = 0; cx < m_chunkCount.x; ++cx)
+      {
+        auto& chunk = m_chunks[(cy * m_chunkCount.x) + cx];
+        if (chunk) forEachCellOf(IntVec2{ cx, cy }, static_cast<Chunk const&>(*chunk), functor);
+      }
+    }
+  }
+
+  /// Get the number of bytes used by allocated chunks and the chunk table,
+  /// not counting any memory the values themselves own.
+  size_t storageBytes() const
+  {
+    return (m_allocatedChunks * sizeof(Chunk)) + (m_chunks.capacity() * sizeof(std::unique_ptr<Chunk>));
+  }
+
+protected:
+  size_t chunkIndex(IntVec2 coords) const
+  {
+    return (static_cast<size_t>(coords.y / ChunkSide) * m_chunkCount.x) + (coords.x / ChunkSide);
+  }
+
+  static size_t localIndex(IntVec2 coords)
+  {
+    return ((coords.y % ChunkSide) * ChunkSide) + (coords.x % ChunkSide);
+  }
+
+  /// Get a chunk, allocating and initializing it if necessary.
+  Chunk& chunkAt(size_t index)
+  {
+    auto& chunk = m_chunks[index];
+    if (!chunk)
+    {
+      chunk.reset(new Chunk());
+      chunk->fill(m_defaultValue);
+      m_evicted[index] = false;
+      ++m_allocatedChunks;
+
+      if (m_initializer)
+      {
+        IntVec2 chunkCoords{ static_cast<int>(index % m_chunkCount.x), static_cast<int>(index / m_chunkCount.x) };
+        m_initializer(chunkCoords, *chunk);
+      }
+    }
+    return *chunk;
+  }
+
+  /// Free a chunk's memory, if it has any.
+  void freeChunk(size_t index)
+  {
+    if (m_chunks[index])
+    {
+      m_chunks[index].reset();
+      --m_allocatedChunks;
+    }
+  }
+
+  /// Call a functor for every cell of a chunk that is inside the grid.
+  template <class ChunkType, class Functor>
+  void forEachCellOf(IntVec2 chunkCoords, ChunkType& chunk, Functor& functor) const
+  {
+    IntVec2 origin{ chunkCoords.x * ChunkSide, chunkCoords.y * ChunkSide };
+    int width = std::min(ChunkSide, m_size.x - origin.x);
+    int height = std::min(ChunkSide, m_size.y - origin.y);
+
+    for (int y = 0; y < height; ++y)
+    {
+      for (int x = 0; x < width; ++x)
+      {
+        functor(IntVec2{ origin.x + x, origin.y + y }, chunk[(y * ChunkSide) + x]);
+      }
+    }
+  }
+
+  /// Clamp coordinates to the grid.
+  IntVec2 clamp(IntVec2 coords) const
+  {
+    coords.x = Math::bounded(0, coords.x, m_size.x - 1);
+    coords.y = Math::bounded(0, coords.y, m_size.y - 1);
+    return coords;
+  }
+
+private:
+  /// Size of the grid, in cells.
+  IntVec2 m_size;
+
+  /// Size of the grid, in chunks.
+  IntVec2 m_chunkCount;
+
+  /// Value of cells in unallocated chunks.
+  T m_defaultValue;
+
+  /// Chunks, in chunk coordinate order (y, x); null if unallocated.
+  std::vector<std::unique_ptr<Chunk>> m_chunks;
+
+  /// Whether each chunk has been evicted.
+  std::vector<bool> m_evicted;
+
+  /// Number of chunks allocated.
+  size_t m_allocatedChunks = 0;
+
+  /// Function called to initialize newly allocated chunks.
+  ChunkInitializer m_initializer;
+};
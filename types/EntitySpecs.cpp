@@ -2,10 +2,13 @@
 
 #include "types/EntitySpecs.h"
 
+#include <boost/functional/hash.hpp>
+#include <mutex>
+
 void from_json(json const& j, EntitySpecs& obj)
 {
-  obj.category = "";
-  obj.material = "";
+  obj.category = Atom();
+  obj.material = Atom();
 
   if (!j.is_object()) return;
 
@@ -25,3 +28,65 @@ void to_json(json& j, EntitySpecs const& obj)
     j["material"] = obj.material;
   }
 }
+
+namespace
+{
+  /// Table of interned specs. Specs are stored in a deque, so references
+  /// returned by `fromId` stay valid as more are interned; the lock keeps
+  /// interning from another thread (such as map pre-generation) safe.
+  struct EntitySpecsTable
+  {
+    EntitySpecsTable()
+    {
+      // ID 0 is reserved for the empty specs.
+      specs.push_back(EntitySpecs());
+      ids[EntitySpecs()] = 0;
+    }
+
+    std::mutex mutex;
+    std::deque<EntitySpecs> specs;
+    std::unordered_map<EntitySpecs, EntitySpecsId> ids;
+  };
+
+  EntitySpecsTable& table()
+  {
+    static EntitySpecsTable instance;
+    return instance;
+  }
+}
+
+EntitySpecsId EntitySpecs::id() const
+{
+  auto& specsTable = table();
+  std::lock_guard<std::mutex> lock(specsTable.mutex);
+
+  auto iter = specsTable.ids.find(*this);
+  if (iter != specsTable.ids.end())
+  {
+    return iter->second;
+  }
+
+  EntitySpecsId newId = static_cast<EntitySpecsId>(specsTable.specs.size());
+  specsTable.specs.push_back(*this);
+  specsTable.ids[*this] = newId;
+  return newId;
+}
+
+EntitySpecs const& EntitySpecs::fromId(EntitySpecsId id)
+{
+  auto& specsTable = table();
+  std::lock_guard<std::mutex> lock(specsTable.mutex);
+  Assert("EntitySpecs", id < specsTable.specs.size(), "Invalid specs ID " << id << " requested");
+  return specsTable.specs[id];
+}
+
+namespace std
+{
+  std::size_t hash<EntitySpecs>::operator()(EntitySpecs const& obj) const
+  {
+    std::size_t seed = 0;
+    boost::hash_combine(seed, std::hash<Atom>()(obj.category));
+    boost::hash_combine(seed, std::hash<Atom>()(obj.material));
+    return seed;
+  }
+}
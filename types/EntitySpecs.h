@@ -1,23 +1,29 @@
 #pragma once
 
+#include "types/Atom.h"
+
 #include "json.hpp"
 using json = ::nlohmann::json;
 
+/// Compact identifier for an interned EntitySpecs.
+/// An ID of 0 always refers to the empty specs.
+using EntitySpecsId = uint32_t;
+
 /// Class containing the category and optional material for an entity.
 class EntitySpecs
 {
 public:
   EntitySpecs() :
-    category{ "" },
-    material{ "" }
+    category{},
+    material{}
   {}
 
-  EntitySpecs(std::string category_) :
+  EntitySpecs(Atom category_) :
     category{ category_ },
-    material{ "" }
+    material{}
   {}
 
-  EntitySpecs(std::string category_, std::string material_) :
+  EntitySpecs(Atom category_, Atom material_) :
     category{ category_ },
     material{ material_ }
   {}
@@ -25,6 +31,34 @@ public:
   friend void from_json(json const& j, EntitySpecs& obj);
   friend void to_json(json& j, EntitySpecs const& obj);
 
-  std::string category;
-  std::string material;
+  bool operator==(EntitySpecs const& other) const
+  {
+    return (category == other.category) && (material == other.material);
+  }
+
+  bool operator!=(EntitySpecs const& other) const
+  {
+    return !(*this == other);
+  }
+
+  /// Get the interned ID of these specs, interning them if necessary.
+  /// Interned IDs are only valid for the lifetime of the process, so they
+  /// must be converted back to specs before being saved.
+  EntitySpecsId id() const;
+
+  /// Get the specs corresponding to an interned ID.
+  static EntitySpecs const& fromId(EntitySpecsId id);
+
+  Atom category;
+  Atom material;
 };
+
+namespace std
+{
+  template<> struct hash<EntitySpecs>
+  {
+    typedef EntitySpecs argument_type;
+    typedef std::size_t result_type;
+    result_type operator()(argument_type const& obj) const;
+  };
+}
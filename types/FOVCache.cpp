@@ -0,0 +1,98 @@
+#include "stdafx.h"
+
+#include "types/FOVCache.h"
+
+#include <boost/functional/hash.hpp>
+
+FOVCache::FOVCache(size_t capacity)
+  :
+  m_capacity{ capacity }
+{}
+
+FOVCache::~FOVCache()
+{}
+
+std::shared_ptr<TilesSeen const> FOVCache::get(Key const& key)
+{
+  auto iter = m_index.find(key);
+  if (iter == m_index.end())
+  {
+    ++m_stats.misses;
+    return{};
+  }
+
+  ++m_stats.hits;
+
+  // Move the entry to the front of the list.
+  m_entries.splice(m_entries.begin(), m_entries, iter->second);
+  return iter->second->second;
+}
+
+void FOVCache::put(Key const& key, std::shared_ptr<TilesSeen const> tilesSeen)
+{
+  if (m_capacity == 0) return;
+
+  auto iter = m_index.find(key);
+  if (iter != m_index.end())
+  {
+    iter->second->second = tilesSeen;
+    m_entries.splice(m_entries.begin(), m_entries, iter->second);
+    return;
+  }
+
+  m_entries.emplace_front(key, tilesSeen);
+  m_index[key] = m_entries.begin();
+  trim();
+}
+
+void FOVCache::clear()
+{
+  m_index.clear();
+  m_entries.clear();
+}
+
+size_t FOVCache::capacity() const
+{
+  return m_capacity;
+}
+
+void FOVCache::setCapacity(size_t capacity)
+{
+  m_capacity = capacity;
+  trim();
+}
+
+size_t FOVCache::size() const
+{
+  return m_entries.size();
+}
+
+FOVCache::Stats const& FOVCache::stats() const
+{
+  return m_stats;
+}
+
+void FOVCache::resetStats()
+{
+  m_stats = Stats();
+}
+
+void FOVCache::trim()
+{
+  while (m_entries.size() > m_capacity)
+  {
+    m_index.erase(m_entries.back().first);
+    m_entries.pop_back();
+    ++m_stats.evictions;
+  }
+}
+
+size_t FOVCache::KeyHash::operator()(Key const& key) const
+{
+  size_t seed = 0;
+  boost::hash_combine(seed, std::hash<MapID>()(key.map));
+  boost::hash_combine(seed, std::hash<IntVec2>()(key.origin));
+  boost::hash_combine(seed, key.radius);
+  boost::hash_combine(seed, key.opacityVersion);
+  return seed;
+}
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+#include "boost/dynamic_bitset.hpp"
+
+#include "types/common.h"
+#include "types/Vec2.h"
+
+/// Set of tiles seen from one spot.
+/// Only the window of the map within sight range is stored, so the size of a
+/// result depends on the sight range rather than the size of the map.
+class TilesSeen
+{
+public:
+  /// Constructor.
+  /// @param corner   Map coordinates of the top-left corner of the window.
+  /// @param size     Size of the window.
+  TilesSeen(IntVec2 corner, IntVec2 size)
+    :
+    m_corner{ corner },
+    m_size{ size },
+    m_bits(static_cast<size_t>(size.x) * static_cast<size_t>(size.y))
+  {}
+
+  /// Get the map coordinates of the top-left corner of the window.
+  IntVec2 const& corner() const
+  {
+    return m_corner;
+  }
+
+  /// Get the size of the window.
+  IntVec2 const& size() const
+  {
+    return m_size;
+  }
+
+  /// Get whether a tile was seen. Tiles outside the window never are.
+  bool test(IntVec2 coords) const
+  {
+    return inWindow(coords) && m_bits[index(coords)];
+  }
+
+  /// Mark a tile as seen. Tiles outside the window are ignored.
+  void set(IntVec2 coords)
+  {
+    if (inWindow(coords)) m_bits.set(index(coords));
+  }
+
+  /// Get the number of tiles seen.
+  size_t count() const
+  {
+    return m_bits.count();
+  }
+
+  /// Call a functor with the map coordinates of every tile seen.
+  template <class Functor>
+  void forEachSeen(Functor functor) const
+  {
+    for (auto bit = m_bits.find_first(); bit != Bits::npos; bit = m_bits.find_next(bit))
+    {
+      functor(IntVec2{ m_corner.x + static_cast<int>(bit % m_size.x),
+                       m_corner.y + static_cast<int>(bit / m_size.x) });
+    }
+  }
+
+protected:
+  bool inWindow(IntVec2 coords) const
+  {
+    return (coords.x >= m_corner.x) && (coords.y >= m_corner.y) &&
+      (coords.x < m_corner.x + m_size.x) && (coords.y < m_corner.y + m_size.y);
+  }
+
+  size_t index(IntVec2 coords) const
+  {
+    return (static_cast<size_t>(coords.y - m_corner.y) * m_size.x) + (coords.x - m_corner.x);
+  }
+
+private:
+  using Bits = boost::dynamic_bitset<size_t>; // size_t gets rid of 64-bit compile warning
+
+  /// Map coordinates of the top-left corner of the window.
+  IntVec2 m_corner;
+
+  /// Size of the window.
+  IntVec2 m_size;
+
+  /// One bit per tile in the window, in coordinate order (y, x).
+  Bits m_bits;
+};
+
+/// Bounded least-recently-used cache of field-of-view results.
+/// Results are keyed by map, origin, sight radius, and the opacity version of
+/// the map, so any observers standing on the same tile of an unchanged map
+/// share one visibility set instead of each computing their own.
+class FOVCache
+{
+public:
+  /// Key identifying a single field-of-view calculation.
+  struct Key
+  {
+    MapID map;
+    IntVec2 origin;
+    int radius;
+    unsigned int opacityVersion;
+
+    bool operator==(Key const& other) const
+    {
+      return (map == other.map) &&
+        (origin == other.origin) &&
+        (radius == other.radius) &&
+        (opacityVersion == other.opacityVersion);
+    }
+  };
+
+  /// Usage counters, so the cache size can be tuned.
+  struct Stats
+  {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+
+    /// Get the fraction of lookups that were hits, from 0 to 1.
+    double hitRate() const
+    {
+      uint64_t lookups = hits + misses;
+      return (lookups == 0) ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+    }
+  };
+
+  /// Constructor.
+  /// @param capacity Maximum number of results to keep.
+  FOVCache(size_t capacity);
+
+  ~FOVCache();
+
+  /// Look up a cached result.
+  /// @param key  Key of the result to look up.
+  /// @return     Pointer to the shared result, or nullptr if it isn't cached.
+  std::shared_ptr<TilesSeen const> get(Key const& key);
+
+  /// Add a result to the cache, evicting the least recently used result if
+  /// the cache is full.
+  void put(Key const& key, std::shared_ptr<TilesSeen const> tilesSeen);
+
+  /// Discard all cached results. Statistics are left intact.
+  void clear();
+
+  /// Get the maximum number of results kept.
+  size_t capacity() const;
+
+  /// Set the maximum number of results kept, evicting results if needed.
+  void setCapacity(size_t capacity);
+
+  /// Get the number of results currently cached.
+  size_t size() const;
+
+  /// Get the cache usage counters.
+  Stats const& stats() const;
+
+  /// Reset the cache usage counters.
+  void resetStats();
+
+protected:
+  /// Evict least recently used results until the cache is within capacity.
+  void trim();
+
+private:
+  struct KeyHash
+  {
+    size_t operator()(Key const& key) const;
+  };
+
+  using Entry = std::pair<Key, std::shared_ptr<TilesSeen const>>;
+  using EntryList = std::list<Entry>;
+
+  /// Maximum number of results kept.
+  size_t m_capacity;
+
+  /// Results, ordered from most to least recently used.
+  EntryList m_entries;
+
+  /// Index into the results list.
+  std::unordered_map<Key, EntryList::iterator, KeyHash> m_index;
+
+  /// Usage counters.
+  Stats m_stats;
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "types/Vec2.h"
+
+/// Two-dimensional Fenwick (binary indexed) tree.
+/// Holds one value per cell, and answers "what is the total of the values
+/// in this rectangle?" in O(log w * log h) time, while still allowing
+/// single cells to be changed in O(log w * log h) time. Unlike a summed-area
+/// table, nothing needs rebuilding when a cell changes.
+template <class T = int>
+class FenwickGrid2D
+{
+public:
+  /// Constructor for a grid of zeroes.
+  /// @param size   The size of the grid to construct.
+  FenwickGrid2D(IntVec2 size = IntVec2(0, 0))
+    :
+    m_size(size),
+    m_tree(static_cast<size_t>(size.x) * size.y, T())
+  {}
+
+  /// Get the size of the grid.
+  IntVec2 const& size() const
+  {
+    return m_size;
+  }
+
+  /// Set every cell back to zero.
+  void clear()
+  {
+    std::fill(m_tree.begin(), m_tree.end(), T());
+  }
+
+  /// Set every cell at once, in O(w * h) time.
+  /// @param valueAt  Functor taking an IntVec2 and returning the value of
+  ///                 the cell at those coordinates.
+  template <class Functor>
+  void build(Functor valueAt)
+  {
+    for (int y = 0; y < m_size.y; ++y)
+    {
+      for (int x = 0; x < m_size.x; ++x)
+      {
+        m_tree[index(x, y)] = valueAt(IntVec2{ x, y });
+      }
+    }
+
+    // Push each node's total up to its parent, first along x, then along y.
+    for (int y = 0; y < m_size.y; ++y)
+    {
+      for (int x = 0; x < m_size.x; ++x)
+      {
+        int parent = x | (x + 1);
+        if (parent < m_size.x) m_tree[index(parent, y)] += m_tree[index(x, y)];
+      }
+    }
+
+    for (int y = 0; y < m_size.y; ++y)
+    {
+      int parent = y | (y + 1);
+      if (parent >= m_size.y) continue;
+      for (int x = 0; x < m_size.x; ++x)
+      {
+        m_tree[index(x, parent)] += m_tree[index(x, y)];
+      }
+    }
+  }
+
+  /// Add an amount to the value of a cell.
+  void add(IntVec2 coords, T delta)
+  {
+    for (int y = coords.y; y < m_size.y; y |= y + 1)
+    {
+      for (int x = coords.x; x < m_size.x; x |= x + 1)
+      {
+        m_tree[index(x, y)] += delta;
+      }
+    }
+  }
+
+  /// Get the total of the values from (0, 0) to a cell, inclusive.
+  /// Coordinates past the edges of the grid are treated as being on them.
+  T prefixSum(IntVec2 coords) const
+  {
+    T total = T();
+    for (int y = std::min(coords.y, m_size.y - 1); y >= 0; y = (y & (y + 1)) - 1)
+    {
+      for (int x = std::min(coords.x, m_size.x - 1); x >= 0; x = (x & (x + 1)) - 1)
+      {
+        total += m_tree[index(x, y)];
+      }
+    }
+    return total;
+  }
+
+  /// Get the total of the values in a rectangle, inclusive.
+  /// The rectangle is clipped to the grid.
+  T sum(IntVec2 upperLeft, IntVec2 lowerRight) const
+  {
+    int left = std::max(upperLeft.x, 0);
+    int top = std::max(upperLeft.y, 0);
+    int right = std::min(lowerRight.x, m_size.x - 1);
+    int bottom = std::min(lowerRight.y, m_size.y - 1);
+    if ((left > right) || (top > bottom)) return T();
+
+    return prefixSum({ right, bottom })
+      - prefixSum({ left - 1, bottom })
+      - prefixSum({ right, top - 1 })
+      + prefixSum({ left - 1, top - 1 });
+  }
+
+private:
+  /// Get the storage index of a node.
+  size_t index(int x, int y) const
+  {
+    return (static_cast<size_t>(y) * m_size.x) + x;
+  }
+
+  /// Size of the grid.
+  IntVec2 m_size;
+
+  /// Tree nodes, stored row-major.
+  std::vector<T> m_tree;
+};
@@ -1,70 +1,183 @@
 #pragma once
 
-#include <boost/ptr_container/ptr_vector.hpp>
+#include <functional>
+#include <stdexcept>
+#include <vector>
 
 #include "types/Vec2.h"
+#include "utilities/MathUtils.h"
 
-/// Two-dimensional grid of some sort of object.
-/// The grid is stored linearly in coordinate order (y, x).
-/// The grid owns the objects inside it.
-template <class Object>
+/// Two-dimensional grid of values.
+/// The values are stored contiguously in coordinate order (y, x).
+/// The grid owns the values inside it.
+template <class T>
 class Grid2D
 {
-  /// Using declaration for a ctor function for objects.
-  using ObjectCtor = std::function<Object*(IntVec2)>;
+  /// Using declaration for a ctor function for values.
+  using ValueCtor = std::function<T(IntVec2)>;
+
 public:
-  /// Constructor for a grid of objects that are not passed coordinates.
+  /// A contiguous run of values, such as one row of the grid.
+  template <class U>
+  class Span
+  {
+  public:
+    Span(U* begin, U* end) : m_begin{ begin }, m_end{ end } {}
+    U* begin() const { return m_begin; }
+    U* end() const { return m_end; }
+    size_t size() const { return static_cast<size_t>(m_end - m_begin); }
+    U& operator[](size_t index) const { return m_begin[index]; }
+
+  private:
+    U* m_begin;
+    U* m_end;
+  };
+
+  /// Constructor for a grid of copies of a value.
   /// @param size   The size of the grid to construct.
-  Grid2D(IntVec2 size) :
+  /// @param value  The value to fill the grid with.
+  Grid2D(IntVec2 size, T const& value = T()) :
+    m_size(size),
+    m_values(static_cast<size_t>(size.x) * static_cast<size_t>(size.y), value)
+  {}
+
+  /// Constructor for a grid of values that are passed coordinates.
+  /// @param size   The size of the grid to construct.
+  /// @param ctor   A function that takes a IntVec2 as an input and
+  ///               returns the value to store at those coordinates.
+  Grid2D(IntVec2 size, ValueCtor ctor) :
     m_size(size)
   {
+    m_values.reserve(static_cast<size_t>(size.x) * static_cast<size_t>(size.y));
     for (int y = 0; y < size.y; ++y)
     {
       for (int x = 0; x < size.x; ++x)
       {
-        m_objects.push_back(new Object());
+        m_values.push_back(ctor({ x, y }));
       }
     }
   }
 
-  /// Constructor for a grid of objects that are passed coordinates.
-  /// @param size   The size of the grid to construct.
-  /// @param ctor   A function that takes a IntVec2 as an input and
-  ///               returns a pointer to a new object of type Object.
-  ///               The Grid2D class will take ownership of this object.
-  Grid2D(IntVec2 size, ObjectCtor ctor) :
-    m_size(size)
+  /// Get the size of the grid.
+  IntVec2 const& size() const
   {
-    for (int y = 0; y < size.y; ++y)
+    return m_size;
+  }
+
+  /// Get whether coordinates are inside the grid.
+  bool contains(IntVec2 coords) const
+  {
+    return (coords.x >= 0) && (coords.y >= 0) && (coords.x < m_size.x) && (coords.y < m_size.y);
+  }
+
+  /// Get a reference to a value in the grid, without bounds checking.
+  T& operator[](IntVec2 coords)
+  {
+    return m_values[index(coords)];
+  }
+
+  T const& operator[](IntVec2 coords) const
+  {
+    return m_values[index(coords)];
+  }
+
+  /// Get a reference to a value in the grid.
+  /// @throws std::out_of_range if the coordinates are outside the grid.
+  T& at(IntVec2 coords)
+  {
+    if (!contains(coords)) throw std::out_of_range("Grid2D coordinates out of range");
+    return m_values[index(coords)];
+  }
+
+  T const& at(IntVec2 coords) const
+  {
+    if (!contains(coords)) throw std::out_of_range("Grid2D coordinates out of range");
+    return m_values[index(coords)];
+  }
+
+  /// Get a reference to a value in the grid, clamping the coordinates to the
+  /// nearest edge of the grid if they're outside it.
+  T& getClamped(IntVec2 coords)
+  {
+    return m_values[index(clamp(coords))];
+  }
+
+  T const& getClamped(IntVec2 coords) const
+  {
+    return m_values[index(clamp(coords))];
+  }
+
+  /// Get one row of the grid.
+  Span<T> row(int y)
+  {
+    T* begin = m_values.data() + index({ 0, y });
+    return{ begin, begin + m_size.x };
+  }
+
+  Span<T const> row(int y) const
+  {
+    T const* begin = m_values.data() + index({ 0, y });
+    return{ begin, begin + m_size.x };
+  }
+
+  /// Call a functor with the coordinates and value of every cell in the
+  /// grid, visiting cells in coordinate order (y, x).
+  /// @param functor  Functor taking (IntVec2, T&).
+  template <class Functor>
+  void forEach(Functor functor)
+  {
+    for (int y = 0; y < m_size.y; ++y)
     {
-      for (int x = 0; x < size.x; ++x)
+      for (int x = 0; x < m_size.x; ++x)
       {
-        Object* new_object = ctor({ x, y });
-        m_objects.push_back(new_object);
+        functor(IntVec2{ x, y }, m_values[index({ x, y })]);
       }
     }
   }
 
-  /// Get a reference to an object in the grid.
-  Object& get(IntVec2 coords)
+  /// Set every value in the grid.
+  void fill(T const& value)
   {
-    coords.x = Math::bounded(0, coords.x, m_size.x - 1);
-    coords.y = Math::bounded(0, coords.y, m_size.y - 1);
-    return m_objects[index(coords)];
+    std::fill(m_values.begin(), m_values.end(), value);
+  }
+
+  /// Get the linear storage index of a cell.
+  size_t index(IntVec2 coords) const
+  {
+    return (static_cast<size_t>(coords.y) * m_size.x) + coords.x;
+  }
+
+  /// Get a value by its linear storage index.
+  T& atIndex(size_t index)
+  {
+    return m_values[index];
+  }
+
+  T const& atIndex(size_t index) const
+  {
+    return m_values[index];
+  }
+
+  /// Get the number of bytes used by the grid's storage, not counting any
+  /// memory the values themselves own.
+  size_t storageBytes() const
+  {
+    return m_values.capacity() * sizeof(T);
   }
 
 protected:
-  /// Get the index to an object given x/y coords.
-  unsigned int index(IntVec2 coords)
+  /// Clamp coordinates to the grid.
+  IntVec2 clamp(IntVec2 coords) const
   {
-    return (coords.y * m_size.x) + coords.x;
+    coords.x = Math::bounded(0, coords.x, m_size.x - 1);
+    coords.y = Math::bounded(0, coords.y, m_size.y - 1);
+    return coords;
   }
 
 private:
-  /// Pointer vector of objects.
-  boost::ptr_vector< Object > m_objects;
-
   /// Size of the grid.
   IntVec2 m_size;
 
+  /// Values, in coordinate order (y, x).
+  std::vector<T> m_values;
 };
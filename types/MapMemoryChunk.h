@@ -3,46 +3,69 @@
 #include "types/common.h"
 #include "types/EntitySpecs.h"
 
-#include "json.hpp"
-using json = ::nlohmann::json;
-
 /// Represents the memory of a map square.
-
+/// Only the floor and space are stored here; anything else remembered on the
+/// square is kept in the owning MapMemory's overflow list, so that a dense
+/// grid of chunks stays small.
 class MapMemoryChunk
 {
 public:
   MapMemoryChunk()
     :
-    m_entitySpecs{},
+    m_floor{ 0 },
+    m_space{ 0 },
     m_when{}
   {}
 
-  MapMemoryChunk(std::vector<EntitySpecs> entitySpecs, ElapsedTicks when)
+  MapMemoryChunk(EntitySpecsId floor, EntitySpecsId space, ElapsedTicks when)
     :
-    m_entitySpecs{ entitySpecs },
+    m_floor{ floor },
+    m_space{ space },
     m_when{ when }
   {}
 
-  friend void from_json(json const& j, MapMemoryChunk& obj);
-  friend void to_json(json& j, MapMemoryChunk const& obj);
+  /// Get whether this chunk holds any memory at all.
+  bool isEmpty() const
+  {
+    return (m_floor == 0) && (m_space == 0);
+  }
 
-  virtual ~MapMemoryChunk()
-  {}
+  /// Get the specs of the remembered floor.
+  EntitySpecsId getFloor() const
+  {
+    return m_floor;
+  }
 
-  std::vector<EntitySpecs> const& getSpecs() const
+  /// Get the specs of the remembered space.
+  EntitySpecsId getSpace() const
   {
-    return m_entitySpecs;
+    return m_space;
   }
 
-  ElapsedTicks getTimeOfMemory()
+  ElapsedTicks getTimeOfMemory() const
   {
     return m_when;
   }
 
+  /// Update the memory.
+  /// @return True if the remembered floor or space changed.
+  bool update(EntitySpecsId floor, EntitySpecsId space, ElapsedTicks when)
+  {
+    m_when = when;
+    if ((m_floor == floor) && (m_space == space)) return false;
+
+    m_floor = floor;
+    m_space = space;
+    return true;
+  }
+
 private:
-  /// Collection of entity specs remembered. Map tile floor and space should be first in the collection.
-  std::vector<EntitySpecs> m_entitySpecs;
+  /// Interned specs of the remembered floor.
+  EntitySpecsId m_floor;
+
+  /// Interned specs of the remembered space.
+  EntitySpecsId m_space;
 
-  /// Elapsed game time when the tile was remembered.
+  /// Elapsed game time when the tile was last seen.
   ElapsedTicks m_when;
-};
\ No newline at end of file
+};
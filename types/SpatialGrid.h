@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "entity/EntityId.h"
+#include "types/Vec2.h"
+
+/// Uniform-grid spatial hash of entity locations on a single map.
+/// The map is divided into square buckets; each bucket lists the entities
+/// in it along with their exact coordinates. Rectangle and radius queries
+/// only visit the buckets that overlap the area asked about, so their cost
+/// depends on how many entities are nearby rather than on how many exist.
+/// Buckets are created on demand, so empty parts of a map cost nothing.
+class SpatialGrid
+{
+public:
+  /// Constructor.
+  /// @param bucketSide   Width and height of a bucket, in tiles.
+  explicit SpatialGrid(int bucketSide = 8)
+    :
+    m_bucketSide(std::max(bucketSide, 1))
+  {}
+
+  /// Get the number of entities in the grid.
+  size_t size() const
+  {
+    return m_locations.size();
+  }
+
+  /// Get whether an entity is in the grid.
+  bool contains(EntityId entity) const
+  {
+    return m_locations.count(entity) != 0;
+  }
+
+  /// Remove every entity from the grid.
+  void clear()
+  {
+    m_buckets.clear();
+    m_locations.clear();
+  }
+
+  /// Put an entity into the grid, or move it if it is already there.
+  void insert(EntityId entity, IntVec2 coords)
+  {
+    auto iter = m_locations.find(entity);
+    if (iter != m_locations.end())
+    {
+      if (iter->second == coords) return;
+
+      if (bucketKey(iter->second) == bucketKey(coords))
+      {
+        // Same bucket, so just update the coordinates held there.
+        for (auto& entry : m_buckets[bucketKey(coords)])
+        {
+          if (entry.entity == entity)
+          {
+            entry.coords = coords;
+            break;
+          }
+        }
+        iter->second = coords;
+        return;
+      }
+
+      removeFromBucket(entity, iter->second);
+      iter->second = coords;
+    }
+    else
+    {
+      m_locations.emplace(entity, coords);
+    }
+
+    m_buckets[bucketKey(coords)].push_back({ entity, coords });
+  }
+
+  /// Take an entity out of the grid, if it is there.
+  void remove(EntityId entity)
+  {
+    auto iter = m_locations.find(entity);
+    if (iter == m_locations.end()) return;
+
+    removeFromBucket(entity, iter->second);
+    m_locations.erase(iter);
+  }
+
+  /// Call a functor for each entity in a rectangle, inclusive.
+  /// @param upperLeft    Upper-left corner of the rectangle.
+  /// @param lowerRight   Lower-right corner of the rectangle.
+  /// @param functor      Functor taking (EntityId, IntVec2 coords).
+  template <class Functor>
+  void forEachInRect(IntVec2 upperLeft, IntVec2 lowerRight, Functor&& functor) const
+  {
+    if ((upperLeft.x > lowerRight.x) || (upperLeft.y > lowerRight.y)) return;
+
+    IntVec2 firstBucket = bucketOf(upperLeft);
+    IntVec2 lastBucket = bucketOf(lowerRight);
+
+    for (int by = firstBucket.y; by <= lastBucket.y; ++by)
+    {
+      for (int bx = firstBucket.x; bx <= lastBucket.x; ++bx)
+      {
+        auto iter = m_buckets.find(packKey(bx, by));
+        if (iter == m_buckets.end()) continue;
+
+        for (auto& entry : iter->second)
+        {
+          if ((entry.coords.x >= upperLeft.x) && (entry.coords.x <= lowerRight.x) &&
+              (entry.coords.y >= upperLeft.y) && (entry.coords.y <= lowerRight.y))
+          {
+            functor(entry.entity, entry.coords);
+          }
+        }
+      }
+    }
+  }
+
+  /// Call a functor for each entity within a (Euclidean) radius of a point.
+  /// @param center   Center of the circle.
+  /// @param radius   Radius of the circle, in tiles.
+  /// @param functor  Functor taking (EntityId, IntVec2 coords).
+  template <class Functor>
+  void forEachInRadius(IntVec2 center, int radius, Functor&& functor) const
+  {
+    if (radius < 0) return;
+
+    int radiusSquared = radius * radius;
+    forEachInRect({ center.x - radius, center.y - radius },
+                  { center.x + radius, center.y + radius },
+                  [&](EntityId entity, IntVec2 coords)
+    {
+      int dx = coords.x - center.x;
+      int dy = coords.y - center.y;
+      if ((dx * dx) + (dy * dy) <= radiusSquared)
+      {
+        functor(entity, coords);
+      }
+    });
+  }
+
+private:
+  /// One entity in a bucket.
+  struct Entry
+  {
+    EntityId entity;
+    IntVec2 coords;
+  };
+
+  /// Get the bucket coordinates containing a tile.
+  IntVec2 bucketOf(IntVec2 coords) const
+  {
+    // Round towards negative infinity, so negative coordinates still work.
+    auto divide = [this](int value)
+    {
+      return (value >= 0) ? (value / m_bucketSide) : -((-value + m_bucketSide - 1) / m_bucketSide);
+    };
+    return{ divide(coords.x), divide(coords.y) };
+  }
+
+  /// Pack bucket coordinates into a single hash key.
+  static uint64_t packKey(int bx, int by)
+  {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(bx)) << 32) | static_cast<uint32_t>(by);
+  }
+
+  /// Get the hash key of the bucket containing a tile.
+  uint64_t bucketKey(IntVec2 coords) const
+  {
+    IntVec2 bucket = bucketOf(coords);
+    return packKey(bucket.x, bucket.y);
+  }
+
+  /// Remove an entity from the bucket holding the given coordinates.
+  void removeFromBucket(EntityId entity, IntVec2 coords)
+  {
+    auto iter = m_buckets.find(bucketKey(coords));
+    if (iter == m_buckets.end()) return;
+
+    auto& entries = iter->second;
+    for (size_t index = 0; index < entries.size(); ++index)
+    {
+      if (entries[index].entity == entity)
+      {
+        // Order within a bucket doesn't matter, so swap with the last entry.
+        entries[index] = entries.back();
+        entries.pop_back();
+        break;
+      }
+    }
+
+    if (entries.empty()) m_buckets.erase(iter);
+  }
+
+  /// Width and height of a bucket, in tiles.
+  int m_bucketSide;
+
+  /// Buckets, by packed bucket coordinates.
+  std::unordered_map<uint64_t, std::vector<Entry>> m_buckets;
+
+  /// Coordinates of each entity in the grid.
+  std::unordered_map<EntityId, IntVec2> m_locations;
+};
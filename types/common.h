@@ -5,6 +5,8 @@
 #include <string>
 #include <unordered_map>
 
+#include "types/Atom.h"
+
 // Declarations of vector classes
 #include "types/Rect.h"
 #include "types/Vec2.h"
@@ -26,11 +28,11 @@ using ElapsedTicks = uint64_t;
 /// FileName is, well, a filename.
 using FileName = std::string;
 
-/// Each Map ID is a string.
+/// Each Map ID is an interned string.
 /// It used to be a 32-bit integer, but I've realized I'll probably want to
 /// support branching maps in the future, for which strings will be easier to
-/// manage.
-using MapID = std::string;
+/// manage. Interning them keeps comparisons and hashing as cheap as they were.
+using MapID = Atom;
 
 using String = std::string;
 
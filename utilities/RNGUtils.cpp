@@ -3,7 +3,6 @@
 #include <chrono>
 #include <memory>
 
-#include <boost/random/mersenne_twister.hpp>
 #include <boost/random/normal_distribution.hpp>
 #include <boost/random/uniform_int_distribution.hpp>
 
@@ -12,51 +11,128 @@
 using UniformIntDist = boost::random::uniform_int_distribution<>;
 using NormalDist = boost::random::normal_distribution<>;
 
-struct RNG::Impl
+namespace
 {
-  Impl()
+  /// The global seed.
+  uint64_t s_globalSeed = 0;
+
+  /// SplitMix64 finalizer, used to turn seeds and keys into well-mixed
+  /// stream identities.
+  uint64_t mix(uint64_t value)
+  {
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+  }
+
+  /// FNV-1a hash of a string. Unlike std::hash, this gives the same result
+  /// on every platform, so named streams are portable.
+  uint64_t hashKey(std::string const& key)
   {
-    rng.reset(NEW boost::random::mt19937(static_cast<unsigned int>(std::time(0))));
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (unsigned char c : key)
+    {
+      hash = (hash ^ c) * 0x100000001b3ULL;
+    }
+    return hash;
   }
 
-  std::unique_ptr<boost::random::mt19937> rng;
-};
+  uint64_t seedFromTime()
+  {
+    return static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+  }
+}
+
+RNG::Engine::Engine(uint64_t seed, uint64_t stream)
+  :
+  m_state{ 0 },
+  m_increment{ (stream << 1) | 1 }
+{
+  (*this)();
+  m_state += seed;
+  (*this)();
+}
+
+RNG::Engine::result_type RNG::Engine::operator()()
+{
+  uint64_t old = m_state;
+  m_state = old * 6364136223846793005ULL + m_increment;
+  uint32_t xorShifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+  uint32_t rot = static_cast<uint32_t>(old >> 59);
+  return (xorShifted >> rot) | (xorShifted << ((0u - rot) & 31));
+}
 
-RNG::RNG() :
-  m_impl{ NEW Impl() }
+RNG::RNG(uint64_t seed, uint64_t stream)
+  :
+  m_seed{ seed },
+  m_stream{ stream },
+  m_engine{ seed, stream }
 {}
 
 RNG::~RNG() {}
 
 RNG& RNG::instance()
 {
-  static std::unique_ptr<RNG> rng(NEW RNG());
+  static std::unique_ptr<RNG> rng(NEW RNG(globalSeed()));
 
   return *(rng.get());
 }
 
+void RNG::setGlobalSeed(uint64_t seed)
+{
+  s_globalSeed = (seed != 0) ? seed : seedFromTime();
+  instance() = RNG(s_globalSeed);
+}
+
+uint64_t RNG::globalSeed()
+{
+  if (s_globalSeed == 0)
+  {
+    s_globalSeed = seedFromTime();
+  }
+
+  return s_globalSeed;
+}
+
+RNG RNG::named(std::string const& name)
+{
+  return RNG(globalSeed()).split(name);
+}
+
+RNG RNG::split(uint64_t key) const
+{
+  uint64_t childStream = mix(m_stream ^ mix(key));
+  return RNG(mix(m_seed ^ childStream), childStream);
+}
+
+RNG RNG::split(std::string const& key) const
+{
+  return split(hashKey(key));
+}
+
 bool RNG::flip_coin()
 {
   UniformIntDist coin(0, 1);
-  return (coin(*(m_impl->rng)) == 0 ? false : true);
+  return (coin(m_engine) == 0 ? false : true);
 }
 
 /// Pick a number out of a uniform distribution.
 unsigned int RNG::pick_uniform(unsigned int min, unsigned int max)
 {
   UniformIntDist number(min, max);
-  return number(*(m_impl->rng));
+  return number(m_engine);
 }
 
 /// Pick a number out of a uniform distribution.
 int RNG::pick_uniform(int min, int max)
 {
   UniformIntDist number(min, max);
-  return number(*(m_impl->rng));
+  return number(m_engine);
 }
 
 double RNG::pick_normal(double min, double max)
 {
   NormalDist number(min, max);
-  return number(*(m_impl->rng));
+  return number(m_engine);
 }
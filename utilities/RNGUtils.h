@@ -1,16 +1,55 @@
 #pragma once
 
+#include <cstdint>
+#include <string>
+
 #include "game/App.h"
 
 #define the_RNG   RNG::instance()
 
+/// A stream of random numbers.
+///
+/// Each stream is a PCG32 generator identified by a (seed, stream) pair.
+/// Streams derived with split() or named() depend only on the identity of
+/// their parent and the key used, never on how many numbers have been drawn
+/// from anything else, so giving each map, generator or system a stream of
+/// its own keeps their results reproducible no matter what order (or on
+/// what thread) they run in.
+///
+/// All streams are ultimately derived from the global seed; setting it to a
+/// fixed value makes a whole session reproducible.
 class RNG
 {
 public:
+  /// Constructor.
+  /// @param seed     Seed for the stream.
+  /// @param stream   Stream selector; different selectors with the same
+  ///                 seed give independent sequences.
+  RNG(uint64_t seed, uint64_t stream = 0);
+
   virtual ~RNG();
 
+  /// Get the root stream, derived from the global seed.
   static RNG& instance();
 
+  /// Set the global seed, and reset the root stream to match.
+  /// @param seed   Seed to use, or 0 to pick one from the current time.
+  static void setGlobalSeed(uint64_t seed);
+
+  /// Get the global seed.
+  static uint64_t globalSeed();
+
+  /// Get a stream derived from the global seed and a name, e.g. "map/0".
+  static RNG named(std::string const& name);
+
+  /// Get a child stream of this one.
+  /// @param key  Key identifying the child.
+  RNG split(uint64_t key) const;
+
+  /// Get a child stream of this one.
+  /// @param key  Key identifying the child.
+  RNG split(std::string const& key) const;
+
   /// Return the results of a coin flip.
   bool flip_coin();
 
@@ -44,10 +83,32 @@ public:
     }
   }
 
-protected:
-  RNG();
+  /// PCG32 (XSH-RR) engine; satisfies the UniformRandomBitGenerator
+  /// requirements so it can be used with the standard distributions.
+  class Engine
+  {
+  public:
+    using result_type = uint32_t;
+
+    Engine(uint64_t seed, uint64_t stream);
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT32_MAX; }
+
+    result_type operator()();
+
+  private:
+    uint64_t m_state;
+    uint64_t m_increment;
+  };
 
 private:
-  struct Impl;
-  std::unique_ptr<Impl> m_impl;
+  /// Seed this stream was created with.
+  uint64_t m_seed;
+
+  /// Stream selector this stream was created with.
+  uint64_t m_stream;
+
+  /// The generator itself.
+  Engine m_engine;
 };
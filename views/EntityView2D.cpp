@@ -13,6 +13,12 @@
 #include "types/ShaderEffect.h"
 #include "utilities/RNGUtils.h"
 
+namespace
+{
+  /// Suffix of the Lua function that picks an entity's tile.
+  Atom const GetTileOffset{ "get_tile_offset" };
+}
+
 EntityView2D::EntityView2D(EntityId entity)
   :
   EntityView(entity)
@@ -46,8 +52,6 @@ void EntityView2D::draw(sf::RenderTarget& target,
   // Can't render if it's in another object.
   if (position.parent() != EntityId::Void) return;
 
-  MapTile& tile = MAPS.get(position.map()).getTile(position.coords());
-
   sf::RectangleShape rectangle;
   sf::IntRect textureCoords;
 
@@ -147,9 +151,10 @@ UintVec2 EntityView2D::getTileSheetCoords(int frame) const
   UintVec2 start_coords = App::the_tilesheet().getTileSheetCoords(COMPONENTS.category[entity]);
 
   // If the entity has the "animated" component, call the Lua function to get the offset (tile to choose).
-  if (categoryData["components"].count("animated") > 0)
+  if ((categoryData["components"].count("animated") > 0) &&
+      GAME.lua().hasEntityFunction(entity, GetTileOffset))
   {
-    offset = GAME.lua().callEntityFunction("get_tile_offset", entity, frame, UintVec2(0, 0));
+    offset = GAME.lua().call<UintVec2>(GetTileOffset, entity, UintVec2(0, 0), frame);
   }
 
   // Add them to get the resulting coordinates.
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Object.h"
 #include "maptile/MapTile.h"
 
 // Forward declarations
@@ -19,8 +20,8 @@ public:
 
 protected:
   /// Constructor.
-  /// @param map	Reference to MapTile object to associate with this view.
-  explicit MapTileView(MapTile& map_tile)
+  /// @param map	MapTile to associate with this view.
+  explicit MapTileView(MapTile map_tile)
     :
     Object({}),
     m_map_tile(map_tile)
@@ -28,7 +29,7 @@ protected:
     //startObserving(map_tile);
   }
 
-  /// Get reference to MapTile associated with this view.
+  /// Get the MapTile associated with this view.
   MapTile& getMapTile()
   {
     return m_map_tile;
@@ -41,5 +42,5 @@ protected:
 
 private:
   /// MapTile associated with this view.
-  MapTile& m_map_tile;
+  MapTile m_map_tile;
 };
@@ -15,12 +15,18 @@
 #include "types/ShaderEffect.h"
 #include "utilities/RNGUtils.h"
 
+namespace
+{
+  /// Suffix of the Lua function that picks an entity's tile.
+  Atom const GetTileOffset{ "get_tile_offset" };
+}
+
 std::string MapTileView2D::getViewName()
 {
   return "standard2D";
 }
 
-MapTileView2D::MapTileView2D(MapTile& map_tile)
+MapTileView2D::MapTileView2D(MapTile map_tile)
   :
   MapTileView(map_tile),
   m_tileOffset{ 0 } //m_tileOffset{ pick_uniform(0, 4) }
@@ -65,8 +71,12 @@ UintVec2 MapTileView2D::getEntityTileSheetCoords(EntityId entity, int frame) con
   /// Get tile coordinates on the sheet.
   UintVec2 start_coords = App::the_tilesheet().getTileSheetCoords(COMPONENTS.category[entity]);
 
-  /// Call the Lua function to get the offset (tile to choose).
-  UintVec2 offset = GAME.lua().callEntityFunction("get_tile_offset", entity, frame, UintVec2(0, 0));
+  /// Call the Lua function to get the offset (tile to choose), if there is one.
+  UintVec2 offset{ 0, 0 };
+  if (GAME.lua().hasEntityFunction(entity, GetTileOffset))
+  {
+    offset = GAME.lua().call<UintVec2>(GetTileOffset, entity, UintVec2(0, 0), frame);
+  }
 
   /// Add them to get the resulting coordinates.
   UintVec2 tile_coords = start_coords + offset;
@@ -130,10 +140,11 @@ void MapTileView2D::addMemoryVerticesTo(sf::VertexArray& vertices,
 
   if (!spacialMemory.contains(coords)) return;
 
-  auto& memories = spacialMemory[coords].getSpecs();
-
-  for (auto& memory : memories)
+  // Draw the remembered floor, space and items in that order, stopping at
+  // the first that can't be drawn.
+  auto addMemory = [&](EntitySpecsId memoryId) -> bool
   {
+    auto& memory = EntitySpecs::fromId(memoryId);
     json& tileCategoryData = Config::bible().categoryData(memory.category);
 
     Color opacity = Color::White;
@@ -142,7 +153,7 @@ void MapTileView2D::addMemoryVerticesTo(sf::VertexArray& vertices,
     std::string category = components["category"].get<std::string>();
 
     // Bail if the object has no associated tiles.
-    if (!App::the_tilesheet().hasTilesFor(category)) return;
+    if (!App::the_tilesheet().hasTilesFor(category)) return false;
 
     if (components.count("appearance") != 0)
     {
@@ -156,7 +167,7 @@ void MapTileView2D::addMemoryVerticesTo(sf::VertexArray& vertices,
     }
 
     // Bail if the object is totally transparent.
-    if (opacity == Color::Black) return;
+    if (opacity == Color::Black) return false;
 
     /// @todo Call a script to handle selecting a tile other than the one
     ///       in the upper-left corner.
@@ -166,6 +177,15 @@ void MapTileView2D::addMemoryVerticesTo(sf::VertexArray& vertices,
                                  tileCoords, Color::White,
                                  vNW, vNE,
                                  vSW, vSE);
+    return true;
+  };
+
+  auto& chunk = spacialMemory.at(coords);
+  if (!addMemory(chunk.getFloor()) || !addMemory(chunk.getSpace())) return;
+
+  for (auto memoryId : spacialMemory.itemsAt(coords))
+  {
+    if (!addMemory(memoryId)) return;
   }
 }
 
@@ -22,7 +22,7 @@ class MapTileView2D : public MapTileView
 
 public:
   /// Constructor.
-  MapTileView2D(MapTile& mapTile);
+  MapTileView2D(MapTile mapTile);
 
   virtual ~MapTileView2D();
 
@@ -2,9 +2,12 @@
 
 #include "views/MapView2D.h"
 
+#include "components/ComponentManager.h"
 #include "config/Settings.h"
 #include "game/App.h"
+#include "game/GameState.h"
 #include "map/Map.h"
+#include "map/MapMemory.h"
 #include "tilesheet/TileSheet.h"
 #include "types/ShaderEffect.h"
 #include "utilities/New.h"
@@ -17,13 +20,10 @@ MapView2D::MapView2D(std::string name,
 {
   resetCachedRenderData();
 
-  // Create a grid of tile views, each tied to a map tile.
-  m_map_tile_views.reset(new Grid2D<MapTileView2D>(map.getSize(),
-                         [&](IntVec2 coords) -> MapTileView2D*
-  {
-    return NEW MapTileView2D(map.getTile(coords));
-  }));
-
+  // Tile views are created a block at a time, as the tiles are drawn.
+  int const side = MapMemory::blockSide;
+  m_tileViewBlockCount = { (map.getSize().x + side - 1) / side, (map.getSize().y + side - 1) / side };
+  m_tileViewBlocks.resize(m_tileViewBlockCount.x * m_tileViewBlockCount.y);
 }
 
 MapView2D::~MapView2D()
@@ -34,23 +34,62 @@ void MapView2D::updateTiles(EntityId viewer, Systems::Lighting& lighting)
 {
   auto& map = getMap();
   auto& map_size = map.getSize();
+  int const side = MapMemory::blockSide;
 
-  static RealVec2 position;
+  // A tile is only drawn if the viewer can see it or remembers it, so skip
+  // any block that is outside the viewer's sight and has no memories in it.
+  IntVec2 seenCorner{ 0, 0 };
+  IntVec2 seenEnd{ 0, 0 };
+  if (COMPONENTS.senseSight.existsFor(viewer) && COMPONENTS.senseSight.of(viewer).tilesSeen())
+  {
+    auto& tilesSeen = *COMPONENTS.senseSight.of(viewer).tilesSeen();
+    seenCorner = tilesSeen.corner();
+    seenEnd = tilesSeen.corner() + tilesSeen.size();
+  }
 
-  // Loop through and draw tiles.
+  MapMemory const* memory = nullptr;
+  if (COMPONENTS.spacialMemory.existsFor(viewer) &&
+      COMPONENTS.spacialMemory[viewer].containsMap(map.getMapID()))
+  {
+    memory = &(COMPONENTS.spacialMemory[viewer].ofMap(map.getMapID()));
+  }
+
+  // Loop through and draw tiles, in the same (y, x) order as a full scan.
   m_mapHorizVertices.clear();
   m_mapVertVertices.clear();
   m_mapMemoryVertices.clear();
 
-  for (int y = 0; y < map_size.y; ++y)
+  std::vector<int> blockColumns;
+  for (int by = 0; by < m_tileViewBlockCount.y; ++by)
   {
-    for (int x = 0; x < map_size.x; ++x)
+    int top = by * side;
+    int bottom = std::min(top + side, map_size.y);
+
+    blockColumns.clear();
+    for (int bx = 0; bx < m_tileViewBlockCount.x; ++bx)
     {
-      m_map_tile_views->get({ x, y }).addTileVertices(viewer,
-                                                      m_mapHorizVertices,
-                                                      m_mapVertVertices,
-                                                      m_mapMemoryVertices,
-                                                      lighting);
+      int left = bx * side;
+      int right = std::min(left + side, map_size.x);
+      bool inSight = (left < seenEnd.x) && (right > seenCorner.x) && (top < seenEnd.y) && (bottom > seenCorner.y);
+      bool remembered = memory && memory->hasBlockAt({ left, top });
+      if (inSight || remembered) blockColumns.push_back(bx);
+    }
+
+    for (int y = top; y < bottom; ++y)
+    {
+      for (int bx : blockColumns)
+      {
+        int left = bx * side;
+        int right = std::min(left + side, map_size.x);
+        for (int x = left; x < right; ++x)
+        {
+          tileView({ x, y }).addTileVertices(viewer,
+                                             m_mapHorizVertices,
+                                             m_mapVertVertices,
+                                             m_mapMemoryVertices,
+                                             lighting);
+        }
+      }
     }
   }
 }
@@ -60,20 +99,43 @@ void MapView2D::updateEntities(EntityId viewer,
                                        int frame)
 {
   auto& map = getMap();
-  auto& map_size = map.getSize();
+  std::vector<IntVec2> tiles;
 
-  // Loop through and draw entities.
-  m_entityVertices.clear();
-  for (int y = 0; y < map_size.y; ++y)
+  // Only tiles holding something the viewer can see need drawing, plus the
+  // viewer's own tile.
+  if (COMPONENTS.senseSight.existsFor(viewer))
+  {
+    for (auto& visible : COMPONENTS.senseSight.of(viewer).visibleEntities())
+    {
+      tiles.push_back(visible.coords);
+    }
+  }
+
+  if (COMPONENTS.position.existsFor(viewer))
   {
-    for (int x = 0; x < map_size.x; ++x)
+    auto& position = COMPONENTS.position.of(viewer);
+    if (position.map() == map.getMapID() && !position.isInsideAnotherEntity())
     {
-      m_map_tile_views->get({ x, y }).addEntitiesVertices(viewer,
-                                                          m_entityVertices,
-                                                          &lighting,
-                                                          frame);
+      tiles.push_back(position.coords());
     }
   }
+
+  // Draw back to front, as the full-map scan did.
+  std::sort(tiles.begin(), tiles.end(), [](IntVec2 const& a, IntVec2 const& b)
+  {
+    return (a.y < b.y) || ((a.y == b.y) && (a.x < b.x));
+  });
+  tiles.erase(std::unique(tiles.begin(), tiles.end()), tiles.end());
+
+  m_entityVertices.clear();
+  for (auto& coords : tiles)
+  {
+    if (!map.isInBounds(coords)) continue;
+    tileView(coords).addEntitiesVertices(viewer,
+                                         m_entityVertices,
+                                         &lighting,
+                                         frame);
+  }
 }
 
 bool MapView2D::renderMap(sf::RenderTexture& texture, int frame)
@@ -132,6 +194,26 @@ std::string MapView2D::getViewName()
 }
 
 
+MapTileView2D& MapView2D::tileView(IntVec2 coords)
+{
+  auto& map = getMap();
+  int const side = MapMemory::blockSide;
+  IntVec2 block{ coords.x / side, coords.y / side };
+  auto& views = m_tileViewBlocks[(block.y * m_tileViewBlockCount.x) + block.x];
+
+  if (!views)
+  {
+    IntVec2 origin{ block.x * side, block.y * side };
+    IntVec2 size{ std::min(side, map.getSize().x - origin.x), std::min(side, map.getSize().y - origin.y) };
+    views.reset(NEW Grid2D<MapTileView2D>(size, [&](IntVec2 local) -> MapTileView2D
+    {
+      return MapTileView2D(map.getTile(origin + local));
+    }));
+  }
+
+  return (*views)[{ coords.x % side, coords.y % side }];
+}
+
 void MapView2D::drawPreChildren_(sf::RenderTexture & texture, int frame)
 {
   /// @todo WRITE ME
@@ -142,15 +224,20 @@ void MapView2D::resetCachedRenderData()
   auto& map = getMap();
   auto map_size = map.getSize();
 
+  // Only a small part of a large map is ever drawn at once, so don't
+  // reserve space for more than a screenful or so of tiles.
+  int const max_reserved_tiles = 128 * 128;
+  int reserved_tiles = std::min(map_size.x * map_size.y, max_reserved_tiles);
+
   // Size vertex arrays:
   // 4 vertices * 4 quads * 2 for the floor and ceiling = 32
   // 4 vertices * 4 quads * 4 potential walls = 64
   // Memory vertices could be even more than that, once we start showing
   // remembered objects on tiles, but for now we stick with floor/ceiling.
 
-  m_mapHorizVertices.resize(map_size.x * map_size.y * 32);
-  m_mapVertVertices.resize(map_size.x * map_size.y * 64);
-  m_mapMemoryVertices.resize(map_size.x * map_size.y * 32);
+  m_mapHorizVertices.resize(reserved_tiles * 32);
+  m_mapVertVertices.resize(reserved_tiles * 64);
+  m_mapMemoryVertices.resize(reserved_tiles * 32);
 
   // Create the vertex arrays.
   m_mapHorizVertices.clear();
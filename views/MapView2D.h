@@ -43,6 +43,10 @@ protected:
   /// Reinitialize cached map render data.
   void resetCachedRenderData();
 
+  /// Get the view of a tile, creating the views of its block of tiles if
+  /// they don't exist yet.
+  MapTileView2D& tileView(IntVec2 coords);
+
 private:
 
   /// "Horizontal" (floor/ceiling) map vertex array.
@@ -57,6 +61,12 @@ private:
   /// Entity vertex array.
   sf::VertexArray m_entityVertices;
 
-  /// Grid of tile views.
-  std::unique_ptr< Grid2D< MapTileView2D > > m_map_tile_views;
+  /// Size of the map, in blocks of tile views.
+  IntVec2 m_tileViewBlockCount;
+
+  /// Blocks of tile views, in block coordinate order (y, x).
+  /// Blocks are created the first time one of their tiles is drawn, so
+  /// a huge map that has barely been explored only has a few of them.
+  /// They're the same size as the blocks map memory is stored in.
+  std::vector< std::unique_ptr< Grid2D< MapTileView2D > > > m_tileViewBlocks;
 };